@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <framework/DependencyManager.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include "framework/Service.h"
+#include "framework/LifecycleManager.h"
+#include "TestService.h"
+
+using namespace Cppelix;
+
+
+struct IChurnService : public virtual IService {
+    static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+};
+
+/// Creates a TestService and removes it again, one million times. Every TestService requests a logger, so every round also
+/// makes the LoggerAdmin create and remove a logger service.
+class ChurnService final : public IChurnService, public Service {
+public:
+    ChurnService(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+        reg.registerDependency<ILogger>(this, true);
+    }
+    ~ChurnService() final = default;
+    bool start() final {
+        _removeServiceRegistration = getManager()->registerEventCompletionCallbacks<RemoveServiceEvent>(getServiceId(), this);
+
+        _start = std::chrono::system_clock::now();
+        createAndRemove();
+        return true;
+    }
+
+    bool stop() final {
+        return true;
+    }
+
+    void addDependencyInstance(ILogger *logger) {
+        _logger = logger;
+    }
+
+    void removeDependencyInstance(ILogger *logger) {
+        _logger = nullptr;
+    }
+
+    void handleCompletion(RemoveServiceEvent const * const evt) {
+        if(_churnCount < 1'000'000) {
+            createAndRemove();
+            return;
+        }
+
+        auto end = std::chrono::system_clock::now();
+        getManager()->pushEvent<QuitEvent>(getServiceId());
+        LOG_INFO(_logger, "finished in {:L} µs", std::chrono::duration_cast<std::chrono::microseconds>(end-_start).count());
+    }
+
+    void handleError(RemoveServiceEvent const * const evt) {
+        LOG_ERROR(_logger, "could not remove service {}", evt->serviceId);
+        getManager()->pushEvent<QuitEvent>(getServiceId());
+    }
+
+private:
+    void createAndRemove() {
+        auto *svc = getManager()->createServiceManager<TestService, ITestService>(CppelixProperties{{"LogLevel", LogLevel::INFO}});
+        // lower priority than the framework's own events, so the service has its logger and is started before it gets removed
+        getManager()->pushPrioritisedEvent<RemoveServiceEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY + 1, svc->getServiceId());
+        _churnCount++;
+    }
+
+    ILogger *_logger{nullptr};
+    uint64_t _churnCount{0};
+    std::chrono::system_clock::time_point _start{};
+    std::unique_ptr<EventCompletionHandlerRegistration> _removeServiceRegistration;
+};
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "framework/Events.h"
+
+namespace Cppelix {
+    /// Sent between the two PingPongServices until remaining reaches zero
+    struct PingEvent final : public Event {
+        explicit PingEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, uint64_t _remaining) noexcept :
+                Event(TYPE, NAME, _id, _originatingService, _priority), remaining(_remaining) {}
+        ~PingEvent() final = default;
+
+        const uint64_t remaining;
+        static constexpr uint64_t TYPE = typeNameHash<PingEvent>();
+        static constexpr std::string_view NAME = typeName<PingEvent>();
+    };
+
+    /// Announces a started PingPongService to its peer, which answers once with reply set
+    struct HelloEvent final : public Event {
+        explicit HelloEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, bool _reply) noexcept :
+                Event(TYPE, NAME, _id, _originatingService, _priority), reply(_reply) {}
+        ~HelloEvent() final = default;
+
+        const bool reply;
+        static constexpr uint64_t TYPE = typeNameHash<HelloEvent>();
+        static constexpr std::string_view NAME = typeName<HelloEvent>();
+    };
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <string>
+#include <framework/DependencyManager.h>
+#include <framework/CommunicationChannel.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include "framework/Service.h"
+#include "framework/LifecycleManager.h"
+#include "PingPongEvents.h"
+
+using namespace Cppelix;
+
+struct IPingPongService : public virtual IService {
+    static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+};
+
+/// Bounces a PingEvent to the manager with id "Peer" through the CommunicationChannel, ROUND_TRIPS times. Peer may be in another process.
+/// The service with "Initiator" set starts once both sides exchanged a HelloEvent, either one may start first. The optional "Label"
+/// (std::string) prefixes the result.
+class PingPongService final : public IPingPongService, public Service {
+public:
+    static constexpr uint64_t ROUND_TRIPS = 100'000;
+
+    PingPongService(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+        reg.registerDependency<ILogger>(this, true);
+        _peer = std::any_cast<uint64_t>(getProperties()->find("Peer")->second);
+        _initiator = std::any_cast<bool>(getProperties()->find("Initiator")->second);
+        if(auto label = getProperties()->find("Label"); label != end(*getProperties())) {
+            _label = std::any_cast<std::string>(label->second) + ": ";
+        }
+    }
+    ~PingPongService() final = default;
+
+    bool start() final {
+        _pingHandler = getManager()->registerEventHandler<PingEvent>(getServiceId(), this);
+        _helloHandler = getManager()->registerEventHandler<HelloEvent>(getServiceId(), this);
+        // if the peer is not running yet, it says hello itself when it is
+        getManager()->getCommunicationChannel()->sendEventTo<HelloEvent>(_peer, getServiceId(), false);
+        return true;
+    }
+
+    bool stop() final {
+        return true;
+    }
+
+    void addDependencyInstance(ILogger *logger) {
+        _logger = logger;
+    }
+
+    void removeDependencyInstance(ILogger *logger) {
+        _logger = nullptr;
+    }
+
+    Generator<bool> handleEvent(HelloEvent const * const evt) {
+        if(!evt->reply) {
+            getManager()->getCommunicationChannel()->sendEventTo<HelloEvent>(_peer, getServiceId(), true);
+        }
+
+        if(_initiator && !_started) {
+            _started = true;
+            _start = std::chrono::steady_clock::now();
+            getManager()->getCommunicationChannel()->sendEventTo<PingEvent>(_peer, getServiceId(), ROUND_TRIPS * 2);
+        }
+        co_return (bool)AllowOthersHandling;
+    }
+
+    Generator<bool> handleEvent(PingEvent const * const evt) {
+        if(evt->remaining > 1) {
+            getManager()->getCommunicationChannel()->sendEventTo<PingEvent>(_peer, getServiceId(), evt->remaining - 1);
+            co_return (bool)AllowOthersHandling;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        if(_initiator) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count();
+            LOG_INFO(_logger, "{}{:L} round trips in {:L} µs, {:L} ns per round trip", _label, ROUND_TRIPS, ns / 1'000, ns / ROUND_TRIPS);
+        }
+
+        getManager()->getCommunicationChannel()->broadcastEvent<QuitEvent>(getManager(), getServiceId());
+        getManager()->pushEvent<QuitEvent>(getServiceId());
+        co_return (bool)AllowOthersHandling;
+    }
+
+private:
+    ILogger *_logger{nullptr};
+    uint64_t _peer{0};
+    bool _initiator{false};
+    std::string _label{};
+    bool _started{false};
+    std::chrono::steady_clock::time_point _start{};
+    std::unique_ptr<EventHandlerRegistration> _pingHandler;
+    std::unique_ptr<EventHandlerRegistration> _helloHandler;
+};
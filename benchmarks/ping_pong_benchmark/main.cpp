@@ -0,0 +1,60 @@
+#include "PingPongService.h"
+#include <optional_bundles/logging_bundle/LoggerAdmin.h>
+#ifdef USE_SPDLOG
+#include <optional_bundles/logging_bundle/SpdlogFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/SpdlogLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE SpdlogFrameworkLogger
+#define LOGGER_TYPE SpdlogLogger
+#else
+#include <optional_bundles/logging_bundle/CoutFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/CoutLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE CoutFrameworkLogger
+#define LOGGER_TYPE CoutLogger
+#endif
+#include <framework/EventTracer.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+int main(int argc, char *argv[]) {
+    std::locale::global(std::locale("en_US.UTF-8"));
+
+    // --trace <n>: trace one in n root events and write the trace to ping_pong_trace.json
+    bool trace = argc > 2 && std::string_view{argv[1]} == "--trace";
+    if(trace) {
+        EventTracer::setSampleEvery(std::stoull(argv[2]));
+    }
+
+    CommunicationChannel channel{};
+    DependencyManager dmOne{};
+    DependencyManager dmTwo{};
+    channel.addManager(&dmOne);
+    channel.addManager(&dmTwo);
+
+    auto run = [](DependencyManager &dm, uint64_t peer, bool initiator) {
+        auto logMgr = dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
+        logMgr->setLogLevel(LogLevel::INFO);
+#ifdef USE_SPDLOG
+        dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
+#endif
+        dm.createServiceManager<LoggerAdmin<LOGGER_TYPE>, ILoggerAdmin>();
+        dm.createServiceManager<PingPongService, IPingPongService>(CppelixProperties{{"LogLevel", LogLevel::INFO}, {"Peer", peer}, {"Initiator", initiator}});
+        dm.start();
+    };
+
+    std::thread t1([&] { run(dmOne, dmTwo.getId(), true); });
+    std::thread t2([&] { run(dmTwo, dmOne.getId(), false); });
+
+    t1.join();
+    t2.join();
+
+    if(trace) {
+        std::ofstream("ping_pong_trace.json") << EventTracer::toChromeTrace();
+        std::cout << "wrote ping_pong_trace.json\n";
+    }
+
+    return 0;
+}
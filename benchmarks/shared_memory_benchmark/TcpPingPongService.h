@@ -0,0 +1,97 @@
+#pragma once
+
+#include <chrono>
+#include <thread>
+#include <framework/DependencyManager.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include "framework/Service.h"
+#include "framework/LifecycleManager.h"
+#include "../ping_pong_benchmark/PingPongEvents.h"
+#include <sys/socket.h>
+
+using namespace Cppelix;
+
+struct ITcpPingPongService : public virtual IService {
+    static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+};
+
+/// PingPongService with the peer on the other end of the connected socket "Socket" instead of behind a CommunicationChannel,
+/// the way events crossed processes before SharedMemoryTransport. A reader thread turns received messages into PingEvents.
+class TcpPingPongService final : public ITcpPingPongService, public Service {
+public:
+    TcpPingPongService(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+        reg.registerDependency<ILogger>(this, true);
+        _socket = std::any_cast<int>(getProperties()->find("Socket")->second);
+        _initiator = std::any_cast<bool>(getProperties()->find("Initiator")->second);
+    }
+    ~TcpPingPongService() final = default;
+
+    bool start() final {
+        _pingHandler = getManager()->registerEventHandler<PingEvent>(getServiceId(), this);
+        // messages that arrive before this point wait in the socket
+        _reader = std::thread([this] {
+            uint64_t remaining;
+            while(receive(remaining)) {
+                getManager()->pushEvent<PingEvent>(getServiceId(), remaining);
+            }
+            getManager()->pushEvent<QuitEvent>(getServiceId());
+        });
+
+        if(_initiator) {
+            _start = std::chrono::steady_clock::now();
+            send(_socket, &ROUND_TRIPS_TIMES_TWO, sizeof(ROUND_TRIPS_TIMES_TWO), 0);
+        }
+        return true;
+    }
+
+    bool stop() final {
+        shutdown(_socket, SHUT_RDWR);
+        _reader.join();
+        return true;
+    }
+
+    void addDependencyInstance(ILogger *logger) {
+        _logger = logger;
+    }
+
+    void removeDependencyInstance(ILogger *logger) {
+        _logger = nullptr;
+    }
+
+    Generator<bool> handleEvent(PingEvent const * const evt) {
+        if(evt->remaining > 1) {
+            uint64_t remaining = evt->remaining - 1;
+            send(_socket, &remaining, sizeof(remaining), 0);
+            co_return (bool)AllowOthersHandling;
+        }
+
+        auto end = std::chrono::steady_clock::now();
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - _start).count();
+        LOG_INFO(_logger, "tcp between managers: {:L} round trips in {:L} µs, {:L} ns per round trip", ROUND_TRIPS_TIMES_TWO / 2, ns / 1'000, ns / (ROUND_TRIPS_TIMES_TWO / 2));
+        // stop() shuts the socket down, which makes the peer quit as well
+        getManager()->pushEvent<QuitEvent>(getServiceId());
+        co_return (bool)AllowOthersHandling;
+    }
+
+private:
+    static constexpr uint64_t ROUND_TRIPS_TIMES_TWO = 200'000;
+
+    bool receive(uint64_t &remaining) {
+        size_t received = 0;
+        while(received < sizeof(remaining)) {
+            auto ret = recv(_socket, reinterpret_cast<char*>(&remaining) + received, sizeof(remaining) - received, 0);
+            if(ret <= 0) {
+                return false;
+            }
+            received += static_cast<size_t>(ret);
+        }
+        return true;
+    }
+
+    ILogger *_logger{nullptr};
+    int _socket{-1};
+    bool _initiator{false};
+    std::chrono::steady_clock::time_point _start{};
+    std::thread _reader;
+    std::unique_ptr<EventHandlerRegistration> _pingHandler;
+};
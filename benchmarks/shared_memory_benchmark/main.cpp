@@ -0,0 +1,175 @@
+#include "../ping_pong_benchmark/PingPongService.h"
+#include "TcpPingPongService.h"
+#include <framework/SharedMemoryTransport.h>
+#include <optional_bundles/logging_bundle/LoggerAdmin.h>
+#ifdef USE_SPDLOG
+#include <optional_bundles/logging_bundle/SpdlogFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/SpdlogLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE SpdlogFrameworkLogger
+#define LOGGER_TYPE SpdlogLogger
+#else
+#include <optional_bundles/logging_bundle/CoutFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/CoutLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE CoutFrameworkLogger
+#define LOGGER_TYPE CoutLogger
+#endif
+#include <iostream>
+#include <thread>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// Same ping-pong as ping_pong_benchmark, but the two managers live in two processes. First through a SharedMemoryTransport,
+// then for comparison over a loopback TCP connection between the managers, and over TCP without the framework in between.
+
+namespace {
+    constexpr std::string_view SEGMENT_NAME = "cppelix_shared_memory_benchmark";
+
+    void runSharedMemory(bool initiator) {
+        CommunicationChannel channel{};
+        DependencyManager dm{};
+        SharedMemoryTransport transport{std::string{SEGMENT_NAME}};
+        transport.registerEventType<PingEvent, uint64_t>();
+        transport.registerEventType<HelloEvent, bool>();
+        transport.registerEventType<QuitEvent>();
+
+        channel.addManager(&dm);
+        channel.setTransport(&transport);
+        transport.attachManager(&dm, initiator ? "one" : "two");
+
+        std::optional<uint64_t> peer;
+        while(!(peer = transport.findManager(initiator ? "two" : "one"))) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        auto logMgr = dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
+        logMgr->setLogLevel(LogLevel::INFO);
+#ifdef USE_SPDLOG
+        dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
+#endif
+        dm.createServiceManager<LoggerAdmin<LOGGER_TYPE>, ILoggerAdmin>();
+        dm.createServiceManager<PingPongService, IPingPongService>(CppelixProperties{{"LogLevel", LogLevel::INFO}, {"Peer", *peer}, {"Initiator", initiator}, {"Label", std::string{"shared memory"}}});
+        dm.start();
+
+        transport.detachManager(&dm);
+        channel.setTransport(nullptr);
+    }
+
+    struct TcpMessage final {
+        uint64_t type;
+        uint64_t remaining;
+    };
+
+    bool sendAll(int fd, const TcpMessage &msg) {
+        return send(fd, &msg, sizeof(msg), 0) == static_cast<ssize_t>(sizeof(msg));
+    }
+
+    bool receiveAll(int fd, TcpMessage &msg) {
+        size_t received = 0;
+        while(received < sizeof(msg)) {
+            auto ret = recv(fd, reinterpret_cast<char*>(&msg) + received, sizeof(msg) - received, 0);
+            if(ret <= 0) {
+                return false;
+            }
+            received += static_cast<size_t>(ret);
+        }
+        return true;
+    }
+
+    int connectTcp(bool initiator, int listenFd, uint16_t port) {
+        int fd;
+        if(initiator) {
+            fd = accept(listenFd, nullptr, nullptr);
+        } else {
+            fd = socket(AF_INET, SOCK_STREAM, 0);
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(port);
+            addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            if(connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+                std::cerr << "couldn't connect\n";
+                std::exit(1);
+            }
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return fd;
+    }
+
+    void runTcpBetweenManagers(bool initiator, int listenFd, uint16_t port) {
+        int fd = connectTcp(initiator, listenFd, port);
+        DependencyManager dm{};
+        auto logMgr = dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
+        logMgr->setLogLevel(LogLevel::INFO);
+#ifdef USE_SPDLOG
+        dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
+#endif
+        dm.createServiceManager<LoggerAdmin<LOGGER_TYPE>, ILoggerAdmin>();
+        dm.createServiceManager<TcpPingPongService, ITcpPingPongService>(CppelixProperties{{"LogLevel", LogLevel::INFO}, {"Socket", fd}, {"Initiator", initiator}});
+        dm.start();
+        close(fd);
+    }
+
+    void runTcp(bool initiator, int listenFd, uint16_t port) {
+        int fd = connectTcp(initiator, listenFd, port);
+
+        auto start = std::chrono::steady_clock::now();
+        TcpMessage msg{PingEvent::TYPE, PingPongService::ROUND_TRIPS * 2};
+        if(initiator) {
+            sendAll(fd, msg);
+        }
+        while(receiveAll(fd, msg) && msg.remaining > 1) {
+            msg.remaining--;
+            sendAll(fd, msg);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        if(initiator) {
+            auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count();
+            std::cout << fmt::format("tcp without framework: {:L} round trips in {:L} µs, {:L} ns per round trip\n", PingPongService::ROUND_TRIPS, ns / 1'000, ns / PingPongService::ROUND_TRIPS);
+        }
+        close(fd);
+    }
+}
+
+int main() {
+    std::locale::global(std::locale("en_US.UTF-8"));
+
+    SharedMemoryTransport::unlink(std::string{SEGMENT_NAME});
+
+    // listen before forking, so the child can connect as soon as it gets to the tcp part
+    int listenFd = socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t addrLen = sizeof(addr);
+    if(listenFd < 0 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listenFd, 2) != 0 || getsockname(listenFd, reinterpret_cast<sockaddr*>(&addr), &addrLen) != 0) {
+        std::cerr << "couldn't listen on loopback\n";
+        return 1;
+    }
+
+    // fork before any thread exists
+    auto child = fork();
+    if(child < 0) {
+        std::cerr << "couldn't fork\n";
+        return 1;
+    }
+    bool initiator = child != 0;
+
+    runSharedMemory(initiator);
+    runTcpBetweenManagers(initiator, listenFd, ntohs(addr.sin_port));
+    runTcp(initiator, listenFd, ntohs(addr.sin_port));
+    close(listenFd);
+
+    if(initiator) {
+        waitpid(child, nullptr, 0);
+        SharedMemoryTransport::unlink(std::string{SEGMENT_NAME});
+    }
+
+    return 0;
+}
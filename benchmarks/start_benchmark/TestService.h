@@ -19,7 +19,8 @@ public:
     }
     ~TestService() final = default;
     bool start() final {
-        if(std::any_cast<uint64_t>(getProperties()->operator[]("Iteration")) == 9'999) {
+        auto iteration = getProperties()->find("Iteration");
+        if(iteration != end(*getProperties()) && std::any_cast<uint64_t>(iteration->second) == 9'999) {
             getManager()->pushEvent<QuitEvent>(getServiceId());
         }
         return true;
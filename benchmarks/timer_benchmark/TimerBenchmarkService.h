@@ -0,0 +1,100 @@
+#pragma once
+
+#include <chrono>
+#include <ctime>
+#include <framework/DependencyManager.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include <optional_bundles/timer_bundle/TimerService.h>
+#include "framework/Service.h"
+#include "framework/LifecycleManager.h"
+
+using namespace Cppelix;
+
+
+struct ITimerBenchmarkService : public virtual IService {
+    static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+};
+
+/// Runs 100'000 Timer services with intervals between 0.5 and 1.5 s for five seconds, then compares the TimerEvents handled to the
+/// amount expected and logs how much cpu time the process used. Next to them a 1 ms timer records how late its ticks are.
+class TimerBenchmarkService final : public ITimerBenchmarkService, public Service {
+public:
+    static constexpr uint64_t TIMERS = 100'000;
+    static constexpr auto DURATION = std::chrono::seconds(5);
+
+    TimerBenchmarkService(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+        reg.registerDependency<ILogger>(this, true);
+    }
+    ~TimerBenchmarkService() final = default;
+
+    bool start() final {
+        _timerEventRegistration = getManager()->registerEventHandler<TimerEvent>(getServiceId(), this);
+
+        _cpuStart = std::clock();
+        getManager()->scheduleTimer(DURATION, std::chrono::nanoseconds(0), [this](std::chrono::steady_clock::time_point, uint64_t) { finish(); });
+
+        auto createStart = std::chrono::steady_clock::now();
+        _timers.reserve(TIMERS);
+        for(uint64_t i = 0; i < TIMERS; i++) {
+            auto interval = std::chrono::milliseconds(500 + i % 1001);
+            auto *timer = getManager()->createServiceManager<Timer, ITimer>();
+            timer->setChronoInterval(interval);
+            timer->startTimer();
+            _timers.push_back(timer);
+            _expectedTicks += static_cast<uint64_t>(DURATION / interval);
+        }
+        auto createEnd = std::chrono::steady_clock::now();
+        LOG_INFO(_logger, "created {:L} timers in {:L} µs", TIMERS, std::chrono::duration_cast<std::chrono::microseconds>(createEnd - createStart).count());
+
+        _controlTimer = getManager()->createServiceManager<Timer, ITimer>();
+        _controlTimer->setChronoInterval(std::chrono::milliseconds(1));
+        _controlTimer->enableLatenessHistogram();
+        _controlTimer->startTimer();
+
+        return true;
+    }
+
+    bool stop() final {
+        _timerEventRegistration = nullptr;
+        return true;
+    }
+
+    void addDependencyInstance(ILogger *logger) {
+        _logger = logger;
+    }
+
+    void removeDependencyInstance(ILogger *logger) {
+        _logger = nullptr;
+    }
+
+    Generator<bool> handleEvent(TimerEvent const * const evt) {
+        if(evt->originatingService != _controlTimer->getServiceId()) {
+            _ticks++;
+        }
+        co_return (bool)PreventOthersHandling;
+    }
+
+private:
+    void finish() {
+        for(auto *timer : _timers) {
+            timer->stopTimer();
+        }
+        _controlTimer->stopTimer();
+
+        auto cpu = std::chrono::microseconds((std::clock() - _cpuStart) * 1'000'000 / CLOCKS_PER_SEC);
+        LOG_INFO(_logger, "handled {:L} of {:L} expected timer events, using {:L} µs of cpu time", _ticks, _expectedTicks, cpu.count());
+
+        auto const &lateness = *_controlTimer->getLatenessHistogram();
+        LOG_INFO(_logger, "1 ms timer: {:L} ticks, {:L} missed, lateness p50 {:L} ns, p99 {:L} ns, p99.9 {:L} ns, max {:L} ns", lateness.count(),
+                 _controlTimer->getMissedTicks(), lateness.valueAtQuantile(0.5), lateness.valueAtQuantile(0.99), lateness.valueAtQuantile(0.999), lateness.max());
+        getManager()->pushEvent<QuitEvent>(getServiceId());
+    }
+
+    ILogger *_logger{nullptr};
+    std::vector<Timer*> _timers{};
+    Timer *_controlTimer{nullptr};
+    uint64_t _ticks{0};
+    uint64_t _expectedTicks{0};
+    std::clock_t _cpuStart{};
+    std::unique_ptr<EventHandlerRegistration> _timerEventRegistration{nullptr};
+};
@@ -0,0 +1,32 @@
+#include "TimerBenchmarkService.h"
+#include <optional_bundles/logging_bundle/LoggerAdmin.h>
+#ifdef USE_SPDLOG
+#include <optional_bundles/logging_bundle/SpdlogFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/SpdlogLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE SpdlogFrameworkLogger
+#define LOGGER_TYPE SpdlogLogger
+#else
+#include <optional_bundles/logging_bundle/CoutFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/CoutLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE CoutFrameworkLogger
+#define LOGGER_TYPE CoutLogger
+#endif
+
+int main() {
+    std::locale::global(std::locale("en_US.UTF-8"));
+
+    DependencyManager dm{};
+    auto logMgr = dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
+    logMgr->setLogLevel(LogLevel::INFO);
+#ifdef USE_SPDLOG
+    dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
+#endif
+    dm.createServiceManager<LoggerAdmin<LOGGER_TYPE>, ILoggerAdmin>();
+    dm.createServiceManager<TimerBenchmarkService, ITimerBenchmarkService>(CppelixProperties{{"LogLevel", LogLevel::INFO}});
+    dm.setTimerSlack(std::chrono::microseconds(1));
+    dm.start();
+
+    return 0;
+}
@@ -35,7 +35,7 @@ public:
             LOG_ERROR(_logger, "Error putting key/value into etcd");
         }
 
-        getManager()->pushEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY+1);
+        getManager()->pushPrioritisedEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY+1);
         return true;
     }
 
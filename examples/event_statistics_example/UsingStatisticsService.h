@@ -44,7 +44,7 @@ public:
     }
 
     Generator<bool> handleEvent(TimerEvent const * const evt) {
-        getManager()->pushEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY+1);
+        getManager()->pushPrioritisedEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY+1);
 
         co_return (bool)PreventOthersHandling;
     }
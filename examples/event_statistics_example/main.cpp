@@ -15,16 +15,23 @@
 #define LOGGER_TYPE CoutLogger
 #endif
 #include <chrono>
+#include <cstring>
 #include <iostream>
 
 using namespace Cppelix;
 using namespace std::string_literals;
 
-int main() {
+int main(int argc, char *argv[]) {
     std::locale::global(std::locale("en_US.UTF-8"));
 
+    // --virtual-time simulates the 15 seconds instead of waiting for them
+    std::shared_ptr<VirtualClock> virtualClock{};
+    if(argc > 1 && std::strcmp(argv[1], "--virtual-time") == 0) {
+        virtualClock = std::make_shared<VirtualClock>();
+    }
+
     auto start = std::chrono::system_clock::now();
-    DependencyManager dm{};
+    DependencyManager dm{virtualClock};
     dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
 #ifdef USE_SPDLOG
     dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
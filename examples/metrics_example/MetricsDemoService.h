@@ -0,0 +1,78 @@
+#pragma once
+
+#include <framework/DependencyManager.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include <optional_bundles/metrics_bundle/IMetricsRegistry.h>
+#include <optional_bundles/timer_bundle/TimerService.h>
+#include "framework/Service.h"
+#include "framework/LifecycleManager.h"
+
+using namespace Cppelix;
+
+struct IMetricsDemoService : virtual public IService {
+    static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+};
+
+/// Counts the ticks of a 100 ms timer and how late they came, for a minute
+class MetricsDemoService final : public IMetricsDemoService, public Service {
+public:
+    MetricsDemoService(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+        reg.registerDependency<ILogger>(this, true);
+        reg.registerDependency<IMetricsRegistry>(this, true);
+    }
+    ~MetricsDemoService() final = default;
+
+    bool start() final {
+        _ticks = &_registry->counter("demo_ticks_total", "Timer ticks handled");
+        _missedTicks = &_registry->counter("demo_missed_ticks_total", "Timer ticks skipped because the event loop was late");
+        _lateness = &_registry->histogram("demo_tick_lateness_nanoseconds", "Time from the deadline of a tick until it was handled");
+
+        _timerManager = getManager()->createServiceManager<Timer, ITimer>();
+        _timerManager->setChronoInterval(std::chrono::milliseconds(100));
+        _timerEventRegistration = getManager()->registerEventHandler<TimerEvent>(getServiceId(), this, _timerManager->getServiceId());
+        _timerManager->startTimer();
+        return true;
+    }
+
+    bool stop() final {
+        _timerEventRegistration = nullptr;
+        _timerManager = nullptr;
+        return true;
+    }
+
+    void addDependencyInstance(ILogger *logger) {
+        _logger = logger;
+    }
+
+    void removeDependencyInstance(ILogger *logger) {
+        _logger = nullptr;
+    }
+
+    void addDependencyInstance(IMetricsRegistry *registry) {
+        _registry = registry;
+    }
+
+    void removeDependencyInstance(IMetricsRegistry *registry) {
+        _registry = nullptr;
+    }
+
+    Generator<bool> handleEvent(TimerEvent const * const evt) {
+        _ticks->increment();
+        _missedTicks->increment(evt->missedTicks);
+        _lateness->record(static_cast<uint64_t>(std::max<int64_t>(0, (std::chrono::steady_clock::now() - evt->deadline).count())));
+
+        if(_ticks->value() == 600) {
+            getManager()->pushPrioritisedEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY + 1);
+        }
+        co_return (bool)PreventOthersHandling;
+    }
+
+private:
+    ILogger *_logger{nullptr};
+    IMetricsRegistry *_registry{nullptr};
+    Counter *_ticks{nullptr};
+    Counter *_missedTicks{nullptr};
+    Histogram *_lateness{nullptr};
+    std::unique_ptr<EventHandlerRegistration> _timerEventRegistration{nullptr};
+    Timer* _timerManager{nullptr};
+};
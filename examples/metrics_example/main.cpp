@@ -0,0 +1,46 @@
+#include "MetricsDemoService.h"
+#include <optional_bundles/logging_bundle/LoggerAdmin.h>
+#ifdef USE_SPDLOG
+#include <optional_bundles/logging_bundle/SpdlogFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/SpdlogLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE SpdlogFrameworkLogger
+#define LOGGER_TYPE SpdlogLogger
+#else
+#include <optional_bundles/logging_bundle/CoutFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/CoutLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE CoutFrameworkLogger
+#define LOGGER_TYPE CoutLogger
+#endif
+#include <optional_bundles/metrics_bundle/MetricsRegistry.h>
+#include <optional_bundles/metrics_bundle/PrometheusExporter.h>
+#include <chrono>
+#include <iostream>
+
+using namespace std::string_literals;
+
+int main() {
+    std::locale::global(std::locale("en_US.UTF-8"));
+
+    // while running: curl http://localhost:9464/metrics
+    // and kill -USR1 <pid> to write the last events handled to ./flight_<pid>_<manager id>.bin, for cppelix_flight_recorder_decoder
+    FlightRecorder::installSignalHandlers(".");
+    auto start = std::chrono::system_clock::now();
+    DependencyManager dm{};
+    dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
+#ifdef USE_SPDLOG
+    dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
+#endif
+    dm.createServiceManager<LoggerAdmin<LOGGER_TYPE>, ILoggerAdmin>();
+    dm.createServiceManager<MetricsRegistry, IMetricsRegistry>();
+    dm.createServiceManager<PrometheusExporter, IPrometheusExporter>();
+    dm.createServiceManager<MetricsDemoService, IMetricsDemoService>();
+    dm.setQueueMetricsEnabled(true);
+    dm.getHandlerProfiler().setEnabled(true);
+    dm.start();
+    auto end = std::chrono::system_clock::now();
+    std::cout << fmt::format("Program ran for {:L} µs\n", std::chrono::duration_cast<std::chrono::microseconds>(end-start).count());
+
+    return 0;
+}
\ No newline at end of file
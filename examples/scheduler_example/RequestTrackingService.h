@@ -0,0 +1,95 @@
+#pragma once
+
+#include <framework/DependencyManager.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include <optional_bundles/timer_bundle/IScheduler.h>
+#include "framework/Service.h"
+#include "framework/LifecycleManager.h"
+#include <vector>
+
+using namespace Cppelix;
+
+struct IRequestTrackingService : virtual public IService {
+    static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+};
+
+/// Gives a thousand fake requests a deadline each, answers half of them in time and counts how many ran into their deadline
+class RequestTrackingService final : public IRequestTrackingService, public Service {
+public:
+    static constexpr uint64_t REQUESTS = 1'000;
+
+    RequestTrackingService(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+        reg.registerDependency<ILogger>(this, true);
+        reg.registerDependency<IScheduler>(this, true);
+    }
+    ~RequestTrackingService() final = default;
+
+    bool start() final {
+        // deadlines 100 to 200 ms out, a 10 ms slack lets ones close to each other expire in the same wakeup
+        for(uint64_t i = 0; i < REQUESTS; i++) {
+            auto deadline = std::chrono::milliseconds(100) + std::chrono::microseconds(i * 100);
+            _deadlines.push_back(_scheduler->scheduleOnce(deadline, [this](std::chrono::steady_clock::time_point, uint64_t) {
+                deadlineExpired();
+            }, std::chrono::milliseconds(10)));
+        }
+
+        for(uint64_t i = 0; i < REQUESTS; i += 2) {
+            _scheduler->cancel(_deadlines[i]);
+        }
+
+        _heartbeat = _scheduler->scheduleEvery(std::chrono::milliseconds(50), [this](std::chrono::steady_clock::time_point, uint64_t missedTicks) {
+            _heartbeats += 1 + missedTicks;
+        });
+
+        _scheduler->scheduleOnce(std::chrono::milliseconds(300), [this](std::chrono::steady_clock::time_point, uint64_t) {
+            LOG_INFO(_logger, "{} of {} requests ran into their deadline, in {} wakeups. {} heartbeats", _expired, REQUESTS, _wakeUps, _heartbeats);
+            getManager()->pushPrioritisedEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY + 1);
+        });
+        return true;
+    }
+
+    bool stop() final {
+        for(auto deadline : _deadlines) {
+            _scheduler->cancel(deadline);
+        }
+        _deadlines.clear();
+        _scheduler->cancel(_heartbeat);
+        return true;
+    }
+
+    void addDependencyInstance(ILogger *logger) {
+        _logger = logger;
+    }
+
+    void removeDependencyInstance(ILogger *logger) {
+        _logger = nullptr;
+    }
+
+    void addDependencyInstance(IScheduler *scheduler) {
+        _scheduler = scheduler;
+    }
+
+    void removeDependencyInstance(IScheduler *scheduler) {
+        _scheduler = nullptr;
+    }
+
+private:
+    void deadlineExpired() {
+        // callbacks of one wakeup run back to back
+        auto now = std::chrono::steady_clock::now();
+        if(now - _lastExpiry > std::chrono::microseconds(100)) {
+            _wakeUps++;
+        }
+        _lastExpiry = now;
+        _expired++;
+    }
+
+    ILogger *_logger{nullptr};
+    IScheduler *_scheduler{nullptr};
+    std::vector<TimerHandle> _deadlines{};
+    TimerHandle _heartbeat{};
+    uint64_t _expired{0};
+    uint64_t _wakeUps{0};
+    uint64_t _heartbeats{0};
+    std::chrono::steady_clock::time_point _lastExpiry{};
+};
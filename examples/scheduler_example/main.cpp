@@ -0,0 +1,39 @@
+#include "RequestTrackingService.h"
+#include <optional_bundles/logging_bundle/LoggerAdmin.h>
+#ifdef USE_SPDLOG
+#include <optional_bundles/logging_bundle/SpdlogFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/SpdlogLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE SpdlogFrameworkLogger
+#define LOGGER_TYPE SpdlogLogger
+#else
+#include <optional_bundles/logging_bundle/CoutFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/CoutLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE CoutFrameworkLogger
+#define LOGGER_TYPE CoutLogger
+#endif
+#include <optional_bundles/timer_bundle/SchedulerService.h>
+#include <chrono>
+#include <iostream>
+
+using namespace std::string_literals;
+
+int main() {
+    std::locale::global(std::locale("en_US.UTF-8"));
+
+    auto start = std::chrono::system_clock::now();
+    DependencyManager dm{};
+    auto logMgr = dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
+#ifdef USE_SPDLOG
+    dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
+#endif
+    dm.createServiceManager<LoggerAdmin<LOGGER_TYPE>, ILoggerAdmin>();
+    dm.createServiceManager<Scheduler, IScheduler>();
+    dm.createServiceManager<RequestTrackingService, IRequestTrackingService>();
+    dm.start();
+    auto end = std::chrono::system_clock::now();
+    std::cout << fmt::format("Program ran for {:L} µs\n", std::chrono::duration_cast<std::chrono::microseconds>(end-start).count());
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <framework/DependencyManager.h>
+#include <framework/ShardedRuntime.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include "framework/Service.h"
+#include "framework/LifecycleManager.h"
+#include "TokenEvent.h"
+#include <atomic>
+
+using namespace Cppelix;
+
+struct IConnectionService : virtual public IService {
+    static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+};
+
+/// One instance per connection, living on the shard that owns the connection's key
+class ConnectionService final : public IConnectionService, public Service {
+public:
+    static constexpr uint64_t CONNECTIONS = 64;
+
+    ConnectionService(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+        reg.registerDependency<ILogger>(this, true);
+        _key = *getProperties()->find(ShardedRuntime::SHARD_KEY_PROPERTY)->second.get<uint64_t>();
+    }
+    ~ConnectionService() final = default;
+
+    bool start() final {
+        _tokenEventHandler = getManager()->registerEventHandler<TokenEvent>(getServiceId(), this);
+        started.fetch_add(1, std::memory_order_acq_rel);
+        return true;
+    }
+
+    bool stop() final {
+        _tokenEventHandler.reset();
+        return true;
+    }
+
+    void addDependencyInstance(ILogger *logger) {
+        _logger = logger;
+    }
+
+    void removeDependencyInstance(ILogger *logger) {
+        _logger = nullptr;
+    }
+
+    Generator<bool> handleEvent(TokenEvent const * const evt) {
+        // every connection of this shard sees the event, only the one it is meant for passes it on
+        if(evt->key != _key) {
+            co_return true;
+        }
+
+        auto *runtime = ShardedRuntime::current();
+        if(evt->hopsLeft == 0) {
+            LOG_INFO(_logger, "Token ended at connection {} on shard {}", _key, *ShardedRuntime::currentShard());
+            runtime->stop();
+            co_return (bool)PreventOthersHandling;
+        }
+
+        auto next = (_key + 1) % CONNECTIONS;
+        runtime->sendEventToShard<TokenEvent>(next, getServiceId(), next, evt->hopsLeft - 1);
+        co_return (bool)PreventOthersHandling;
+    }
+
+    static inline std::atomic<uint64_t> started{0};
+
+private:
+    ILogger *_logger{nullptr};
+    uint64_t _key;
+    std::unique_ptr<EventHandlerRegistration> _tokenEventHandler{};
+};
@@ -0,0 +1,17 @@
+#pragma once
+
+#include "framework/Events.h"
+
+namespace Cppelix {
+    /// Passed from connection to connection, key says which connection has to handle it next
+    struct TokenEvent final : public Event {
+        TokenEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, uint64_t _key, uint64_t _hopsLeft) noexcept :
+                Event(TYPE, NAME, _id, _originatingService, _priority), key(_key), hopsLeft(_hopsLeft) {}
+        ~TokenEvent() final = default;
+
+        const uint64_t key;
+        const uint64_t hopsLeft;
+        static constexpr uint64_t TYPE = typeNameHash<TokenEvent>();
+        static constexpr std::string_view NAME = typeName<TokenEvent>();
+    };
+}
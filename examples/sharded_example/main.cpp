@@ -0,0 +1,53 @@
+#include "ConnectionService.h"
+#include <optional_bundles/logging_bundle/LoggerAdmin.h>
+#ifdef USE_SPDLOG
+#include <optional_bundles/logging_bundle/SpdlogFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/SpdlogLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE SpdlogFrameworkLogger
+#define LOGGER_TYPE SpdlogLogger
+#else
+#include <optional_bundles/logging_bundle/CoutFrameworkLogger.h>
+#include <optional_bundles/logging_bundle/CoutLogger.h>
+
+#define FRAMEWORK_LOGGER_TYPE CoutFrameworkLogger
+#define LOGGER_TYPE CoutLogger
+#endif
+#include <framework/ShardedRuntime.h>
+#include <chrono>
+#include <iostream>
+#include <thread>
+
+int main() {
+    std::locale::global(std::locale("en_US.UTF-8"));
+
+    constexpr uint64_t hops = 100'000;
+    ShardedRuntime runtime{};
+
+    runtime.onEveryShard([](DependencyManager &dm, size_t) {
+        dm.createServiceManager<FRAMEWORK_LOGGER_TYPE, IFrameworkLogger>();
+#ifdef USE_SPDLOG
+        dm.createServiceManager<SpdlogSharedService, ISpdlogSharedService>();
+#endif
+        dm.createServiceManager<LoggerAdmin<LOGGER_TYPE>, ILoggerAdmin>();
+    });
+
+    for(uint64_t key = 0; key < ConnectionService::CONNECTIONS; key++) {
+        runtime.createShardedService<ConnectionService, IConnectionService>(key);
+    }
+
+    runtime.start();
+    while(ConnectionService::started.load(std::memory_order_acquire) != ConnectionService::CONNECTIONS) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    runtime.sendEventToShard<TokenEvent>(0, 0, uint64_t{0}, hops);
+    runtime.join();
+    auto end = std::chrono::steady_clock::now();
+
+    std::cout << fmt::format("Passed token {:L} times between {} connections on {} shards in {:L} µs\n", hops, ConnectionService::CONNECTIONS,
+                             runtime.shardCount(), std::chrono::duration_cast<std::chrono::microseconds>(end - start).count());
+
+    return 0;
+}
@@ -16,7 +16,7 @@ class RuntimeCreatedService : public IRuntimeCreatedService, public Service {
 public:
     ~RuntimeCreatedService() final = default;
     bool start() final {
-        auto scope = std::any_cast<std::string>(_properties["scope"]);
+        auto scope = std::any_cast<std::string>(getProperties()->at("scope"));
         LOG_INFO(_logger, "RuntimeCreatedService started with scope {}", scope);
         return true;
     }
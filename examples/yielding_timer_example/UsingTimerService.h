@@ -57,7 +57,7 @@ public:
         }
 
         if(_timerTriggerCount == 2) {
-            getManager()->pushEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY+1);
+            getManager()->pushPrioritisedEvent<QuitEvent>(getServiceId(), INTERNAL_EVENT_PRIORITY+1);
         }
 
         LOG_INFO(_logger, "Timer {} completed 'long' task", getServiceId());
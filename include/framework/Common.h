@@ -1,7 +1,9 @@
 #pragma once
 
 #include "framework/ConstevalHash.h"
+#include "framework/Properties.h"
 #include <any>
+#include <string>
 #include <string_view>
 #include <unordered_map>
 
@@ -81,19 +83,7 @@ namespace Cppelix {
     template<typename... Type>
     inline constexpr InterfacesList_t<Type...> InterfacesList{};
 
-#if __cpp_lib_generic_unordered_lookup >= 201811
-    struct string_hash {
-        using transparent_key_equal = std::equal_to<>;  // Pred to use
-        using hash_type = std::hash<std::string_view>;  // just a helper local type
-        size_t operator()(std::string_view txt) const   { return hash_type{}(txt); }
-        size_t operator()(const std::string& txt) const { return hash_type{}(txt); }
-        size_t operator()(const char* txt) const        { return hash_type{}(txt); }
-    };
-
-    using CppelixProperties = std::unordered_map<std::string, std::any, string_hash>;
-#else
-    using CppelixProperties = std::unordered_map<std::string, std::any>;
-#endif
+    using CppelixProperties = Properties;
 
     inline constexpr bool PreventOthersHandling = false;
     inline constexpr bool AllowOthersHandling = false;
@@ -1,57 +1,156 @@
 #pragma once
 
 #include "DependencyManager.h"
+#include "EpochDomain.h"
+#include "SharedMemoryTransport.h"
+#include <algorithm>
 #include <mutex>
 #include <iostream>
 
 namespace Cppelix {
+    /// Sending and broadcasting do not lock: they read an immutable snapshot of the registered managers while pinned in the EpochDomain.
+    /// addManager and removeManager copy the snapshot, publish the copy and retire the old one. Only they serialize on _mutex.
+    /// With a SharedMemoryTransport set, broadcasts also reach managers of other processes and ids from the transport can be sent to, as
+    /// long as the event arguments don't point into this process.
     class CommunicationChannel {
     public:
+        CommunicationChannel() = default;
+        ~CommunicationChannel() {
+            delete _managers.load(std::memory_order_acquire);
+        }
+
+        CommunicationChannel(const CommunicationChannel&) = delete;
+        CommunicationChannel(CommunicationChannel&&) = delete;
+        CommunicationChannel& operator=(const CommunicationChannel&) = delete;
+        CommunicationChannel& operator=(CommunicationChannel&&) = delete;
+
         void addManager(DependencyManager* manager) {
             std::unique_lock l(_mutex);
             manager->setCommunicationChannel(this);
-            _managers.try_emplace(manager->getId(), manager);
+
+            auto const *current = _managers.load(std::memory_order_relaxed);
+            auto id = manager->getId();
+            if(id < current->byId.size() && current->byId[id] != nullptr) {
+                return;
+            }
+
+            auto next = std::make_unique<Managers>(*current);
+            if(id >= next->byId.size()) {
+                next->byId.resize(id + 1, nullptr);
+            }
+            next->byId[id] = manager;
+            next->all.push_back(manager);
+            publish(std::move(next));
         }
 
+        /// transport has to outlive the channel or be reset to nullptr first
+        void setTransport(SharedMemoryTransport *transport) noexcept {
+            _transport.store(transport, std::memory_order_release);
+        }
+
+        /// Returns once no sendEventTo or broadcastEvent can still reach manager, so it is safe to destroy it afterwards
         void removeManager(DependencyManager *manager) {
-            std::unique_lock l(_mutex);
-            manager->setCommunicationChannel(nullptr);
-            _managers.erase(manager->getId());
+            {
+                std::unique_lock l(_mutex);
+                manager->setCommunicationChannel(nullptr);
+
+                auto const *current = _managers.load(std::memory_order_relaxed);
+                auto id = manager->getId();
+                if(id >= current->byId.size() || current->byId[id] == nullptr) {
+                    return;
+                }
+
+                auto next = std::make_unique<Managers>(*current);
+                next->byId[id] = nullptr;
+                std::erase(next->all, manager);
+                publish(std::move(next));
+            }
+
+            EpochDomain::instance().synchronize();
         }
 
         template <typename EventT, typename... Args>
         requires Derived<EventT, Event>
         void broadcastEvent(DependencyManager *originatingManager, Args&&... args) {
-            std::unique_lock l(_mutex);
-            for(auto &[key, manager] : _managers) {
-                if(manager->getId() == originatingManager->getId()) {
-                    continue;
-                }
+            // events with arguments pointing into this process stay in it
+            SharedMemoryTransport *transport = nullptr;
+            if constexpr (CrossProcessArguments<Args...>) {
+                transport = _transport.load(std::memory_order_acquire);
+            }
+            {
+                auto guard = EpochDomain::instance().pin();
+                auto const &managers = _managers.load(std::memory_order_seq_cst)->all;
+                // every push copies args, only the last use of them may move from them
+                auto lastReceiver = std::find_if(managers.rbegin(), managers.rend(), [originatingManager](DependencyManager *manager) noexcept {
+                    return manager != originatingManager;
+                });
+                for(auto *manager : managers) {
+                    if(manager == originatingManager) {
+                        continue;
+                    }
 
 #if 0
-                std::cout << "Inserting event " << typeName<EventT>() << " from manager " << originatingManager->getId() << " into manager " << manager->getId() << std::endl;
+                    std::cout << "Inserting event " << typeName<EventT>() << " from manager " << originatingManager->getId() << " into manager " << manager->getId() << std::endl;
 #endif
-                manager->template pushEvent<EventT>(std::forward<Args>(args)...);
+                    if(transport == nullptr && manager == *lastReceiver) {
+                        manager->template pushEvent<EventT>(std::forward<Args>(args)...);
+                    } else {
+                        manager->template pushEvent<EventT>(args...);
+                    }
 #if 0
-                std::cout << "Inserted event " << typeName<EventT>() << " from manager " << originatingManager->getId() << " into manager " << manager->getId() << std::endl;
+                    std::cout << "Inserted event " << typeName<EventT>() << " from manager " << originatingManager->getId() << " into manager " << manager->getId() << std::endl;
 #endif
+                }
+            }
+
+            // outside of the epoch, writing to a full ring blocks
+            if constexpr (CrossProcessArguments<Args...>) {
+                if(transport != nullptr) {
+                    transport->template broadcastEvent<EventT>(args...);
+                }
             }
         }
 
+        /// \param id DependencyManager::getId() of the receiving manager, doubles as index into the snapshot.
+        /// Or an id from SharedMemoryTransport::attachManager/findManager, for a manager in any process.
         template <typename EventT, typename... Args>
         requires Derived<EventT, Event>
         void sendEventTo(uint64_t id, Args&&... args) {
-            std::unique_lock l(_mutex);
-            auto manager = _managers.find(id);
+            if((id & SharedMemoryTransport::REMOTE_MANAGER_BIT) != 0) {
+                if constexpr (CrossProcessArguments<Args...>) {
+                    auto *transport = _transport.load(std::memory_order_acquire);
+                    if(transport == nullptr) {
+                        throw std::runtime_error("Couldn't find manager");
+                    }
 
-            if(manager == end(_managers)) {
+                    transport->template sendEventTo<EventT>(id, args...);
+                    return;
+                } else {
+                    throw std::runtime_error("Event arguments pointing into this process can't be sent to another one");
+                }
+            }
+
+            auto guard = EpochDomain::instance().pin();
+            auto const *managers = _managers.load(std::memory_order_seq_cst);
+
+            if(id >= managers->byId.size() || managers->byId[id] == nullptr) {
                 throw std::runtime_error("Couldn't find manager");
             }
 
-            manager->second->pushEvent<EventT>(std::forward<Args>(args)...);
+            managers->byId[id]->template pushEvent<EventT>(std::forward<Args>(args)...);
         }
     private:
-        std::unordered_map<uint64_t, DependencyManager*> _managers{};
+        struct Managers final {
+            std::vector<DependencyManager*> byId{}; // manager ids are handed out sequentially, nullptr for ids not in this channel
+            std::vector<DependencyManager*> all{};
+        };
+
+        void publish(std::unique_ptr<Managers> next) {
+            EpochDomain::instance().retire(_managers.exchange(next.release(), std::memory_order_seq_cst));
+        }
+
+        std::atomic<Managers*> _managers{new Managers{}};
+        std::atomic<SharedMemoryTransport*> _transport{nullptr};
         std::mutex _mutex{};
     };
-}
\ No newline at end of file
+}
@@ -53,6 +53,16 @@ namespace Cppelix {
         { impl.postInterceptEvent(evt, processed) } -> std::same_as<bool>;
     };
 
+    template <class ImplT>
+    concept ParallelStartSafe = requires {
+        requires ImplT::parallelStartSafe;
+    };
+
+    template <class ImplT>
+    concept ParallelStopSafe = requires {
+        requires ImplT::parallelStopSafe;
+    };
+
     template <class ImplT, class Interface>
     concept ImplementsTrackingHandlers = requires(ImplT impl, Interface *svc, DependencyRequestEvent const * const reqEvt, DependencyUndoRequestEvent const * const reqUndoEvt) {
         { impl.handleDependencyRequest(svc, reqEvt) } -> std::same_as<void>;
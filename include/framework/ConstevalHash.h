@@ -2,9 +2,11 @@
 
 #include <wyhash.h>
 
-static consteval uint64_t consteval_wyrotr(uint64_t v, unsigned k) { return (v >> k) | (v << (64 - k)); }
+// constexpr rather than consteval: PropertyKey hashes runtime strings with these as well, so they always agree with the compile time hashes.
 
-static consteval uint64_t consteval_wymum(uint64_t A, uint64_t B) {
+static constexpr uint64_t consteval_wyrotr(uint64_t v, unsigned k) { return (v >> k) | (v << (64 - k)); }
+
+static constexpr uint64_t consteval_wymum(uint64_t A, uint64_t B) {
 #ifdef    WYHASH32
     uint64_t	hh=(A>>32)*(B>>32),	hl=(A>>32)*(unsigned)B,	lh=(unsigned)A*(B>>32),	ll=(uint64_t)(unsigned)A*(unsigned)B;
         return	consteval_wyrotr(hl,32)^consteval_wyrotr(lh,32)^hh^ll;
@@ -24,7 +26,7 @@ static consteval uint64_t consteval_wymum(uint64_t A, uint64_t B) {
 }
 
 template<typename T>
-static consteval uint64_t consteval_wyr8(const T *p) {
+static constexpr uint64_t consteval_wyr8(const T *p) {
     uint64_t v = 0;
     v = ((uint64_t) p[0] << 56U) | ((uint64_t) p[1] << 48U) | ((uint64_t) p[2] << 40U) | ((uint64_t) p[3] << 32U) |
         (p[4] << 24U) | (p[5] << 16U) | (p[6] << 8U) | p[7];
@@ -32,19 +34,19 @@ static consteval uint64_t consteval_wyr8(const T *p) {
 }
 
 template<typename T>
-static consteval uint64_t consteval_wyr4(const T *p) {
+static constexpr uint64_t consteval_wyr4(const T *p) {
     uint32_t v = 0;
     v = (p[0] << 24U) | (p[1] << 16U) | (p[2] << 8U) | p[3];
     return v;
 }
 
 template<typename T>
-static consteval uint64_t consteval_wyr3(const T *p, unsigned k) {
+static constexpr uint64_t consteval_wyr3(const T *p, unsigned k) {
     return (((uint64_t) p[0]) << 16U) | (((uint64_t) p[k >> 1U]) << 8U) | p[k - 1];
 }
 
 template<typename T>
-static consteval uint64_t consteval_wyhash(const T *key, uint64_t len, uint64_t seed) {
+static constexpr uint64_t consteval_wyhash(const T *key, uint64_t len, uint64_t seed) {
     static_assert(sizeof(T) == 1, "T must be a char or uint8_t kind type");
 #if defined(__GNUC__) || defined(__INTEL_COMPILER)
     if (__builtin_expect(!len, 0)) return 0;
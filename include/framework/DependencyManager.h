@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
 #include <memory>
 #include <cassert>
@@ -10,12 +11,24 @@
 #include <atomic>
 #include <csignal>
 #include <condition_variable>
+#include <limits>
+#include <mutex>
 #include <framework/interfaces/IFrameworkLogger.h>
 #include "Service.h"
 #include "LifecycleManager.h"
 #include "Events.h"
 #include "framework/Callback.h"
 #include "Filter.h"
+#include "ServiceIndex.h"
+#include "ThreadPool.h"
+#include "StartupProfiler.h"
+#include "HandlerProfiler.h"
+#include "QueueMetrics.h"
+#include "EventTracer.h"
+#include "FlightRecorder.h"
+#include "ServiceRegistry.h"
+#include "TimerWheel.h"
+#include "VirtualClock.h"
 
 using namespace std::chrono_literals;
 
@@ -48,6 +61,8 @@ namespace Cppelix {
             other._empty = true;
             _empty = false;
             _type = other._type;
+            _enqueuedAt = other._enqueuedAt;
+            _trace = other._trace;
         }
 
 
@@ -60,6 +75,8 @@ namespace Cppelix {
             other._empty = true;
             _empty = false;
             _type = other._type;
+            _enqueuedAt = other._enqueuedAt;
+            _trace = other._trace;
             return *this;
         }
 
@@ -90,10 +107,30 @@ namespace Cppelix {
         [[nodiscard]] uint64_t getType() const noexcept {
             return _type;
         }
+
+        /// \return steady_clock ns of when the event was pushed, 0 if neither queue metrics nor the flight recorder were enabled
+        [[nodiscard]] uint64_t getEnqueuedAt() const noexcept {
+            return _enqueuedAt;
+        }
+
+        void setEnqueuedAt(uint64_t timestamp) noexcept {
+            _enqueuedAt = timestamp;
+        }
+
+        /// \return parent event and trace the event belongs to, see EventTracer
+        [[nodiscard]] const TraceStamp& getTrace() const noexcept {
+            return _trace;
+        }
+
+        void setTrace(const TraceStamp &trace) noexcept {
+            _trace = trace;
+        }
     private:
 
         std::array<uint8_t, 128> _buffer;
         uint64_t _type{0};
+        uint64_t _enqueuedAt{0}; // kept out of Event, events have all 128 bytes to themselves
+        TraceStamp _trace{};
         bool _empty{true};
     };
 
@@ -146,7 +183,7 @@ namespace Cppelix {
 
     class [[nodiscard]] DependencyTrackerRegistration final {
     public:
-        DependencyTrackerRegistration(DependencyManager *mgr, uint64_t interfaceNameHash) noexcept : _mgr(mgr), _interfaceNameHash(interfaceNameHash) {}
+        DependencyTrackerRegistration(DependencyManager *mgr, uint64_t interfaceNameHash, uint64_t trackerId) noexcept : _mgr(mgr), _interfaceNameHash(interfaceNameHash), _trackerId(trackerId) {}
         DependencyTrackerRegistration() noexcept = default;
         ~DependencyTrackerRegistration();
 
@@ -157,35 +194,69 @@ namespace Cppelix {
     private:
         DependencyManager *_mgr{nullptr};
         uint64_t _interfaceNameHash{0};
+        uint64_t _trackerId{0};
     };
 
     struct DependencyTrackerInfo final {
-        DependencyTrackerInfo(uint64_t _trackingServiceId, std::function<void(Event const * const)> _trackFunc) noexcept : trackingServiceId(_trackingServiceId), trackFunc(std::move(_trackFunc)) {}
+        DependencyTrackerInfo(uint64_t _trackingServiceId, uint64_t _trackerId, std::function<void(Event const * const)> _requestFunc, std::function<void(Event const * const)> _undoRequestFunc) noexcept :
+            trackingServiceId(_trackingServiceId), trackerId(_trackerId), requestFunc(std::move(_requestFunc)), undoRequestFunc(std::move(_undoRequestFunc)) {}
         ~DependencyTrackerInfo() = default;
         uint64_t trackingServiceId;
-        std::function<void(Event const * const)> trackFunc;
+        uint64_t trackerId;
+        uint64_t registeredAt{0}; // id of the first event pushed after the tracker was registered
+        std::function<void(Event const * const)> requestFunc;
+        std::function<void(Event const * const)> undoRequestFunc;
+    };
+
+    struct SlowStopper final {
+        uint64_t serviceId;
+        std::string_view implementationName;
+        std::chrono::nanoseconds duration;
+    };
+
+    struct ParallelStartInfo final {
+        uint64_t originatingServiceId;
+        bool startRequestedAgain;
     };
 
+    struct ServiceFactoryInfo final {
+        std::string_view implementationName;
+        std::function<uint64_t()> create; // returns the id of the created service
+        std::optional<std::chrono::milliseconds> idleTimeout;
+        uint64_t serviceId{0}; // 0 while not instantiated
+        std::optional<std::chrono::steady_clock::time_point> idleSince{};
+    };
+
+    /// Gets the deadline that expired and how many later deadlines of a periodic timer had passed by then as well. Those are skipped, not fired.
+    using TimerCallback = std::function<void(std::chrono::steady_clock::time_point deadline, uint64_t missedTicks)>;
+
     class DependencyManager final {
     public:
-        DependencyManager() : _services(), _dependencyRequestTrackers(), _dependencyUndoRequestTrackers(), _completionCallbacks{}, _errorCallbacks{}, _logger(nullptr), _eventQueue{}, _eventQueueMutex{}, _wakeUp{}, _eventIdCounter{0}, _quit{false}, _communicationChannel(nullptr), _id(_managerIdCounter++) {}
+        /// \param virtualClock runs the manager on simulated time instead of steady_clock, see VirtualClock
+        explicit DependencyManager(std::shared_ptr<VirtualClock> virtualClock = nullptr) : _id(_managerIdCounter++), _virtualClock(std::move(virtualClock)), _services(_id), _dependencyTrackers(), _completionCallbacks{}, _errorCallbacks{}, _logger(nullptr), _eventQueue{}, _eventQueueMutex{}, _wakeUp{}, _eventIdCounter{0}, _quit{false}, _communicationChannel(nullptr) {}
 
         template<Derived<Service> Impl, Derived<IService>... Interfaces>
         requires ImplementsAll<Impl, Interfaces...>
         auto createServiceManager(CppelixProperties properties = CppelixProperties{}) {
             if constexpr(RequestsDependencies<Impl>) {
-                auto cmpMgr = DependencyLifecycleManager<Impl>::template create(_logger, "", std::move(properties), InterfacesList<Interfaces...>);
-
                 if constexpr (ListContainsInterface<IFrameworkLogger, Interfaces...>::value) {
                     throw std::runtime_error("IFrameworkLogger cannot have any dependencies");
                 }
 
+                auto cmpMgr = createLifecycleManager<DependencyLifecycleManager<Impl>, Interfaces...>(std::move(properties));
+
                 logAddService<Impl, Interfaces...>();
 
                 cmpMgr->getService().injectDependencyManager(this);
+                _startupProfiler.serviceInstalled(cmpMgr->serviceId(), cmpMgr->implementationName());
                 bool started = false;
 
-                for (auto &[key, mgr] : _services) {
+                std::vector<uint64_t> providerIds;
+                _serviceIndex.findProviders(*cmpMgr, providerIds);
+                sortByRanking(providerIds);
+                for (auto providerId : providerIds) {
+                    // copy, starting the service may add services and move the registry entries
+                    auto mgr = _services.find(providerId)->second;
                     if (mgr->getServiceState() == ServiceState::ACTIVE) {
                         auto filterProp = mgr->getProperties()->find("Filter");
                         const Filter *filter = nullptr;
@@ -197,27 +268,29 @@ namespace Cppelix {
                             continue;
                         }
 
-                        started = cmpMgr->dependencyOnline(mgr);
-                        if (started) {
+                        // no break once started, provider sets of the service still take the remaining providers
+                        if (cmpMgr->dependencyOnline(mgr) && !started) {
+                            started = true;
                             pushEventInternal<DependencyOnlineEvent>(0, INTERNAL_EVENT_PRIORITY, cmpMgr);
-                            break;
                         }
                     }
                 }
 
-                for (const auto &[key, registration] : cmpMgr->getDependencyRegistry()->_registrations) {
-                    const auto &props = std::get<std::optional<CppelixProperties>>(registration);
-                    pushEventInternal<DependencyRequestEvent>(cmpMgr->serviceId(), INTERNAL_EVENT_PRIORITY, cmpMgr, std::get<Dependency>(registration), props.has_value() ? &props.value() : std::optional<CppelixProperties const *>{});
+                for (const auto &registration : cmpMgr->getDependencyRegistry()->_registrations) {
+                    const auto &props = registration.properties;
+                    pushEventInternal<DependencyRequestEvent>(cmpMgr->serviceId(), INTERNAL_EVENT_PRIORITY, cmpMgr, registration.dependency, props.has_value() ? &props.value() : std::optional<CppelixProperties const *>{});
                 }
 
+                // with a thread pool, dependencyOnline() queued the start of a parallel start safe service already
                 if(!started) {
-                    pushEventInternal<StartServiceEvent>(0, INTERNAL_EVENT_PRIORITY, cmpMgr->serviceId());
+                    requestStart(cmpMgr->serviceId());
                 }
 
-                _services.emplace(cmpMgr->serviceId(), cmpMgr);
+                _services.insert(cmpMgr->serviceId(), cmpMgr);
+                _serviceIndex.add(cmpMgr);
                 return &cmpMgr->getService();
             } else {
-                auto cmpMgr = LifecycleManager<Impl>::template create(_logger, "", std::move(properties), InterfacesList<Interfaces...>);
+                auto cmpMgr = createLifecycleManager<LifecycleManager<Impl>, Interfaces...>(std::move(properties));
 
                 if constexpr (ListContainsInterface<IFrameworkLogger, Interfaces...>::value) {
                     _logger = &cmpMgr->getService();
@@ -225,16 +298,59 @@ namespace Cppelix {
                 }
 
                 cmpMgr->getService().injectDependencyManager(this);
+                _startupProfiler.serviceInstalled(cmpMgr->serviceId(), cmpMgr->implementationName());
 
                 logAddService<Impl, Interfaces...>();
 
-                pushEventInternal<StartServiceEvent>(0, INTERNAL_EVENT_PRIORITY, cmpMgr->serviceId());
+                requestStart(cmpMgr->serviceId());
 
-                _services.emplace(cmpMgr->serviceId(), cmpMgr);
+                _services.insert(cmpMgr->serviceId(), cmpMgr);
+                _serviceIndex.add(cmpMgr);
                 return &cmpMgr->getService();
             }
         }
 
+        /// Install a service that takes over from an existing one. Once the new service is started, every dependent of the old service gets
+        /// removeDependencyInstance(old) and addDependencyInstance(new) called back to back on the event loop thread and stays ACTIVE.
+        /// The old service is then stopped and removed without sending DependencyOfflineEvents for it, so nothing restarts.
+        /// Dependents that the filter of the new service excludes lose the old service like with a normal removal.
+        /// Throws std::runtime_error if serviceId is unknown or the new service does not provide every interface of the old one.
+        /// \param serviceId id of the service to replace
+        /// \param properties properties for the new service
+        /// \return the new service, not started yet
+        template<Derived<Service> Impl, Derived<IService>... Interfaces>
+        requires ImplementsAll<Impl, Interfaces...>
+        auto replaceServiceManager(uint64_t serviceId, CppelixProperties properties = CppelixProperties{}) {
+            checkReplaceable(serviceId, std::vector<InterfaceKey>{InterfaceKey{typeNameHash<Interfaces>(), Interfaces::version}...});
+
+            auto *svc = createServiceManager<Impl, Interfaces...>(std::move(properties));
+            _pendingReplacements.emplace(static_cast<Service*>(svc)->getServiceId(), serviceId);
+            return svc;
+        }
+
+        /// Register a service without constructing it. It gets created, and started as usual, when the first DependencyRequestEvent for one of its
+        /// interfaces is processed, or right away when an installed service already requested one of them.
+        /// Every factory registered for a requested interface is instantiated, not just the first one.
+        /// Like createServiceManager, has to be called before start() or from the event loop thread.
+        /// \param properties properties to construct the service with
+        /// \param idleTimeout if set, the service is removed again once no service requesting its interfaces has been installed for this long.
+        ///                    The next request creates it anew.
+        template<Derived<Service> Impl, Derived<IService>... Interfaces>
+        requires ImplementsAll<Impl, Interfaces...>
+        void registerServiceFactory(CppelixProperties properties = CppelixProperties{}, std::optional<std::chrono::milliseconds> idleTimeout = {}) {
+            static_assert(!ListContainsInterface<IFrameworkLogger, Interfaces...>::value, "IFrameworkLogger has to exist before anything else, it cannot be created lazily");
+
+            auto factoryIndex = _serviceFactories.size();
+            _serviceFactories.emplace_back(ServiceFactoryInfo{typeName<Impl>(), [this, properties = std::move(properties)]() {
+                return static_cast<Service*>(createServiceManager<Impl, Interfaces...>(properties))->getServiceId();
+            }, idleTimeout});
+            (_serviceFactoriesByInterface[typeNameHash<Interfaces>()].push_back(factoryIndex), ...);
+
+            if((_serviceIndex.hasDependents(typeNameHash<Interfaces>()) || ...)) {
+                instantiateServiceFactory(factoryIndex);
+            }
+        }
+
         /// Push event into event loop with specified priority
         /// \tparam EventT Type of event to push, has to derive from Event
         /// \tparam Args auto-deducible arguments for EventT constructor
@@ -252,8 +368,12 @@ namespace Cppelix {
             }
 
             uint64_t eventId = _eventIdCounter.fetch_add(1, std::memory_order_acq_rel);
+            auto evt = EventStackUniquePtr::create<EventT>(std::forward<uint64_t>(eventId), std::forward<uint64_t>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...);
+            evt.setEnqueuedAt(enqueueTimestamp());
+            evt.setTrace(EventTracer::stampPush());
             _eventQueueMutex.lock();
-            _eventQueue.emplace(priority, EventStackUniquePtr::create<EventT>(std::forward<uint64_t>(eventId), std::forward<uint64_t>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...));
+            _eventQueue.emplace(priority, std::move(evt));
+            _queueMetrics.pushed(priority);
             _eventQueueMutex.unlock();
             _wakeUp.notify_all();
             LOG_TRACE(_logger, "inserted event of type {} into manager {}", typeName<EventT>(), getId());
@@ -277,8 +397,12 @@ namespace Cppelix {
             }
 
             uint64_t eventId = _eventIdCounter.fetch_add(1, std::memory_order_acq_rel);
+            auto evt = EventStackUniquePtr::create<EventT>(std::forward<uint64_t>(eventId), std::forward<uint64_t>(originatingServiceId), INTERNAL_EVENT_PRIORITY, std::forward<Args>(args)...);
+            evt.setEnqueuedAt(enqueueTimestamp());
+            evt.setTrace(EventTracer::stampPush());
             _eventQueueMutex.lock();
-            _eventQueue.emplace(INTERNAL_EVENT_PRIORITY, EventStackUniquePtr::create<EventT>(std::forward<uint64_t>(eventId), std::forward<uint64_t>(originatingServiceId), INTERNAL_EVENT_PRIORITY, std::forward<Args>(args)...));
+            _eventQueue.emplace(INTERNAL_EVENT_PRIORITY, std::move(evt));
+            _queueMetrics.pushed(INTERNAL_EVENT_PRIORITY);
             _eventQueueMutex.unlock();
             _wakeUp.notify_all();
             LOG_TRACE(_logger, "inserted event of type {} into manager {}", typeName<EventT>(), getId());
@@ -295,43 +419,16 @@ namespace Cppelix {
         /// \param impl class that is registering handler
         /// \return RAII handler, removes registration upon destruction
         std::unique_ptr<DependencyTrackerRegistration> registerDependencyTracker(uint64_t serviceId, Impl *impl) {
-            auto requestTrackersForType = _dependencyRequestTrackers.find(typeNameHash<Interface>());
-            auto undoRequestTrackersForType = _dependencyUndoRequestTrackers.find(typeNameHash<Interface>());
-
-            DependencyTrackerInfo requestInfo{impl->getServiceId(), [impl](Event const * const evt){ impl->handleDependencyRequest(static_cast<Interface*>(nullptr), static_cast<DependencyRequestEvent const *>(evt)); }};
-            DependencyTrackerInfo undoRequestInfo{impl->getServiceId(), [impl](Event const * const evt){ impl->handleDependencyUndoRequest(static_cast<Interface*>(nullptr), static_cast<DependencyUndoRequestEvent const *>(evt)); }};
-
-            for(auto &[key, mgr] : _services) {
-                auto const * depRegistry = mgr->getDependencyRegistry();
-
-                if(depRegistry == nullptr) {
-                    continue;
-                }
-
-                for (const auto &[regKey, registration] : depRegistry->_registrations) {
-                    if(regKey == InterfaceKey{typeNameHash<Interface>(), Interface::version}) {
-                        const auto &props = std::get<std::optional<CppelixProperties>>(registration);
-                        DependencyRequestEvent evt{0, mgr->serviceId(), INTERNAL_EVENT_PRIORITY, mgr, std::get<Dependency>(registration), props.has_value() ? &props.value() : std::optional<CppelixProperties const *>{}};
-                        requestInfo.trackFunc(&evt);
-                    }
-                }
-            }
-
-            if(requestTrackersForType == end(_dependencyRequestTrackers)) {
-                _dependencyRequestTrackers.emplace(typeNameHash<Interface>(), std::vector<DependencyTrackerInfo>{requestInfo});
-            } else {
-                requestTrackersForType->second.emplace_back(std::move(requestInfo));
-            }
+            DependencyTrackerInfo info{impl->getServiceId(), 0,
+                                       [impl](Event const * const evt){ impl->handleDependencyRequest(static_cast<Interface*>(nullptr), static_cast<DependencyRequestEvent const *>(evt)); },
+                                       [impl](Event const * const evt){ impl->handleDependencyUndoRequest(static_cast<Interface*>(nullptr), static_cast<DependencyUndoRequestEvent const *>(evt)); }};
 
-            if(undoRequestTrackersForType == end(_dependencyUndoRequestTrackers)) {
-                _dependencyUndoRequestTrackers.emplace(typeNameHash<Interface>(), std::vector<DependencyTrackerInfo>{undoRequestInfo});
-            } else {
-                undoRequestTrackersForType->second.emplace_back(std::move(undoRequestInfo));
-            }
+            replayDependencyRequests(InterfaceKey{typeNameHash<Interface>(), Interface::version}, info.requestFunc);
+            auto trackerId = addDependencyTracker(typeNameHash<Interface>(), std::move(info));
 
             // I think there's a bug in GCC 10.1, where if I don't make this a unique_ptr, the DependencyTrackerRegistration destructor immediately gets called for some reason.
             // Even if the result is stored in a variable at the caller site.
-            return std::make_unique<DependencyTrackerRegistration>(this, typeNameHash<Interface>());
+            return std::make_unique<DependencyTrackerRegistration>(this, typeNameHash<Interface>(), trackerId);
         }
 
         template <typename EventT, typename Impl>
@@ -420,9 +517,120 @@ namespace Cppelix {
 
         [[nodiscard]] std::optional<std::string_view> getImplementationNameFor(uint64_t serviceId);
 
+        /// Run start() of services that declare `static constexpr bool parallelStartSafe = true;` on a thread pool instead of the event loop thread.
+        /// Services are still only started once their required dependencies are online and dependents get notified on the event loop thread once start() finished.
+        /// The same goes for stop() of services declaring `static constexpr bool parallelStopSafe = true;` when quitting.
+        /// Has to be called before start()
+        /// \param threadCount amount of threads to run start()/stop() on
+        void enableLifecycleThreadPool(uint32_t threadCount);
+
+        /// \return true if enableLifecycleThreadPool was called
+        [[nodiscard]] bool lifecycleThreadPoolEnabled() const noexcept {
+            return _lifecycleThreadPool != nullptr;
+        }
+
+        /// Push a StartServiceEvent for serviceId, unless one is queued already. Event loop thread only, or before start()
+        void requestStart(uint64_t serviceId, uint64_t originatingServiceId = 0) {
+            if(_queuedStarts.insert(serviceId).second) {
+                pushEventInternal<StartServiceEvent>(originatingServiceId, INTERNAL_EVENT_PRIORITY, serviceId);
+            }
+        }
+
+        /// Services taking longer than this to stop when quitting get logged and end up in getSlowStoppers(). Defaults to one second.
+        void setStopTimeout(std::chrono::milliseconds timeout) noexcept {
+            _stopTimeout = timeout;
+        }
+
+        /// Only valid after start() returned
+        /// \return services that took longer than the stop timeout to stop when quitting, slowest first
+        [[nodiscard]] const std::vector<SlowStopper>& getSlowStoppers() const noexcept {
+            return _slowStoppers;
+        }
+
+        /// Timestamps of install, dependencies satisfied and start() of every service. Enabled by default.
+        /// \return profiler, can be used from any thread
+        [[nodiscard]] StartupProfiler& getStartupProfiler() noexcept {
+            return _startupProfiler;
+        }
+
+        /// Wait times are only recorded after setQueueMetricsEnabled(true), push and dispatch counts always. Can be called from any thread.
+        /// \return current depth per priority, push and dispatch counts and how long events waited in the queue
+        [[nodiscard]] QueueMetricsSnapshot getQueueMetrics();
+
+        void setQueueMetricsEnabled(bool enabled) {
+            _queueMetrics.setEnabled(enabled);
+        }
+
+        /// The last FlightRecorder::CAPACITY events this manager handled. Enabled by default.
+        /// \return recorder, can be dumped from any thread
+        [[nodiscard]] FlightRecorder& getFlightRecorder() noexcept {
+            return _flightRecorder;
+        }
+
+        /// Time spent in each event handler, per service and event type. Disabled by default.
+        /// \return profiler, can be used from any thread
+        [[nodiscard]] HandlerProfiler& getHandlerProfiler() noexcept {
+            return _handlerProfiler;
+        }
+
+        /// Run callback on the event loop thread once delay passed, and every interval after that unless interval is zero.
+        /// All timers of a manager share one timing wheel that the event loop advances, no thread is started per timer.
+        /// Deadlines are absolute on steady_clock and counted from the previous deadline, so periodic timers don't drift. The loop checks for
+        /// expired timers between events as well, a long queue doesn't hold them back.
+        /// Can be called from any thread, timer callbacks included.
+        /// \param slack how late the callback may run, at most an interval. Timers with slack fire on a coarser grid of ticks, so the loop
+        /// wakes up once for timers whose deadlines lie close together instead of once for each
+        /// \param ownerServiceId service on whose behalf the timer runs, for cancelTimersOf(). 0 for none
+        /// \return handle for cancelTimer() and setTimerInterval()
+        uint64_t scheduleTimer(std::chrono::nanoseconds delay, std::chrono::nanoseconds interval, TimerCallback callback, std::chrono::nanoseconds slack = {}, uint64_t ownerServiceId = 0);
+
+        /// Can be called from any thread. A callback that is running on the event loop thread at that moment still finishes.
+        /// \return false if the timer already fired for the last time or was cancelled before
+        bool cancelTimer(uint64_t handle);
+
+        /// Cancel every timer scheduled with ownerServiceId, e.g. when that service stops. Takes time linear in the amount of timers ever
+        /// scheduled at once, meant for teardown rather than for cancelling single timers.
+        /// \return amount of timers cancelled
+        size_t cancelTimersOf(uint64_t ownerServiceId);
+
+        /// The next deadline moves to one new interval after the previous one, or right away if that passed already.
+        /// Called from the timer's own callback, it applies to the deadline after the one that fired.
+        /// \return false if the timer does not exist anymore
+        bool setTimerInterval(uint64_t handle, std::chrono::nanoseconds interval);
+
+        /// Timer slack of the event loop thread, see prctl(PR_SET_TIMERSLACK). Linux defaults to 50 µs, lower it for short periodic timers
+        /// that need little jitter. Has to be called before start()
+        void setTimerSlack(std::chrono::nanoseconds slack) noexcept {
+            _timerSlack = slack;
+        }
+
+        /// \return time timers and idle timeouts of this manager go by: steady_clock, or the VirtualClock given to the constructor
+        [[nodiscard]] std::chrono::steady_clock::time_point now() const noexcept {
+            return _virtualClock == nullptr ? std::chrono::steady_clock::now() : _virtualClock->now();
+        }
+
+        /// \return nullptr unless the manager simulates time
+        [[nodiscard]] VirtualClock* getVirtualClock() const noexcept {
+            return _virtualClock.get();
+        }
+
         void start();
 
     private:
+        /// Construct the lifecycle manager, handing the id reserved in _services to the Service constructor
+        template <typename ManagerT, typename... Interfaces>
+        std::shared_ptr<ManagerT> createLifecycleManager(CppelixProperties properties) {
+            auto serviceId = _services.reserve();
+            Service::_nextServiceId = serviceId;
+            try {
+                return ManagerT::template create(_logger, "", std::move(properties), InterfacesList<Interfaces...>);
+            } catch (...) {
+                Service::_nextServiceId = 0;
+                _services.release(serviceId);
+                throw;
+            }
+        }
+
         template <typename EventT>
         requires Derived<EventT, Event>
         void handleEventError(EventT const * const evt) const {
@@ -469,22 +677,109 @@ namespace Cppelix {
 
         void setCommunicationChannel(CommunicationChannel *channel);
 
+        /// Stops all services in reverse dependency order in one pass. Services that have no running dependents left are stopped together, on the thread pool if allowed.
+        void stopAllServices();
+
+        void startServiceInThreadPool(const std::shared_ptr<ILifecycleManager> &service, uint64_t originatingServiceId);
+
+        /// Appends the services evt stops, removes, replaces or takes dependencies away from, nothing for events that leave running services alone
+        void appendServicesChangedBy(Event const *evt, std::vector<uint64_t> &out) const;
+
+        /// Services cannot be stopped or have their dependencies removed while their start() runs on the thread pool. Events that would are held
+        /// back, and so are later events for the same services, which keeps the offline, stop and remove events of a service in order.
+        /// A held back QuitEvent holds back starting services as well, so new parallel starts cannot postpone it forever.
+        /// \return true if evt has to wait, it is accounted as held back then
+        [[nodiscard]] bool holdUntilParallelStartsFinish(Event const *evt);
+
+        /// Requeue the held back events that no longer have to wait, in front of their priority in the order they came in
+        void releaseEventsWaitingOnParallelStarts();
+
+        /// Throws std::runtime_error if serviceId is unknown or provides an interface missing from interfaces
+        void checkReplaceable(uint64_t serviceId, const std::vector<InterfaceKey> &interfaces) const;
+
+        /// Order serviceIds by the "ServiceRanking" property, highest first. Services with equal ranking keep their order.
+        void sortByRanking(std::vector<uint64_t> &serviceIds) const;
+
+        /// Move the dependents of the service replaced by newProvider over to newProvider and remove the replaced service
+        void swapProvider(uint64_t oldServiceId, const std::shared_ptr<ILifecycleManager> &newProvider);
+
+        /// Call requestFunc with a DependencyRequestEvent for every installed service that requested key
+        void replayDependencyRequests(InterfaceKey key, const std::function<void(Event const * const)> &requestFunc);
+
+        /// Assigns the id only now, after the replay, so the trackers of an interface stay ordered by id
+        /// \return id of the tracker, to remove it with
+        uint64_t addDependencyTracker(uint64_t interfaceNameHash, DependencyTrackerInfo info);
+
+        /// Call func of the trackers of interfaceNameHash in the order they were registered, leaving out the ones registered after evt was pushed:
+        /// replayDependencyRequests() already gave them the request. Trackers may add and remove trackers while being called.
+        void callDependencyTrackers(uint64_t interfaceNameHash, Event const *evt, std::function<void(Event const * const)> DependencyTrackerInfo::*func);
+
+        void removeDependencyTracker(uint64_t interfaceNameHash, uint64_t trackerId);
+
+        /// Create the service of a factory, unless it is still installed
+        void instantiateServiceFactory(size_t factoryIndex);
+
+        void instantiateServiceFactoriesFor(uint64_t interfaceNameHash);
+
+        /// Start the idle timeout of factory created services providing interfaceNameHash that have no dependents left
+        void markIdleServiceFactories(uint64_t interfaceNameHash);
+
+        /// Remove factory created services whose idle timeout expired
+        void reclaimIdleServices();
+
+        /// \return microseconds since the manager was constructed, the tick of _timerWheel. Rounded up, so that timers never fire early.
+        [[nodiscard]] uint64_t timerTickOf(std::chrono::steady_clock::time_point time) const noexcept;
+
+        /// \return the current tick of _timerWheel, rounded down: tick n is only reached once n whole microseconds passed
+        [[nodiscard]] uint64_t currentTimerTick() const noexcept;
+
+        [[nodiscard]] bool timersDue() const noexcept {
+            return currentTimerTick() >= _nextTimerTick.load(std::memory_order_relaxed);
+        }
+
+        /// Run the callbacks of all timers that expired
+        void fireTimers();
+
+        /// \return latest, or the moment the timer wheel needs the event loop if that is earlier
+        [[nodiscard]] std::chrono::steady_clock::time_point nextTimerWakeUp(std::chrono::steady_clock::time_point latest) const noexcept;
+
+        /// Wait for events with _eventQueueMutex held by lck. On virtual time, move the clock to the next timer or idle timeout instead
+        /// when nothing else can happen before it.
+        void waitForWork(std::unique_lock<std::mutex> &lck);
+
+        [[nodiscard]] uint64_t enqueueTimestamp() const noexcept {
+            return _queueMetrics.enabled() || _flightRecorder.enabled() ? FlightRecorder::now() : 0;
+        }
+
         template <typename EventT, typename... Args>
         requires Derived<EventT, Event>
         uint64_t pushEventInternal(uint64_t originatingServiceId, uint64_t priority, Args&&... args){
             static_assert(sizeof(EventT) <= 128, "event type cannot be larger than 128 bytes");
 
             uint64_t eventId = _eventIdCounter.fetch_add(1, std::memory_order_acq_rel);
+            auto evt = EventStackUniquePtr::create<EventT>(std::forward<uint64_t>(eventId), std::forward<uint64_t>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...);
+            evt.setEnqueuedAt(enqueueTimestamp());
+            evt.setTrace(EventTracer::stampPush());
             _eventQueueMutex.lock();
-            _eventQueue.emplace(priority, EventStackUniquePtr::create<EventT>(std::forward<uint64_t>(eventId), std::forward<uint64_t>(originatingServiceId), std::forward<uint64_t>(priority), std::forward<Args>(args)...));
+            _eventQueue.emplace(priority, std::move(evt));
+            _queueMetrics.pushed(priority);
             _eventQueueMutex.unlock();
             _wakeUp.notify_all();
             return eventId;
         }
 
-        std::unordered_map<uint64_t, std::shared_ptr<ILifecycleManager>> _services; // key = service id
-        std::unordered_map<uint64_t, std::vector<DependencyTrackerInfo>> _dependencyRequestTrackers; // key = interface name hash
-        std::unordered_map<uint64_t, std::vector<DependencyTrackerInfo>> _dependencyUndoRequestTrackers; // key = interface name hash
+        uint64_t _id; // first, the service registry folds it into service ids
+        std::shared_ptr<VirtualClock> _virtualClock;
+        // declared before _services, services cancel their timers when they are destroyed
+        TimerWheel _timerWheel{};
+        std::recursive_mutex _timerMutex{}; // recursive because timer callbacks run with it held and may schedule or cancel timers
+        std::chrono::steady_clock::time_point _timerEpoch{now()};
+        std::atomic<uint64_t> _nextTimerTick{std::numeric_limits<uint64_t>::max()}; // written with _timerMutex held, max without timers
+        bool _timersChanged{false}; // guarded by _eventQueueMutex, lets the event loop re-evaluate how long it may sleep
+        std::optional<std::chrono::nanoseconds> _timerSlack{};
+        ServiceRegistry _services;
+        std::unordered_map<uint64_t, std::vector<DependencyTrackerInfo>> _dependencyTrackers; // key = interface name hash, value = ordered by tracker id
+        uint64_t _dependencyTrackerIdCounter{1};
         std::unordered_map<CallbackKey, std::function<void(Event const * const)>> _completionCallbacks; // key = listening service id + event type
         std::unordered_map<CallbackKey, std::function<void(Event const * const)>> _errorCallbacks; // key = listening service id + event type
         std::unordered_map<uint64_t, std::vector<EventCallbackInfo>> _eventCallbacks; // key = event id
@@ -497,7 +792,23 @@ namespace Cppelix {
         std::atomic<uint64_t> _eventIdCounter;
         std::atomic<bool> _quit;
         CommunicationChannel *_communicationChannel;
-        uint64_t _id;
+        std::unique_ptr<ThreadPool> _lifecycleThreadPool{nullptr};
+        std::unordered_map<uint64_t, ParallelStartInfo> _parallelStarts{}; // key = service id
+        std::vector<EventStackUniquePtr> _eventsWaitingOnParallelStarts{};
+        std::unordered_set<uint64_t> _servicesHeldByWaitingEvents{};
+        std::unordered_set<uint64_t> _queuedStarts{}; // services with a StartServiceEvent in the queue, see requestStart()
+        bool _quitWaiting{false};
+        ServiceIndex _serviceIndex{};
+        StartupProfiler _startupProfiler{};
+        HandlerProfiler _handlerProfiler{};
+        QueueMetrics _queueMetrics{};
+        std::chrono::milliseconds _stopTimeout{1'000};
+        std::vector<SlowStopper> _slowStoppers{};
+        std::unordered_map<uint64_t, uint64_t> _pendingReplacements{}; // key = id of the replacing service, value = id of the service it replaces
+        std::vector<ServiceFactoryInfo> _serviceFactories{};
+        std::unordered_map<uint64_t, std::vector<size_t>> _serviceFactoriesByInterface{}; // key = interface name hash, value = indices into _serviceFactories
+        uint64_t _idleServiceFactoryCount{0};
+        FlightRecorder _flightRecorder{_id};
         static std::atomic<uint64_t> _managerIdCounter;
 
         friend class EventCompletionHandlerRegistration;
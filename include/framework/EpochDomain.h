@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace Cppelix {
+    /// Epoch based reclamation for data that is read without locks and replaced by copy-on-write.
+    /// Readers pin the current epoch for as long as they look at shared data. A writer publishes the new version, retires the old one and
+    /// frees it only once every thread that was pinned at the time the old version was retired has unpinned again.
+    /// One process wide domain, every thread that pins gets a record that is reused by a later thread once it exits.
+    class EpochDomain final {
+        struct alignas(64) Record final {
+            std::atomic<uint64_t> epoch{QUIESCENT};
+            std::atomic<bool> inUse{true};
+            Record *next{nullptr};
+        };
+
+        /// Record of the calling thread, handed back to the domain when the thread exits
+        struct ThreadState final {
+            ~ThreadState();
+
+            Record *record{nullptr};
+            uint32_t depth{0};
+        };
+
+    public:
+        /// Keeps the calling thread pinned until destroyed. Pinning again while pinned is allowed and only the outermost guard counts.
+        class [[nodiscard]] Guard final {
+        public:
+            explicit Guard(EpochDomain &domain);
+            ~Guard();
+
+            Guard(const Guard&) = delete;
+            Guard(Guard&&) = delete;
+            Guard& operator=(const Guard&) = delete;
+            Guard& operator=(Guard&&) = delete;
+
+        private:
+            ThreadState *_state;
+            bool _outermost;
+        };
+
+        /// The domain is never destroyed, threads exiting during static destruction still release their record into it.
+        [[nodiscard]] static EpochDomain& instance() {
+            static auto *domain = new EpochDomain();
+            return *domain;
+        }
+
+        [[nodiscard]] Guard pin() {
+            return Guard{*this};
+        }
+
+        /// Delete ptr once no thread can still be reading it. ptr must already be unreachable for new readers.
+        template <typename T>
+        void retire(T *ptr) {
+            retire(ptr, [](void *p) { delete static_cast<T*>(p); });
+        }
+
+        void retire(void *ptr, void (*deleter)(void*));
+
+        /// Free whatever retired data is no longer visible to any pinned thread
+        void reclaim();
+
+        /// Block until every thread pinned at the time of the call has unpinned. Must not be called while pinned.
+        void synchronize();
+
+    private:
+        static constexpr uint64_t QUIESCENT = 0;
+
+        struct Retired final {
+            uint64_t epoch;
+            void *ptr;
+            void (*deleter)(void*);
+        };
+
+        EpochDomain() noexcept = default;
+
+        [[nodiscard]] static ThreadState& threadState() noexcept;
+
+        [[nodiscard]] Record* acquireRecord();
+        /// \return lowest epoch a thread is pinned at, or the current epoch when none are
+        [[nodiscard]] uint64_t oldestPinnedEpoch() const noexcept;
+
+        std::atomic<uint64_t> _globalEpoch{1};
+        std::atomic<Record*> _records{nullptr};
+        std::mutex _retiredMutex{};
+        std::vector<Retired> _retired{};
+    };
+}
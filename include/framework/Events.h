@@ -3,6 +3,7 @@
 #include "Dependency.h"
 #include "Callback.h"
 #include <memory>
+#include <exception>
 #include <framework/Callbacks.h>
 
 namespace Cppelix {
@@ -65,10 +66,9 @@ namespace Cppelix {
     };
 
     struct QuitEvent final : public Event {
-        QuitEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, bool _dependenciesStopped = false) noexcept : Event(TYPE, NAME, _id, _originatingService, _priority), dependenciesStopped(_dependenciesStopped) {}
+        QuitEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority) noexcept : Event(TYPE, NAME, _id, _originatingService, _priority) {}
         ~QuitEvent() final = default;
 
-        const bool dependenciesStopped;
         static constexpr uint64_t TYPE = typeNameHash<QuitEvent>();
         static constexpr std::string_view NAME= typeName<QuitEvent>();
     };
@@ -92,6 +92,18 @@ namespace Cppelix {
         static constexpr std::string_view NAME= typeName<StartServiceEvent>();
     };
 
+    struct StartServiceCompletedEvent final : public Event {
+        StartServiceCompletedEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, std::shared_ptr<ILifecycleManager> _manager, bool _started, std::exception_ptr _exception) noexcept :
+                Event(TYPE, NAME, _id, _originatingService, _priority), manager(std::move(_manager)), started(_started), exception(std::move(_exception)) {}
+        ~StartServiceCompletedEvent() final = default;
+
+        const std::shared_ptr<ILifecycleManager> manager;
+        const bool started;
+        const std::exception_ptr exception;
+        static constexpr uint64_t TYPE = typeNameHash<StartServiceCompletedEvent>();
+        static constexpr std::string_view NAME= typeName<StartServiceCompletedEvent>();
+    };
+
     struct RemoveServiceEvent final : public Event {
         RemoveServiceEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, uint64_t _serviceId, bool _dependenciesStopped = false) noexcept : Event(TYPE, NAME, _id, _originatingService, _priority), serviceId(_serviceId), dependenciesStopped(_dependenciesStopped) {}
         ~RemoveServiceEvent() final = default;
@@ -138,19 +150,24 @@ namespace Cppelix {
     };
 
     struct RemoveTrackerEvent final : public Event {
-        RemoveTrackerEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, uint64_t _interfaceNameHash) noexcept : Event(TYPE, NAME, _id, _originatingService, _priority), interfaceNameHash(_interfaceNameHash) {}
+        RemoveTrackerEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, uint64_t _interfaceNameHash, uint64_t _trackerId) noexcept : Event(TYPE, NAME, _id, _originatingService, _priority), interfaceNameHash(_interfaceNameHash), trackerId(_trackerId) {}
         ~RemoveTrackerEvent() final = default;
 
         const uint64_t interfaceNameHash;
+        const uint64_t trackerId;
         static constexpr uint64_t TYPE = typeNameHash<RemoveTrackerEvent>();
         static constexpr std::string_view NAME= typeName<RemoveTrackerEvent>();
     };
 
     struct ContinuableEvent final : public Event {
-        ContinuableEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, Generator<bool> _generator) noexcept : Event(TYPE, NAME, _id, _originatingService, _priority), generator(std::move(_generator)) {}
+        ContinuableEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, Generator<bool> _generator, uint64_t _listeningServiceId = 0, uint64_t _eventType = 0) noexcept :
+            Event(TYPE, NAME, _id, _originatingService, _priority), generator(std::move(_generator)), listeningServiceId(_listeningServiceId), eventType(_eventType) {}
         ~ContinuableEvent() final = default;
 
         Generator<bool> generator;
+        /// Service whose handler yielded, and the type of the event it was handling
+        const uint64_t listeningServiceId;
+        const uint64_t eventType;
         static constexpr uint64_t TYPE = typeNameHash<ContinuableEvent>();
         static constexpr std::string_view NAME= typeName<ContinuableEvent>();
     };
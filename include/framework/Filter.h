@@ -1,9 +1,19 @@
 #pragma once
 
 #include "Common.h"
+#include "LdapFilter.h"
 #include <string>
+#include <optional>
+#include <vector>
 
 namespace Cppelix {
+    /// Conditions a filter guarantees, used by the DependencyManager to narrow down candidate services through its indexes.
+    /// Entries that cannot describe themselves (e.g. user defined ones) simply add nothing, they are still checked through matches().
+    struct FilterIndexTerms final {
+        std::optional<uint64_t> serviceId;
+        std::vector<std::pair<std::string, std::string>> equalities; // property key + property value as given by propertyToFilterString
+    };
+
     template <typename T>
     class PropertiesFilterEntry final {
     public:
@@ -16,11 +26,16 @@ namespace Cppelix {
                 return false;
             }
 
-            if(propVal->second.type() != typeid(T)) {
-                return false;
-            }
+            auto const *propT = propVal->second.template get<T>();
+            return propT != nullptr && *propT == val;
+        }
 
-            return std::any_cast<T>(propVal->second) == val;
+        void addIndexTerms(FilterIndexTerms &terms) const {
+            if constexpr (std::is_same_v<T, std::string> || std::is_same_v<T, bool> || std::is_integral_v<T>) {
+                if(auto str = propertyToFilterString(PropertyValue{val})) {
+                    terms.equalities.emplace_back(key, std::move(*str));
+                }
+            }
         }
 
         const std::string key;
@@ -35,6 +50,10 @@ namespace Cppelix {
             return manager->serviceId() == id;
         }
 
+        void addIndexTerms(FilterIndexTerms &terms) const {
+            terms.serviceId = id;
+        }
+
         const uint64_t id;
     };
 
@@ -42,13 +61,18 @@ namespace Cppelix {
     public:
         virtual ~ITemplatedFilter() = default;
         [[nodiscard]] virtual bool compareTo(const std::shared_ptr<ILifecycleManager> &manager) const = 0;
+        [[nodiscard]] virtual const FilterIndexTerms& indexTerms() const = 0;
     };
 
     // workaround std::any not supporting polymorphism
     template <typename... T>
     class TemplatedFilter final : public ITemplatedFilter {
     public:
-        TemplatedFilter(T&&... _entries) : entries(std::forward<T>(_entries)...) {}
+        TemplatedFilter(T&&... _entries) : entries(std::forward<T>(_entries)...) {
+            std::apply([this](auto const &...x){
+                (addIndexTermsOf(x), ...);
+            }, entries);
+        }
         ~TemplatedFilter() final = default;
 
         TemplatedFilter(const TemplatedFilter&) = default;
@@ -64,7 +88,21 @@ namespace Cppelix {
             return matches;
         }
 
+        [[nodiscard]] const FilterIndexTerms& indexTerms() const final {
+            return _indexTerms;
+        }
+
         const std::tuple<T...> entries;
+
+    private:
+        template <typename EntryT>
+        void addIndexTermsOf(const EntryT &entry) {
+            if constexpr (requires { entry.addIndexTerms(_indexTerms); }) {
+                entry.addIndexTerms(_indexTerms);
+            }
+        }
+
+        FilterIndexTerms _indexTerms{};
     };
 
     class Filter final {
@@ -81,6 +119,10 @@ namespace Cppelix {
             return _templatedFilter->compareTo(manager);
         }
 
+        [[nodiscard]] const FilterIndexTerms& indexTerms() const {
+            return _templatedFilter->indexTerms();
+        }
+
         const std::shared_ptr<ITemplatedFilter> _templatedFilter;
     };
 }
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace Cppelix {
+    /// One handled event as stored in a dump. Times are steady_clock nanoseconds.
+    struct FlightRecord final {
+        static constexpr uint64_t IN_PROGRESS = std::numeric_limits<uint64_t>::max();
+
+        uint64_t type{0};
+        uint64_t id{0};
+        uint64_t originatingService{0};
+        uint64_t priority{0};
+        uint64_t enqueuedAt{0}; // 0 if the event was pushed while the recorder was disabled
+        uint64_t dispatchedAt{0};
+        uint64_t handlerDuration{0}; // IN_PROGRESS while the event loop is still handling it
+    };
+
+    /// A dump starts with this header, followed by recordCount FlightRecords, oldest first, and nameCount FlightRecordNames, each followed
+    /// by length characters of the event type's name. All in the byte order of the machine that wrote it.
+    struct FlightRecorderFileHeader final {
+        static constexpr std::array<char, 8> MAGIC{'C', 'P', 'X', 'F', 'L', 'I', 'G', 'H'};
+        static constexpr uint32_t VERSION = 1;
+
+        std::array<char, 8> magic{MAGIC};
+        uint32_t version{VERSION};
+        uint32_t recordSize{sizeof(FlightRecord)};
+        uint64_t managerId{0};
+        uint64_t capacity{0};
+        uint64_t recordCount{0};
+        uint64_t nameCount{0};
+        uint64_t dumpedAt{0}; // steady_clock ns, to tell how long an IN_PROGRESS event has been running
+    };
+
+    struct FlightRecordName final {
+        uint64_t type{0};
+        uint64_t length{0};
+    };
+
+    /// The last CAPACITY events a DependencyManager handled, meant to stay enabled in production to see what a stalled or crashed event
+    /// loop was doing. Only the event loop thread writes: each slot is guarded by a sequence number, so dumping never blocks it and skips
+    /// slots that are being overwritten. An event is recorded when its handling starts and updated when it ends, so the event a stuck loop
+    /// is in shows up as IN_PROGRESS.
+    /// Dumps are written with nothing but open(), write() and close(), from a signal handler as well, and read by the flight_recorder_decoder
+    /// tool. Recording costs two steady_clock reads per event plus one per push for the enqueue time.
+    class FlightRecorder final {
+    public:
+        static constexpr uint64_t CAPACITY = 4'096;
+        static constexpr size_t MAX_RECORDERS = 64; // recorders beyond this many are left out of dumpAll()
+
+        explicit FlightRecorder(uint64_t managerId);
+        /// Waits for dumpAll() calls of other threads that are running, they might be writing this recorder
+        ~FlightRecorder();
+
+        FlightRecorder(const FlightRecorder&) = delete;
+        FlightRecorder(FlightRecorder&&) = delete;
+        FlightRecorder& operator=(const FlightRecorder&) = delete;
+        FlightRecorder& operator=(FlightRecorder&&) = delete;
+
+        /// Enabled by default
+        void setEnabled(bool enabled) noexcept {
+            _enabled.store(enabled, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] bool enabled() const noexcept {
+            return _enabled.load(std::memory_order_relaxed);
+        }
+
+        /// Event loop thread only. Records an event as IN_PROGRESS
+        void begin(uint64_t type, std::string_view name, uint64_t id, uint64_t originatingService, uint64_t priority, uint64_t enqueuedAt) noexcept;
+
+        /// Event loop thread only. Sets the handler duration of the event recorded by the last begin()
+        void end() noexcept;
+
+        /// \return records still in the ring, oldest first, leaving out the ones being written right now
+        [[nodiscard]] std::vector<FlightRecord> snapshot() const;
+
+        /// Async signal safe, can be called from any thread
+        /// \return false if the file could not be written
+        bool dump(const char *path) const noexcept;
+
+        /// Dump every recorder in the process to directory/flight_<pid>_<manager id>.bin. Async signal safe.
+        /// \return amount of files written
+        static size_t dumpAll(const char *directory) noexcept;
+
+        /// Call dumpAll() on SIGUSR1 and on SIGSEGV, SIGBUS, SIGFPE, SIGILL and SIGABRT. Once the dumps are written, crash signals are raised
+        /// again with the disposition they had before this call put back, and a handler that was installed for SIGUSR1 is called.
+        /// \param directory copied, at most 255 characters
+        static void installSignalHandlers(std::string_view directory);
+
+        [[nodiscard]] static uint64_t now() noexcept {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+    private:
+        // FlightRecord split into atomics, so dumping while the event loop writes is well defined
+        struct Slot final {
+            std::atomic<uint64_t> sequence{0}; // odd while being written
+            std::atomic<uint64_t> type{0};
+            std::atomic<uint64_t> id{0};
+            std::atomic<uint64_t> originatingService{0};
+            std::atomic<uint64_t> priority{0};
+            std::atomic<uint64_t> enqueuedAt{0};
+            std::atomic<uint64_t> dispatchedAt{0};
+            std::atomic<uint64_t> handlerDuration{0};
+            std::atomic<const char*> name{nullptr}; // event names are string literals, they stay valid
+            std::atomic<uint64_t> nameLength{0};
+        };
+
+        /// \return false if the slot is being written, record and name are unusable then
+        bool read(uint64_t index, FlightRecord &record, std::string_view &name) const noexcept;
+
+        std::unique_ptr<Slot[]> _slots;
+        std::atomic<uint64_t> _written{0};
+        std::atomic<bool> _enabled{true};
+        bool _open{false}; // begin() was called without end()
+        uint64_t _managerId;
+    };
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "Callback.h"
+#include "Histogram.h"
+
+namespace Cppelix {
+    struct HandlerLatencyRecord final {
+        uint64_t serviceId{0};
+        std::string_view implementationName{};
+        uint64_t eventType{0};
+        std::string_view eventName{};
+        uint64_t invocations{0};
+        uint64_t slices{0}; // resumptions after a co_yield, each one ran as a ContinuableEvent
+        std::chrono::nanoseconds totalTime{}; // invocations and slices together
+        // of single invocations and slices, the stretches the handler held up the event loop
+        std::chrono::nanoseconds p50{};
+        std::chrono::nanoseconds p99{};
+        std::chrono::nanoseconds max{};
+    };
+
+    /// Times every call the event loop makes into an event handler, and every slice of a handler it resumes after a co_yield, and adds them
+    /// up per listening service and event type. Unlike an interceptor, which sees the whole dispatch of an event to all of its listeners,
+    /// this tells which of them took the time.
+    /// Disabled by default, enabled it costs two steady_clock reads and an uncontended lock per handler call. Memory grows with the amount
+    /// of service and event type pairs that handled an event, about 9 KiB each, and is given back when the service is removed.
+    class HandlerProfiler final {
+    public:
+        void setEnabled(bool enabled) noexcept {
+            _enabled.store(enabled, std::memory_order_release);
+        }
+
+        [[nodiscard]] bool enabled() const noexcept {
+            return _enabled.load(std::memory_order_acquire);
+        }
+
+        void invocation(uint64_t serviceId, std::string_view implementationName, uint64_t eventType, std::string_view eventName, std::chrono::nanoseconds duration);
+
+        /// Slices of a handler whose first invocation came before profiling was enabled are not counted
+        void slice(uint64_t serviceId, uint64_t eventType, std::chrono::nanoseconds duration);
+
+        /// \return one record per service and event type, most total time first
+        [[nodiscard]] std::vector<HandlerLatencyRecord> getRecords() const;
+
+        /// Drop the records of a removed service
+        void serviceRemoved(uint64_t serviceId);
+
+        void reset();
+
+    private:
+        struct Entry final {
+            Entry(uint64_t _serviceId, std::string_view _implementationName, uint64_t _eventType, std::string_view _eventName) noexcept :
+                serviceId(_serviceId), implementationName(_implementationName), eventType(_eventType), eventName(_eventName) {}
+
+            uint64_t serviceId;
+            std::string_view implementationName;
+            uint64_t eventType;
+            std::string_view eventName;
+            uint64_t invocations{0};
+            uint64_t slices{0};
+            uint64_t totalNanoseconds{0};
+            Histogram nanoseconds{};
+        };
+
+        // shared, so getRecords() can compute quantiles of an entry without holding _mutex, while serviceRemoved() drops it
+        std::unordered_map<CallbackKey, std::shared_ptr<Entry>> _entries{}; // key = listening service id + event type
+        mutable std::mutex _mutex{};
+        std::atomic<bool> _enabled{false};
+    };
+}
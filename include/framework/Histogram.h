@@ -0,0 +1,82 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace Cppelix {
+    /// Point in time read of a Histogram, for reporting
+    struct HistogramSummary final {
+        uint64_t count{0};
+        uint64_t sum{0};
+        uint64_t p50{0};
+        uint64_t p90{0};
+        uint64_t p99{0};
+        uint64_t p999{0};
+        uint64_t max{0};
+    };
+
+    /// Log-linear histogram of non-negative values, laid out like HdrHistogram: values below 2^SUB_BUCKET_BITS get a bucket each, above that
+    /// every power of two is split into 2^SUB_BUCKET_BITS equally wide buckets. Quantiles are therefore off by less than 1 / 2^SUB_BUCKET_BITS
+    /// (about 3%) of the value, at a fixed size of 9 KiB however many values are recorded. Values of 2^MAX_EXPONENT and up share the last bucket.
+    /// Recording is a relaxed atomic increment, so one thread can record while others read.
+    class Histogram final {
+    public:
+        static constexpr uint32_t SUB_BUCKET_BITS = 5;
+        static constexpr uint32_t SUB_BUCKETS = 1U << SUB_BUCKET_BITS;
+        static constexpr uint32_t MAX_EXPONENT = 40; // 2^40 ns is over 18 minutes
+        static constexpr uint32_t BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS) * SUB_BUCKETS;
+
+        Histogram() : _buckets(std::make_unique<std::atomic<uint64_t>[]>(BUCKETS)) {}
+
+        Histogram(const Histogram&) = delete;
+        Histogram(Histogram&&) = delete;
+        Histogram& operator=(const Histogram&) = delete;
+        Histogram& operator=(Histogram&&) = delete;
+
+        void record(uint64_t value) noexcept {
+            _buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+            _count.fetch_add(1, std::memory_order_relaxed);
+            _sum.fetch_add(value, std::memory_order_relaxed);
+
+            auto max = _max.load(std::memory_order_relaxed);
+            while(value > max && !_max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {
+            }
+        }
+
+        [[nodiscard]] uint64_t count() const noexcept {
+            return _count.load(std::memory_order_relaxed);
+        }
+
+        /// Exact, as long as it doesn't overflow
+        [[nodiscard]] uint64_t sum() const noexcept {
+            return _sum.load(std::memory_order_relaxed);
+        }
+
+        /// Exact, unlike the quantiles
+        [[nodiscard]] uint64_t max() const noexcept {
+            return _max.load(std::memory_order_relaxed);
+        }
+
+        /// \param quantile between 0 and 1, e.g. 0.999 for the 99.9th percentile
+        /// \return highest value that falls in the same bucket as the value at quantile, 0 when empty
+        [[nodiscard]] uint64_t valueAtQuantile(double quantile) const noexcept;
+
+        [[nodiscard]] HistogramSummary summarize() const noexcept {
+            return HistogramSummary{count(), sum(), valueAtQuantile(0.5), valueAtQuantile(0.9), valueAtQuantile(0.99), valueAtQuantile(0.999), max()};
+        }
+
+        /// Not atomic as a whole: values recorded meanwhile might partly survive
+        void reset() noexcept;
+
+    private:
+        [[nodiscard]] static uint32_t bucketOf(uint64_t value) noexcept;
+        /// \return highest value counted in bucket
+        [[nodiscard]] static uint64_t highestValueOf(uint32_t bucket) noexcept;
+
+        std::unique_ptr<std::atomic<uint64_t>[]> _buckets;
+        std::atomic<uint64_t> _count{0};
+        std::atomic<uint64_t> _sum{0};
+        std::atomic<uint64_t> _max{0};
+    };
+}
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Common.h"
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <optional>
+#include <memory>
+
+namespace Cppelix {
+    class ILifecycleManager;
+
+    enum class LdapOperation : uint8_t {
+        EQUALS,
+        APPROX,
+        GREATER_OR_EQUAL,
+        LESS_OR_EQUAL,
+        PRESENT,
+        SUBSTRING,
+        AND,
+        OR,
+        NOT
+    };
+
+    struct LdapInstruction final {
+        LdapOperation op;
+        // AND/OR: amount of operands on the stack (always 2), otherwise index into the key and value tables
+        uint32_t operand;
+        uint32_t value;
+    };
+
+    struct LdapValue final {
+        std::string str;
+        std::optional<int64_t> integer;
+        std::optional<double> floating;
+        // only for SUBSTRING, the parts between the wildcards
+        std::vector<std::string> segments;
+    };
+
+    /// LDAP style filter (RFC 4515 subset), e.g. "(&(scope=global)(|(port>=8000)(!(debug=*))))".
+    /// Supports &, |, !, =, ~= (case insensitive), >=, <=, presence (key=*) and substrings with * wildcards. Backslash hex escapes are accepted in values.
+    /// The string is compiled once into a postfix program, matching a service does not allocate. Filters can be nested MAX_STACK_DEPTH levels deep,
+    /// lists within them can be of any length.
+    /// Throws std::runtime_error on malformed filters.
+    class LdapFilter final {
+    public:
+        static constexpr uint32_t MAX_STACK_DEPTH = 64;
+
+        explicit LdapFilter(std::string_view filter);
+
+        [[nodiscard]] bool matches(const CppelixProperties &properties) const;
+
+        /// Equality terms that have to hold for the filter to match, i.e. the ones directly under the top level AND.
+        /// Used to look up candidate services in the property indexes before running the program.
+        [[nodiscard]] const std::vector<std::pair<std::string, std::string>>& requiredEqualities() const noexcept {
+            return _requiredEqualities;
+        }
+
+        [[nodiscard]] std::string_view str() const noexcept {
+            return _filter;
+        }
+
+        [[nodiscard]] const std::vector<LdapInstruction>& program() const noexcept {
+            return _program;
+        }
+
+    private:
+        void parseFilter(std::string_view &remaining, uint32_t depth, bool topLevelAnd);
+        void parseItem(std::string_view item, bool topLevelAnd);
+
+        std::string _filter;
+        std::vector<LdapInstruction> _program{};
+        std::vector<std::string> _keys{};
+        std::vector<uint64_t> _keyHashes{}; // PropertyKey hash of every entry in _keys
+        std::vector<LdapValue> _values{};
+        std::vector<std::pair<std::string, std::string>> _requiredEqualities{};
+    };
+
+    /// Converts a property to the string representation used in LDAP filters and the property indexes. Floats with an integral value are
+    /// converted like the integer they equal.
+    /// \return empty if the type of the property isn't supported, or for floats with a fraction
+    [[nodiscard]] std::optional<std::string> propertyToFilterString(const PropertyValue &property);
+
+    /// Filter entry usable in Filter, e.g. Filter{LdapFilterEntry{"(scope=global)"}}
+    class LdapFilterEntry final {
+    public:
+        explicit LdapFilterEntry(std::string_view filter) : _filter(std::make_shared<const LdapFilter>(filter)) {}
+
+        [[nodiscard]] bool matches(const std::shared_ptr<ILifecycleManager> &manager) const;
+
+        template <typename TermsT>
+        void addIndexTerms(TermsT &terms) const {
+            for(auto const &equality : _filter->requiredEqualities()) {
+                terms.equalities.push_back(equality);
+            }
+        }
+
+        [[nodiscard]] const LdapFilter& filter() const noexcept {
+            return *_filter;
+        }
+
+    private:
+        std::shared_ptr<const LdapFilter> _filter;
+    };
+}
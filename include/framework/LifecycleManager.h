@@ -1,15 +1,21 @@
 #pragma once
 
+#include <algorithm>
 #include <string_view>
 #include <memory>
 #include <atomic>
 #include <unordered_set>
 #include <ranges>
+#include <limits>
+#include <optional>
+#include <vector>
 #include "Service.h"
 #include "interfaces/IFrameworkLogger.h"
 #include "Common.h"
 #include "Events.h"
 #include "Dependency.h"
+#include "ObjectPool.h"
+#include "ProviderSet.h"
 
 namespace Cppelix {
     enum class ServiceManagerState {
@@ -91,23 +97,132 @@ namespace Cppelix {
         CPPELIX_CONSTEXPR std::vector<Dependency> _dependencies;
     };
 
+    /// One dependency requested by a service. inject/remove are instantiated for the service type and interface in
+    /// DependencyRegister::registerDependency, calling them is a plain function pointer call.
+    /// For registerProviderSet, service points to the ProviderSet and providerCount is set.
+    struct DependencyRegistration final {
+        Dependency dependency;
+        void (*inject)(void *service, void *dependency);
+        void (*remove)(void *service, void *dependency);
+        size_t (*providerCount)(void const *service);
+        void *service;
+        std::optional<CppelixProperties> properties;
+        std::vector<uint64_t> injectedProviders{}; // service ids, the one provider of a plain dependency or every member of a set
+    };
+
+    /// Dependencies of a service in the order they were registered. The position of a registration is its slot, the lifecycle manager resolves the
+    /// slot of a provided interface once and injects through it. Services request only a handful of interfaces, a linear scan finds a slot faster
+    /// than hashing.
     class DependencyRegister final {
     public:
+        static constexpr size_t NO_SLOT = std::numeric_limits<size_t>::max();
+
         template<Derived<IService> Interface, Derived<Service> Impl>
         void registerDependency(Impl *svc, bool required, std::optional<CppelixProperties> props = {}) {
-            InterfaceKey key{typeNameHash<Interface>(), Interface::version};
-            if(_registrations.contains(key)) {
+            if(slotOf(InterfaceKey{typeNameHash<Interface>(), Interface::version}) != NO_SLOT) {
+                throw std::runtime_error("Already registered interface");
+            }
+
+            _registrations.emplace_back(DependencyRegistration{
+                    Dependency{typeNameHash<Interface>(), Interface::version, required},
+                    &injectThunk<Impl, Interface>,
+                    &removeThunk<Impl, Interface>,
+                    nullptr,
+                    svc,
+                    std::move(props)});
+        }
+
+        /// Inject every provider of Interface into providers instead of only the first one, also after the service started.
+        /// The dependency counts as satisfied while the set is not empty. The set has to live as long as the service, normally it is a member of it.
+        template<Derived<IService> Interface>
+        void registerProviderSet(ProviderSet<Interface> &providers, bool required, std::optional<CppelixProperties> props = {}) {
+            if(slotOf(InterfaceKey{typeNameHash<Interface>(), Interface::version}) != NO_SLOT) {
                 throw std::runtime_error("Already registered interface");
             }
 
-            _registrations.emplace(key, std::make_tuple(
+            _registrations.emplace_back(DependencyRegistration{
                     Dependency{typeNameHash<Interface>(), Interface::version, required},
-                    [svc](void* dep){ svc->addDependencyInstance(static_cast<Interface*>(dep)); },
-                    [svc](void* dep){ svc->removeDependencyInstance(static_cast<Interface*>(dep)); },
-                    std::move(props)));
+                    &addToSetThunk<Interface>,
+                    &removeFromSetThunk<Interface>,
+                    &setSizeThunk<Interface>,
+                    &providers,
+                    std::move(props)});
+        }
+
+        /// \return slot of the registration for key, NO_SLOT if the interface was not requested
+        [[nodiscard]] size_t slotOf(InterfaceKey key) const noexcept {
+            for(size_t slot = 0; slot < _registrations.size(); slot++) {
+                auto const &dependency = _registrations[slot].dependency;
+                if(dependency.interfaceNameHash == key.typenameHash && dependency.interfaceVersion == key.version) {
+                    return slot;
+                }
+            }
+            return NO_SLOT;
+        }
+
+        /// Injecting a provider that is already injected through slot does nothing
+        void inject(size_t slot, IService *dependency) {
+            auto &registration = _registrations[slot];
+            if(isInjected(slot, dependency->getServiceId())) {
+                return;
+            }
+            registration.inject(registration.service, dependency);
+            registration.injectedProviders.push_back(dependency->getServiceId());
+        }
+
+        /// Removing a provider that was not injected through slot does nothing
+        void remove(size_t slot, IService *dependency) {
+            auto &registration = _registrations[slot];
+            if(!isInjected(slot, dependency->getServiceId())) {
+                return;
+            }
+            std::erase(registration.injectedProviders, dependency->getServiceId());
+            registration.remove(registration.service, dependency);
         }
 
-        std::unordered_map<InterfaceKey, std::tuple<Dependency, std::function<void(IService*)>, std::function<void(IService*)>, std::optional<CppelixProperties>>> _registrations;
+        /// \return whether the provider with providerId is injected through slot
+        [[nodiscard]] bool isInjected(size_t slot, uint64_t providerId) const noexcept {
+            auto const &providers = _registrations[slot].injectedProviders;
+            return std::find(providers.begin(), providers.end(), providerId) != providers.end();
+        }
+
+        [[nodiscard]] bool isProviderSet(size_t slot) const noexcept {
+            return _registrations[slot].providerCount != nullptr;
+        }
+
+        /// \return amount of providers injected into the ProviderSet of slot
+        [[nodiscard]] size_t providerCount(size_t slot) const noexcept {
+            auto const &registration = _registrations[slot];
+            return registration.providerCount(registration.service);
+        }
+
+        std::vector<DependencyRegistration> _registrations;
+
+    private:
+        template<class Impl, class Interface>
+        static void injectThunk(void *svc, void *dep) {
+            static_cast<Impl*>(svc)->addDependencyInstance(static_cast<Interface*>(dep));
+        }
+
+        template<class Impl, class Interface>
+        static void removeThunk(void *svc, void *dep) {
+            static_cast<Impl*>(svc)->removeDependencyInstance(static_cast<Interface*>(dep));
+        }
+
+        template<class Interface>
+        static void addToSetThunk(void *set, void *dep) {
+            static_cast<ProviderSet<Interface>*>(set)->add(static_cast<Interface*>(dep), static_cast<IService*>(dep));
+        }
+
+        template<class Interface>
+        static void removeFromSetThunk(void *set, void *dep) {
+            static_cast<ProviderSet<Interface>*>(set)->remove(static_cast<IService*>(dep)->getServiceId());
+        }
+
+        template<class Interface>
+        static size_t setSizeThunk(void const *set) {
+            return static_cast<ProviderSet<Interface> const*>(set)->size();
+        }
     };
 
     class ILifecycleManager {
@@ -121,8 +236,26 @@ namespace Cppelix {
         /// \param dependentService
         /// \return true if stopped, false if not
         CPPELIX_CONSTEXPR virtual bool dependencyOffline(const std::shared_ptr<ILifecycleManager> &dependentService) = 0;
+        /// For every interface oldProvider is injected through, remove oldProvider and inject newProvider right after. The service is not stopped.
+        /// \param newProvider has to provide all interfaces of oldProvider
+        CPPELIX_CONSTEXPR virtual void replaceDependency(const std::shared_ptr<ILifecycleManager> &oldProvider, const std::shared_ptr<ILifecycleManager> &newProvider) = 0;
         [[nodiscard]] CPPELIX_CONSTEXPR virtual bool start() = 0;
         [[nodiscard]] CPPELIX_CONSTEXPR virtual bool stop() = 0;
+        /// Split version of start(), used to run the start() of the service on a thread pool.
+        /// prepareStart() and finishStart() have to be called on the event loop thread, runStart() can be called from any thread.
+        /// \return true if the service is now STARTING
+        [[nodiscard]] CPPELIX_CONSTEXPR virtual bool prepareStart() = 0;
+        [[nodiscard]] CPPELIX_CONSTEXPR virtual bool runStart() = 0;
+        CPPELIX_CONSTEXPR virtual bool finishStart(bool started) = 0;
+        /// \return true if the service declared that its start() can run off the event loop thread
+        [[nodiscard]] CPPELIX_CONSTEXPR virtual bool parallelStartSafe() const = 0;
+        /// Split version of stop(), same threading rules as prepareStart(), runStart() and finishStart().
+        /// \return true if the service is now STOPPING
+        [[nodiscard]] CPPELIX_CONSTEXPR virtual bool prepareStop() = 0;
+        [[nodiscard]] CPPELIX_CONSTEXPR virtual bool runStop() = 0;
+        CPPELIX_CONSTEXPR virtual bool finishStop(bool stopped) = 0;
+        /// \return true if the service declared that its stop() can run off the event loop thread
+        [[nodiscard]] CPPELIX_CONSTEXPR virtual bool parallelStopSafe() const = 0;
         [[nodiscard]] CPPELIX_CONSTEXPR virtual std::string_view implementationName() const = 0;
         [[nodiscard]] CPPELIX_CONSTEXPR virtual uint64_t type() const = 0;
         [[nodiscard]] CPPELIX_CONSTEXPR virtual uint64_t serviceId() const = 0;
@@ -141,8 +274,8 @@ namespace Cppelix {
     class DependencyLifecycleManager final : public ILifecycleManager {
     public:
         explicit CPPELIX_CONSTEXPR DependencyLifecycleManager(IFrameworkLogger *logger, std::string_view name, std::vector<Dependency> interfaces, CppelixProperties properties) : _implementationName(name), _interfaces(std::move(interfaces)), _registry(), _dependencies(), _satisfiedDependencies(), _service(_registry, std::move(properties)), _logger(logger) {
-            for(const auto &reg : _registry._registrations) {
-                _dependencies.addDependency(std::get<0>(reg.second));
+            for(const auto &registration : _registry._registrations) {
+                _dependencies.addDependency(registration.dependency);
             }
         }
 
@@ -164,26 +297,50 @@ namespace Cppelix {
             std::vector<Dependency> interfaces;
             interfaces.reserve(sizeof...(Interfaces));
             (interfaces.emplace_back(typeNameHash<Interfaces>(), Interfaces::version, false),...);
-            auto mgr = std::make_shared<DependencyLifecycleManager<ServiceType>>(logger, name, std::move(interfaces), std::move(properties));
+            auto mgr = std::allocate_shared<DependencyLifecycleManager<ServiceType>>(PoolAllocator<DependencyLifecycleManager<ServiceType>>{}, logger, name, std::move(interfaces), std::move(properties));
             return mgr;
         }
 
         CPPELIX_CONSTEXPR bool dependencyOnline(const std::shared_ptr<ILifecycleManager> &dependentService) final {
-            if(_service.getState() == ServiceState::ACTIVE) {
-                return false;
-            }
+            const bool running = _service.getState() == ServiceState::ACTIVE || _service.getState() == ServiceState::STARTING;
 
             const auto &interfaces = dependentService->getInterfaces();
             for(const auto &interface : interfaces) {
-                if (!_dependencies.contains(interface) || _satisfiedDependencies.contains(interface)) {
+                auto slot = _registry.slotOf(InterfaceKey{interface.interfaceNameHash, interface.interfaceVersion});
+                if (slot == DependencyRegister::NO_SLOT) {
                     continue;
                 }
 
-                injectIntoSelf(InterfaceKey{interface.interfaceNameHash, interface.interfaceVersion}, dependentService);
+                const bool satisfied = _satisfiedDependencies.contains(interface);
+                if (_registry.isProviderSet(slot)) {
+                    // sets take every provider, also while running. A provider that is already in the set is ignored.
+                    injectIntoSelf(slot, dependentService);
+                } else if (running || satisfied) {
+                    continue;
+                } else {
+                    injectIntoSelf(slot, dependentService);
+                }
+
+                if (satisfied) {
+                    continue;
+                }
                 _satisfiedDependencies.addDependency(interface);
+                if (running) {
+                    continue;
+                }
 
                 bool canStart = _dependencies.requiredDependenciesSatisfied(_satisfiedDependencies);
                 if (canStart) {
+                    _service._manager->getStartupProfiler().dependenciesSatisfied(_service.getServiceId(), dependentService->serviceId());
+
+                    if constexpr (ParallelStartSafe<ServiceType>) {
+                        if(_service._manager->lifecycleThreadPoolEnabled()) {
+                            // the DependencyManager starts us on its thread pool and publishes the DependencyOnlineEvent afterwards
+                            _service._manager->requestStart(_service.getServiceId());
+                            return false;
+                        }
+                    }
+
                     if (!_service.internal_start()) {
                         LOG_ERROR(_logger, "Couldn't start service {}", _implementationName);
                         return false;
@@ -197,12 +354,9 @@ namespace Cppelix {
             return false;
         }
 
-        CPPELIX_CONSTEXPR void injectIntoSelf(InterfaceKey keyOfInterfaceToInject, const std::shared_ptr<ILifecycleManager> &dependentService) {
-            auto dep = _registry._registrations.find(keyOfInterfaceToInject);
-
-            if(dep != end(_registry._registrations)) {
-                std::get<1>(dep->second)(dependentService->getServiceAsInterfacePointer());
-            }
+        /// \param slot result of _registry.slotOf() for the interface provided by dependentService
+        CPPELIX_CONSTEXPR void injectIntoSelf(size_t slot, const std::shared_ptr<ILifecycleManager> &dependentService) {
+            _registry.inject(slot, dependentService->getServiceAsInterfacePointer());
         }
 
         CPPELIX_CONSTEXPR bool dependencyOffline(const std::shared_ptr<ILifecycleManager> &dependentService) final {
@@ -214,7 +368,14 @@ namespace Cppelix {
             bool stopped = false;
 
             for(const auto &dependency : dependencies) {
-                if (!_dependencies.contains(dependency) || !_satisfiedDependencies.contains(dependency)) {
+                auto slot = _registry.slotOf(InterfaceKey{dependency.interfaceNameHash, dependency.interfaceVersion});
+                // the interface may be satisfied by another provider, one this service never got
+                if (slot == DependencyRegister::NO_SLOT || !_registry.isInjected(slot, dependentService->serviceId())) {
+                    continue;
+                }
+
+                if (_registry.isProviderSet(slot) && _registry.providerCount(slot) > 1) {
+                    removeSelfInto(slot, dependentService);
                     continue;
                 }
 
@@ -232,20 +393,30 @@ namespace Cppelix {
                     }
                 }
 
-                removeSelfInto(InterfaceKey{dependency.interfaceNameHash, dependency.interfaceVersion}, dependentService);
+                removeSelfInto(slot, dependentService);
             }
 
             return stopped;
         }
 
-        CPPELIX_CONSTEXPR void removeSelfInto(InterfaceKey keyOfInterfaceToInject, const std::shared_ptr<ILifecycleManager> &dependentService) {
-            auto dep = _registry._registrations.find(keyOfInterfaceToInject);
+        CPPELIX_CONSTEXPR void replaceDependency(const std::shared_ptr<ILifecycleManager> &oldProvider, const std::shared_ptr<ILifecycleManager> &newProvider) final {
+            for(const auto &interface : oldProvider->getInterfaces()) {
+                auto slot = _registry.slotOf(InterfaceKey{interface.interfaceNameHash, interface.interfaceVersion});
+                if (slot == DependencyRegister::NO_SLOT || !_registry.isInjected(slot, oldProvider->serviceId())) {
+                    continue;
+                }
 
-            if(dep != end(_registry._registrations)) {
-                std::get<2>(dep->second)(dependentService->getServiceAsInterfacePointer());
+                // remove first, services commonly reset their pointer in removeDependencyInstance
+                removeSelfInto(slot, oldProvider);
+                injectIntoSelf(slot, newProvider);
             }
         }
 
+        /// \param slot result of _registry.slotOf() for the interface provided by dependentService
+        CPPELIX_CONSTEXPR void removeSelfInto(size_t slot, const std::shared_ptr<ILifecycleManager> &dependentService) {
+            _registry.remove(slot, dependentService->getServiceAsInterfacePointer());
+        }
+
         [[nodiscard]]
         CPPELIX_CONSTEXPR bool start() final {
             bool canStart = _service.getState() != ServiceState::ACTIVE && _dependencies.requiredDependenciesSatisfied(_satisfiedDependencies);
@@ -261,6 +432,54 @@ namespace Cppelix {
             return false;
         }
 
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool prepareStart() final {
+            return _service.getState() != ServiceState::ACTIVE && _dependencies.requiredDependenciesSatisfied(_satisfiedDependencies) && _service.internal_prepare_start();
+        }
+
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool runStart() final {
+            return _service.internal_run_start();
+        }
+
+        CPPELIX_CONSTEXPR bool finishStart(bool started) final {
+            if(_service.internal_finish_start(started)) {
+                LOG_DEBUG(_logger, "Started {}", _implementationName);
+                return true;
+            }
+
+            LOG_DEBUG(_logger, "Couldn't start {}", _implementationName);
+            return false;
+        }
+
+        [[nodiscard]] CPPELIX_CONSTEXPR bool parallelStartSafe() const final {
+            return ParallelStartSafe<ServiceType>;
+        }
+
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool prepareStop() final {
+            return _service.internal_prepare_stop();
+        }
+
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool runStop() final {
+            return _service.internal_run_stop();
+        }
+
+        CPPELIX_CONSTEXPR bool finishStop(bool stopped) final {
+            if(_service.internal_finish_stop(stopped)) {
+                LOG_DEBUG(_logger, "Stopped {}", _implementationName);
+                return true;
+            }
+
+            LOG_DEBUG(_logger, "Couldn't stop {}", _implementationName);
+            return false;
+        }
+
+        [[nodiscard]] CPPELIX_CONSTEXPR bool parallelStopSafe() const final {
+            return ParallelStopSafe<ServiceType>;
+        }
+
         [[nodiscard]]
         CPPELIX_CONSTEXPR bool stop() final {
             if(_service.getState() == ServiceState::ACTIVE) {
@@ -345,7 +564,7 @@ namespace Cppelix {
             std::vector<Dependency> interfaces;
             interfaces.reserve(sizeof...(Interfaces));
             (interfaces.emplace_back(typeNameHash<Interfaces>(), Interfaces::version, false),...);
-            auto mgr = std::make_shared<LifecycleManager<ServiceType>>(logger, name, std::move(interfaces), std::move(properties));
+            auto mgr = std::allocate_shared<LifecycleManager<ServiceType>>(PoolAllocator<LifecycleManager<ServiceType>>{}, logger, name, std::move(interfaces), std::move(properties));
             return mgr;
         }
 
@@ -357,6 +576,9 @@ namespace Cppelix {
             return false;
         }
 
+        CPPELIX_CONSTEXPR void replaceDependency(const std::shared_ptr<ILifecycleManager> &oldProvider, const std::shared_ptr<ILifecycleManager> &newProvider) final {
+        }
+
         [[nodiscard]]
         CPPELIX_CONSTEXPR bool start() final {
             bool canStart = _service.getState() != ServiceState::ACTIVE;
@@ -372,6 +594,54 @@ namespace Cppelix {
             return false;
         }
 
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool prepareStart() final {
+            return _service.internal_prepare_start();
+        }
+
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool runStart() final {
+            return _service.internal_run_start();
+        }
+
+        CPPELIX_CONSTEXPR bool finishStart(bool started) final {
+            if(_service.internal_finish_start(started)) {
+                LOG_DEBUG(_logger, "Started {}", _implementationName);
+                return true;
+            }
+
+            LOG_DEBUG(_logger, "Couldn't start {}", _implementationName);
+            return false;
+        }
+
+        [[nodiscard]] CPPELIX_CONSTEXPR bool parallelStartSafe() const final {
+            return ParallelStartSafe<ServiceType>;
+        }
+
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool prepareStop() final {
+            return _service.internal_prepare_stop();
+        }
+
+        [[nodiscard]]
+        CPPELIX_CONSTEXPR bool runStop() final {
+            return _service.internal_run_stop();
+        }
+
+        CPPELIX_CONSTEXPR bool finishStop(bool stopped) final {
+            if(_service.internal_finish_stop(stopped)) {
+                LOG_DEBUG(_logger, "Stopped {}", _implementationName);
+                return true;
+            }
+
+            LOG_DEBUG(_logger, "Couldn't stop {}", _implementationName);
+            return false;
+        }
+
+        [[nodiscard]] CPPELIX_CONSTEXPR bool parallelStopSafe() const final {
+            return ParallelStopSafe<ServiceType>;
+        }
+
         [[nodiscard]]
         CPPELIX_CONSTEXPR bool stop() final {
             if(_service.getState() == ServiceState::ACTIVE) {
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <new>
+
+namespace Cppelix {
+    /// Process wide free list of blocks big enough for one T.
+    /// Blocks that are given back are kept for the next allocation instead of going back to the heap, up to MAX_FREE_BLOCKS of them.
+    /// Thread-safe: managers can be created on one DependencyManager thread and destroyed on another.
+    template <typename T>
+    class ObjectPool final {
+    public:
+        static constexpr size_t MAX_FREE_BLOCKS = 4096;
+
+        /// The pool is intentionally never destroyed, shared_ptrs to pooled objects may outlive static destruction.
+        [[nodiscard]] static ObjectPool& instance() {
+            static auto *pool = new ObjectPool();
+            return *pool;
+        }
+
+        [[nodiscard]] void* allocate() {
+            {
+                std::lock_guard l(_mutex);
+                if(_freeList != nullptr) {
+                    auto *block = _freeList;
+                    _freeList = block->next;
+                    _freeCount--;
+                    return block;
+                }
+            }
+            return ::operator new(BLOCK_SIZE, std::align_val_t{BLOCK_ALIGNMENT});
+        }
+
+        void deallocate(void *ptr) noexcept {
+            {
+                std::lock_guard l(_mutex);
+                if(_freeCount < MAX_FREE_BLOCKS) {
+                    _freeList = ::new(ptr) FreeBlock{_freeList};
+                    _freeCount++;
+                    return;
+                }
+            }
+            ::operator delete(ptr, std::align_val_t{BLOCK_ALIGNMENT});
+        }
+
+        [[nodiscard]] size_t freeBlocks() const noexcept {
+            std::lock_guard l(_mutex);
+            return _freeCount;
+        }
+
+    private:
+        struct FreeBlock final {
+            FreeBlock *next;
+        };
+
+        static constexpr size_t BLOCK_SIZE = sizeof(T) > sizeof(FreeBlock) ? sizeof(T) : sizeof(FreeBlock);
+        static constexpr size_t BLOCK_ALIGNMENT = alignof(T) > alignof(FreeBlock) ? alignof(T) : alignof(FreeBlock);
+
+        ObjectPool() noexcept = default;
+
+        mutable std::mutex _mutex{};
+        FreeBlock *_freeList{nullptr};
+        size_t _freeCount{0};
+    };
+
+    /// Allocator handing out single objects from ObjectPool, meant for std::allocate_shared.
+    /// allocate_shared rebinds it to its control block type, so object and reference counts come from one pooled block.
+    template <typename T>
+    class PoolAllocator final {
+    public:
+        using value_type = T;
+
+        PoolAllocator() noexcept = default;
+        template <typename U>
+        PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+        [[nodiscard]] T* allocate(size_t n) {
+            if(n != 1) {
+                return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+            }
+            return static_cast<T*>(ObjectPool<T>::instance().allocate());
+        }
+
+        void deallocate(T *ptr, size_t n) noexcept {
+            if(n != 1) {
+                ::operator delete(ptr, std::align_val_t{alignof(T)});
+                return;
+            }
+            ObjectPool<T>::instance().deallocate(ptr);
+        }
+
+        template <typename U>
+        [[nodiscard]] bool operator==(const PoolAllocator<U>&) const noexcept {
+            return true;
+        }
+    };
+}
@@ -0,0 +1,313 @@
+#pragma once
+
+#include "framework/ConstevalHash.h"
+#include <any>
+#include <array>
+#include <cstdint>
+#include <initializer_list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <typeinfo>
+#include <utility>
+#include <vector>
+
+namespace Cppelix {
+    /// Name of a property together with its wyhash.
+    /// Created from a string literal the hash is calculated at compile time, other strings are hashed at runtime with the same function.
+    class PropertyKey final {
+    public:
+        template <size_t N>
+        consteval PropertyKey(const char (&name)[N]) noexcept : _hash(consteval_wyhash(name, N - 1, 0)), _name(name, N - 1) {}
+        constexpr PropertyKey(std::string_view name) noexcept : _hash(consteval_wyhash(name.data(), name.size(), 0)), _name(name) {}
+        constexpr PropertyKey(const std::string &name) noexcept : PropertyKey(std::string_view{name}) {}
+        /// \param hash has to be the result of PropertyKey{name}.hash(), for keys that are looked up repeatedly
+        constexpr PropertyKey(uint64_t hash, std::string_view name) noexcept : _hash(hash), _name(name) {}
+
+        [[nodiscard]] constexpr uint64_t hash() const noexcept {
+            return _hash;
+        }
+
+        [[nodiscard]] constexpr std::string_view name() const noexcept {
+            return _name;
+        }
+
+    private:
+        uint64_t _hash;
+        std::string_view _name;
+    };
+
+    enum class PropertyType : uint8_t {
+        EMPTY,
+        BOOL,
+        INT8,
+        INT16,
+        INT32,
+        INT64,
+        UINT8,
+        UINT16,
+        UINT32,
+        UINT64,
+        FLOAT,
+        DOUBLE,
+        STRING,
+        STRING_VIEW,
+        C_STRING,
+        OTHER
+    };
+
+    template <typename T>
+    [[nodiscard]] consteval PropertyType propertyTypeOf() {
+        if constexpr (std::is_same_v<T, bool>) { return PropertyType::BOOL; }
+        else if constexpr (std::is_same_v<T, int8_t>) { return PropertyType::INT8; }
+        else if constexpr (std::is_same_v<T, int16_t>) { return PropertyType::INT16; }
+        else if constexpr (std::is_same_v<T, int32_t>) { return PropertyType::INT32; }
+        else if constexpr (std::is_same_v<T, int64_t>) { return PropertyType::INT64; }
+        else if constexpr (std::is_same_v<T, uint8_t>) { return PropertyType::UINT8; }
+        else if constexpr (std::is_same_v<T, uint16_t>) { return PropertyType::UINT16; }
+        else if constexpr (std::is_same_v<T, uint32_t>) { return PropertyType::UINT32; }
+        else if constexpr (std::is_same_v<T, uint64_t>) { return PropertyType::UINT64; }
+        else if constexpr (std::is_same_v<T, float>) { return PropertyType::FLOAT; }
+        else if constexpr (std::is_same_v<T, double>) { return PropertyType::DOUBLE; }
+        else if constexpr (std::is_same_v<T, std::string>) { return PropertyType::STRING; }
+        else if constexpr (std::is_same_v<T, std::string_view>) { return PropertyType::STRING_VIEW; }
+        else if constexpr (std::is_same_v<T, const char*>) { return PropertyType::C_STRING; }
+        else { return PropertyType::OTHER; }
+    }
+
+    /// \return the tag for the type contained in an std::any, OTHER if it isn't one of the common types
+    [[nodiscard]] PropertyType propertyTypeOf(const std::type_info &type) noexcept;
+
+    /// Value of a property. Still an std::any, so std::any_cast<T>(value) keeps working, but tagged with the type it holds when that is one of the
+    /// common property types. get<T>() rejects a wrong type by comparing the tag instead of going through RTTI.
+    class PropertyValue final : public std::any {
+    public:
+        PropertyValue() noexcept = default;
+        PropertyValue(const PropertyValue&) = default;
+        PropertyValue(PropertyValue&&) noexcept = default;
+        PropertyValue& operator=(const PropertyValue&) = default;
+        PropertyValue& operator=(PropertyValue&&) noexcept = default;
+
+        PropertyValue(std::any value) noexcept : std::any(std::move(value)), _type(has_value() ? propertyTypeOf(type()) : PropertyType::EMPTY) {}
+
+        template <typename T> requires (!std::is_same_v<std::decay_t<T>, PropertyValue> && !std::is_same_v<std::decay_t<T>, std::any>)
+        PropertyValue(T &&value) : std::any(std::forward<T>(value)), _type(propertyTypeOf<std::decay_t<T>>()) {}
+
+        template <typename T> requires (!std::is_same_v<std::decay_t<T>, PropertyValue> && !std::is_same_v<std::decay_t<T>, std::any>)
+        PropertyValue& operator=(T &&value) {
+            std::any::operator=(std::forward<T>(value));
+            _type = propertyTypeOf<std::decay_t<T>>();
+            return *this;
+        }
+
+        // hide the std::any modifiers that would leave the tag stale
+        template <typename T, typename... Args>
+        std::decay_t<T>& emplace(Args&&... args) {
+            auto &ret = std::any::emplace<T>(std::forward<Args>(args)...);
+            _type = propertyTypeOf<std::decay_t<T>>();
+            return ret;
+        }
+
+        void reset() noexcept {
+            std::any::reset();
+            _type = PropertyType::EMPTY;
+        }
+
+        void swap(PropertyValue &other) noexcept {
+            std::any::swap(other);
+            std::swap(_type, other._type);
+        }
+
+        [[nodiscard]] PropertyType propertyType() const noexcept {
+            return _type;
+        }
+
+        /// \return nullptr if the value does not hold a T
+        template <typename T>
+        [[nodiscard]] const T* get() const noexcept {
+            if constexpr (propertyTypeOf<T>() != PropertyType::OTHER) {
+                if(_type != propertyTypeOf<T>()) {
+                    return nullptr;
+                }
+            }
+            return std::any_cast<T>(static_cast<const std::any*>(this));
+        }
+
+    private:
+        PropertyType _type{PropertyType::EMPTY};
+    };
+
+    /// Key/value pair of Properties, accessible as .first/.second and through structured bindings like the std::pair it replaces.
+    class PropertyEntry final {
+    public:
+        PropertyEntry() = default;
+        PropertyEntry(PropertyKey key, PropertyValue value) : first(key.name()), second(std::move(value)), _hash(key.hash()) {}
+
+        [[nodiscard]] uint64_t hash() const noexcept {
+            return _hash;
+        }
+
+        [[nodiscard]] bool matches(PropertyKey key) const noexcept {
+            return _hash == key.hash() && first == key.name();
+        }
+
+        template <size_t I>
+        [[nodiscard]] auto& get() noexcept {
+            if constexpr (I == 0) {
+                return first;
+            } else {
+                return second;
+            }
+        }
+
+        template <size_t I>
+        [[nodiscard]] auto const & get() const noexcept {
+            if constexpr (I == 0) {
+                return first;
+            } else {
+                return second;
+            }
+        }
+
+        std::string first{};
+        PropertyValue second{};
+
+    private:
+        uint64_t _hash{0};
+    };
+
+    /// Flat copy-on-write property map. Lookups are a linear scan comparing precalculated 64 bit hashes, which for the handful of properties
+    /// a service has beats hashing the string again and chasing the nodes of an unordered_map.
+    /// Copies share the entries until one of them is modified, empty properties do not allocate.
+    /// Iterators are always const: change values through operator[], emplace or insert_or_assign, which unshare the entries first.
+    /// Like the standard containers, concurrently modifying and reading the same Properties object is not safe.
+    class Properties final {
+    public:
+        using value_type = PropertyEntry;
+        using size_type = size_t;
+        using const_iterator = const PropertyEntry*;
+        using iterator = const_iterator;
+
+        static constexpr size_t INLINE_CAPACITY = 2;
+
+        Properties() noexcept = default;
+        Properties(std::initializer_list<PropertyEntry> entries);
+        Properties(const Properties&) noexcept = default;
+        Properties(Properties&&) noexcept = default;
+        Properties& operator=(const Properties&) noexcept = default;
+        Properties& operator=(Properties&&) noexcept = default;
+
+        [[nodiscard]] const_iterator begin() const noexcept {
+            return _storage ? _storage->data() : nullptr;
+        }
+
+        [[nodiscard]] const_iterator end() const noexcept {
+            return _storage ? _storage->data() + _storage->size : nullptr;
+        }
+
+        [[nodiscard]] size_type size() const noexcept {
+            return _storage ? _storage->size : 0;
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return size() == 0;
+        }
+
+        [[nodiscard]] const_iterator find(PropertyKey key) const noexcept {
+            for(auto it = begin(), last = end(); it != last; ++it) {
+                if(it->matches(key)) {
+                    return it;
+                }
+            }
+            return end();
+        }
+
+        [[nodiscard]] bool contains(PropertyKey key) const noexcept {
+            return find(key) != end();
+        }
+
+        [[nodiscard]] size_type count(PropertyKey key) const noexcept {
+            return contains(key) ? 1 : 0;
+        }
+
+        /// Throws std::out_of_range if there is no property with this key
+        [[nodiscard]] const PropertyValue& at(PropertyKey key) const;
+
+        /// Inserts an empty value if there is no property with this key. Unshares the entries like any other modifier, so use find() or at()
+        /// for plain reads. The returned reference is invalidated by any later modification and by copying this object: the copy shares the
+        /// entries, so writing through the reference would change the copy as well, and the next modifier of this object moves away from them.
+        PropertyValue& operator[](PropertyKey key);
+
+        template <typename T>
+        std::pair<iterator, bool> emplace(PropertyKey key, T &&value) {
+            auto it = find(key);
+            if(it != end()) {
+                return {it, false};
+            }
+            return {append(PropertyEntry{key, PropertyValue{std::forward<T>(value)}}), true};
+        }
+
+        template <typename T>
+        std::pair<iterator, bool> insert_or_assign(PropertyKey key, T &&value) {
+            if(contains(key)) {
+                (*this)[key] = std::forward<T>(value);
+                return {find(key), false};
+            }
+            return {append(PropertyEntry{key, PropertyValue{std::forward<T>(value)}}), true};
+        }
+
+        size_type erase(PropertyKey key);
+
+        void clear() noexcept {
+            _storage.reset();
+        }
+
+        /// \return true if both objects point to the same entries, i.e. neither has been modified since one was copied from the other
+        [[nodiscard]] bool sharesStorageWith(const Properties &other) const noexcept {
+            return _storage != nullptr && _storage == other._storage;
+        }
+
+    private:
+        struct Storage final {
+            std::array<PropertyEntry, INLINE_CAPACITY> inlineEntries{};
+            std::vector<PropertyEntry> overflowEntries{}; // holds all entries once there are more than INLINE_CAPACITY
+            uint32_t size{0};
+
+            [[nodiscard]] PropertyEntry* data() noexcept {
+                return overflowEntries.empty() ? inlineEntries.data() : overflowEntries.data();
+            }
+
+            [[nodiscard]] const PropertyEntry* data() const noexcept {
+                return overflowEntries.empty() ? inlineEntries.data() : overflowEntries.data();
+            }
+        };
+
+        Storage& mutableStorage();
+        iterator append(PropertyEntry &&entry);
+
+        std::shared_ptr<Storage> _storage{};
+    };
+
+    [[nodiscard]] inline Properties::const_iterator begin(const Properties &properties) noexcept {
+        return properties.begin();
+    }
+
+    [[nodiscard]] inline Properties::const_iterator end(const Properties &properties) noexcept {
+        return properties.end();
+    }
+}
+
+template <>
+struct std::tuple_size<Cppelix::PropertyEntry> : std::integral_constant<size_t, 2> {};
+
+template <>
+struct std::tuple_element<0, Cppelix::PropertyEntry> {
+    using type = std::string;
+};
+
+template <>
+struct std::tuple_element<1, Cppelix::PropertyEntry> {
+    using type = Cppelix::PropertyValue;
+};
@@ -0,0 +1,217 @@
+#pragma once
+
+#include "Service.h"
+#include "ConstevalHash.h"
+#include "EpochDomain.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <vector>
+
+namespace Cppelix {
+    /// Services with a higher "ServiceRanking" (int32_t) property are preferred when several provide the same interface. Defaults to 0.
+    [[nodiscard]] inline int32_t serviceRankingOf(const CppelixProperties &properties) noexcept {
+        auto ranking = properties.find("ServiceRanking");
+        if(ranking == end(properties)) {
+            return 0;
+        }
+
+        auto const *value = ranking->second.get<int32_t>();
+        return value != nullptr ? *value : 0;
+    }
+
+    /// All providers of an interface a service depends on, ordered by ranking (highest first) and then by service id.
+    /// Register it with DependencyRegister::registerProviderSet() instead of registering the interface, the framework then keeps it up to date,
+    /// also while the service is running. Providers are only added and removed on the event loop thread, but the selection functions can be used
+    /// from any thread: they read an immutable snapshot that is swapped atomically, without taking a lock.
+    /// Readers pin the EpochDomain while they look at a snapshot and replaced snapshots are retired into it, so a pointer handed out stays valid
+    /// as long as its provider does. The first pin on a thread allocates its EpochDomain record, so the selection functions may throw std::bad_alloc.
+    template <typename Interface>
+    class ProviderSet final {
+        struct Entry final {
+            Entry(Interface *_provider, uint64_t _serviceId, int32_t _ranking) noexcept : provider(_provider), serviceId(_serviceId), ranking(_ranking) {}
+
+            Interface *provider;
+            uint64_t serviceId;
+            int32_t ranking;
+            std::atomic<uint64_t> inFlight{0};
+        };
+
+        struct Snapshot final {
+            std::vector<std::shared_ptr<Entry>> entries{};
+        };
+
+    public:
+        /// Provider handed out by leastLoaded(), counts as in flight on that provider until destroyed
+        class [[nodiscard]] Lease final {
+        public:
+            Lease() noexcept = default;
+            explicit Lease(std::shared_ptr<Entry> entry) noexcept : _entry(std::move(entry)) {
+                if(_entry) {
+                    _entry->inFlight.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+
+            ~Lease() {
+                release();
+            }
+
+            Lease(const Lease&) = delete;
+            Lease& operator=(const Lease&) = delete;
+            Lease(Lease &&other) noexcept : _entry(std::move(other._entry)) {}
+            Lease& operator=(Lease &&other) noexcept {
+                if(this != &other) {
+                    release();
+                    _entry = std::move(other._entry);
+                }
+                return *this;
+            }
+
+            [[nodiscard]] Interface* get() const noexcept {
+                return _entry ? _entry->provider : nullptr;
+            }
+
+            [[nodiscard]] Interface* operator->() const noexcept {
+                return get();
+            }
+
+            [[nodiscard]] explicit operator bool() const noexcept {
+                return _entry != nullptr;
+            }
+
+        private:
+            void release() noexcept {
+                if(_entry) {
+                    _entry->inFlight.fetch_sub(1, std::memory_order_relaxed);
+                    _entry.reset();
+                }
+            }
+
+            std::shared_ptr<Entry> _entry{};
+        };
+
+        ProviderSet() : _current(new Snapshot{}) {}
+        ~ProviderSet() {
+            delete _current.load(std::memory_order_acquire);
+        }
+
+        ProviderSet(const ProviderSet&) = delete;
+        ProviderSet(ProviderSet&&) = delete;
+        ProviderSet& operator=(const ProviderSet&) = delete;
+        ProviderSet& operator=(ProviderSet&&) = delete;
+
+        /// Event loop thread only
+        /// \param provider provider to add
+        /// \param service the same object as provider
+        /// \return false if the service is already in the set
+        bool add(Interface *provider, IService *service) {
+            auto const &entries = _current.load(std::memory_order_relaxed)->entries;
+            auto serviceId = service->getServiceId();
+            if(std::any_of(begin(entries), end(entries), [serviceId](const std::shared_ptr<Entry> &entry) { return entry->serviceId == serviceId; })) {
+                return false;
+            }
+
+            auto next = std::make_unique<Snapshot>(Snapshot{entries});
+            auto entry = std::make_shared<Entry>(provider, serviceId, serviceRankingOf(*service->getProperties()));
+            auto position = std::upper_bound(begin(next->entries), end(next->entries), entry, [](const std::shared_ptr<Entry> &a, const std::shared_ptr<Entry> &b) {
+                return a->ranking != b->ranking ? a->ranking > b->ranking : a->serviceId < b->serviceId;
+            });
+            next->entries.insert(position, std::move(entry));
+            publish(std::move(next));
+            return true;
+        }
+
+        /// Event loop thread only
+        /// \return false if the service is not in the set
+        bool remove(uint64_t serviceId) {
+            auto const &entries = _current.load(std::memory_order_relaxed)->entries;
+            auto it = std::find_if(begin(entries), end(entries), [serviceId](const std::shared_ptr<Entry> &entry) { return entry->serviceId == serviceId; });
+            if(it == end(entries)) {
+                return false;
+            }
+
+            auto next = std::make_unique<Snapshot>();
+            next->entries.reserve(entries.size() - 1);
+            std::copy_if(begin(entries), end(entries), std::back_inserter(next->entries), [serviceId](const std::shared_ptr<Entry> &entry) { return entry->serviceId != serviceId; });
+            publish(std::move(next));
+            return true;
+        }
+
+        [[nodiscard]] size_t size() const {
+            return read([](const Snapshot &snapshot) { return snapshot.entries.size(); });
+        }
+
+        [[nodiscard]] bool empty() const {
+            return size() == 0;
+        }
+
+        /// \return nullptr if empty
+        [[nodiscard]] Interface* highestRanked() const {
+            return read([](const Snapshot &snapshot) -> Interface* {
+                return snapshot.entries.empty() ? nullptr : snapshot.entries.front()->provider;
+            });
+        }
+
+        /// Cycles through all providers, regardless of ranking
+        /// \return nullptr if empty
+        [[nodiscard]] Interface* roundRobin() {
+            return read([this](const Snapshot &snapshot) -> Interface* {
+                if(snapshot.entries.empty()) {
+                    return nullptr;
+                }
+                return snapshot.entries[_nextIndex.fetch_add(1, std::memory_order_relaxed) % snapshot.entries.size()]->provider;
+            });
+        }
+
+        /// Rendezvous hashing: the same key keeps mapping to the same provider, only keys of a provider that goes away move to another one
+        /// \return nullptr if empty
+        [[nodiscard]] Interface* byKey(uint64_t key) const {
+            return read([key](const Snapshot &snapshot) -> Interface* {
+                Interface *chosen = nullptr;
+                uint64_t bestScore = 0;
+                for(auto const &entry : snapshot.entries) {
+                    auto score = consteval_wymum(key ^ 0xa0761d6478bd642fULL, entry->serviceId ^ 0xe7037ed1a0b428dbULL);
+                    if(chosen == nullptr || score > bestScore) {
+                        chosen = entry->provider;
+                        bestScore = score;
+                    }
+                }
+                return chosen;
+            });
+        }
+
+        /// Provider with the fewest outstanding leases, the highest ranked one when tied
+        /// \return empty lease if the set is empty
+        [[nodiscard]] Lease leastLoaded() const {
+            return read([](const Snapshot &snapshot) {
+                std::shared_ptr<Entry> const *chosen = nullptr;
+                uint64_t lowest = std::numeric_limits<uint64_t>::max();
+                for(auto const &entry : snapshot.entries) {
+                    auto inFlight = entry->inFlight.load(std::memory_order_relaxed);
+                    if(inFlight < lowest) {
+                        chosen = &entry;
+                        lowest = inFlight;
+                    }
+                }
+                return chosen != nullptr ? Lease{*chosen} : Lease{};
+            });
+        }
+
+    private:
+        template <typename FuncT>
+        auto read(FuncT &&func) const {
+            // the pin only writes the record of this thread, readers on different threads don't contend
+            auto guard = EpochDomain::instance().pin();
+            return func(*_current.load(std::memory_order_seq_cst));
+        }
+
+        void publish(std::unique_ptr<Snapshot> next) {
+            EpochDomain::instance().retire(_current.exchange(next.release(), std::memory_order_seq_cst));
+        }
+
+        std::atomic<Snapshot*> _current;
+        std::atomic<uint64_t> _nextIndex{0};
+    };
+}
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+#include "Histogram.h"
+
+namespace Cppelix {
+    /// State of the event queue of a DependencyManager at one moment. Counters only grow, take the difference of two snapshots for rates.
+    struct QueueMetricsSnapshot final {
+        std::chrono::steady_clock::time_point taken{};
+        uint64_t pushed{0};
+        uint64_t dispatched{0};
+        uint64_t depth{0};
+        std::vector<std::pair<uint64_t, uint64_t>> depthByPriority{}; // priority + events queued with it, most urgent first, for the first QueueMetrics::PRIORITY_SLOTS priorities pushed
+        uint64_t depthOfOtherPriorities{0}; // events queued with any priority pushed after the slots ran out
+        /// Nanoseconds from push to dispatch, over all events pushed while the metrics were enabled
+        HistogramSummary wait{};
+        /// The same per priority, for the first QueueMetrics::PRIORITY_SLOTS priorities seen
+        std::vector<std::pair<uint64_t, HistogramSummary>> waitByPriority{};
+
+        /// \return events dispatched per second between earlier and this snapshot
+        [[nodiscard]] double dispatchRateSince(const QueueMetricsSnapshot &earlier) const noexcept {
+            auto seconds = std::chrono::duration<double>(taken - earlier.taken).count();
+            return seconds <= 0 ? 0 : static_cast<double>(dispatched - earlier.dispatched) / seconds;
+        }
+
+        /// \return events pushed per second between earlier and this snapshot
+        [[nodiscard]] double pushRateSince(const QueueMetricsSnapshot &earlier) const noexcept {
+            auto seconds = std::chrono::duration<double>(taken - earlier.taken).count();
+            return seconds <= 0 ? 0 : static_cast<double>(pushed - earlier.pushed) / seconds;
+        }
+    };
+
+    /// Counters and wait time histograms of the event queue of a DependencyManager. Push, dispatch and depth counts are always kept, wait times
+    /// only while enabled: stamping an event costs a steady_clock read on push and another on dispatch.
+    /// The depth per priority is the difference of two counters per priority slot, so reading it never takes the lock of the event queue.
+    /// Wait times are recorded by the event loop thread only. Everything can be read from any thread.
+    class QueueMetrics final {
+    public:
+        static constexpr size_t PRIORITY_SLOTS = 16;
+
+        /// Allocates the per priority histograms the first time the metrics are enabled
+        void setEnabled(bool enabled);
+
+        [[nodiscard]] bool enabled() const noexcept {
+            return _enabled.load(std::memory_order_acquire);
+        }
+
+        /// \return push time to store with an event, 0 while disabled
+        [[nodiscard]] uint64_t timestamp() const noexcept {
+            if(!enabled()) {
+                return 0;
+            }
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+        }
+
+        /// Any thread, counts a new event entering the queue
+        void pushed(uint64_t priority) noexcept {
+            _pushed.fetch_add(1, std::memory_order_relaxed);
+            enqueued(priority);
+        }
+
+        /// Any thread, an event entering the queue again without being pushed anew, e.g. after it was held back
+        void enqueued(uint64_t priority) noexcept {
+            depthSlotOf(priority).enqueued.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        /// Event loop thread only, an event was taken out of the queue
+        void dequeued(uint64_t priority) noexcept {
+            // release: a reader that sees this also sees the enqueue of the event, so depths never go negative
+            depthSlotOf(priority).dequeued.fetch_add(1, std::memory_order_release);
+        }
+
+        /// Event loop thread only
+        /// \param enqueuedAt what timestamp() returned when the event was pushed
+        void dispatched(uint64_t priority, uint64_t enqueuedAt) noexcept;
+
+        void fill(QueueMetricsSnapshot &snapshot) const;
+
+    private:
+        static constexpr uint64_t UNUSED_SLOT = std::numeric_limits<uint64_t>::max();
+
+        struct DepthSlot final {
+            std::atomic<uint64_t> priority{UNUSED_SLOT};
+            std::atomic<uint64_t> enqueued{0};
+            std::atomic<uint64_t> dequeued{0};
+
+            [[nodiscard]] uint64_t depth() const noexcept {
+                auto out = dequeued.load(std::memory_order_acquire);
+                auto in = enqueued.load(std::memory_order_relaxed);
+                return in > out ? in - out : 0;
+            }
+        };
+
+        struct PrioritySlot final {
+            std::atomic<uint64_t> priority{UNUSED_SLOT};
+            std::unique_ptr<Histogram> wait{}; // created before enabling, dispatched() cannot allocate
+        };
+
+        std::atomic<uint64_t> _pushed{0};
+        std::atomic<uint64_t> _dispatched{0};
+        Histogram _wait{};
+        std::array<PrioritySlot, PRIORITY_SLOTS> _waitByPriority{};
+        std::array<DepthSlot, PRIORITY_SLOTS> _depthByPriority{}; // claimed by the first push of a priority, in use slots come first
+        DepthSlot _depthOfOtherPriorities{}; // priority stays UNUSED_SLOT
+        std::atomic<bool> _enabled{false};
+        std::once_flag _histogramsCreated{};
+
+        /// \return slot counting the depth of priority, claiming an unused one the first time priority is seen
+        [[nodiscard]] DepthSlot& depthSlotOf(uint64_t priority) noexcept;
+    };
+}
@@ -27,7 +27,8 @@ namespace Cppelix {
 
         [[nodiscard]] virtual DependencyManager* getManager() = 0;
 
-        [[nodiscard]] virtual CppelixProperties* getProperties() = 0;
+        /// Read-only, the properties are set before the service is registered and the DependencyManager indexes them as they are then
+        [[nodiscard]] virtual CppelixProperties const * getProperties() const = 0;
     };
 
     class Service : virtual public IService {
@@ -44,11 +45,16 @@ namespace Cppelix {
             return _serviceId;
         }
 
+        /// Random (version 4) uuid of this service instance, unlike the service id it is never reused
+        [[nodiscard]] sole::uuid getServiceGid() const noexcept {
+            return _serviceGid;
+        }
+
         [[nodiscard]] DependencyManager* getManager() final {
             return _manager;
         }
 
-        [[nodiscard]] CppelixProperties* getProperties() final {
+        [[nodiscard]] CppelixProperties const * getProperties() const final {
             return &_properties;
         }
 
@@ -56,22 +62,46 @@ namespace Cppelix {
         [[nodiscard]] virtual bool start() = 0;
         [[nodiscard]] virtual bool stop() = 0;
 
-        CppelixProperties _properties;
     private:
         ///
         /// \return true if started
         [[nodiscard]] bool internal_start();
         ///
+        /// \return true if the service transitioned to STARTING and start() may be called through internal_run_start()
+        [[nodiscard]] bool internal_prepare_start();
+        ///
+        /// Only calls the user provided start(), no state is touched so this can be called off the event loop thread.
+        /// \return result of start()
+        [[nodiscard]] bool internal_run_start();
+        ///
+        /// \param started result of internal_run_start()
+        /// \return started
+        bool internal_finish_start(bool started);
+        ///
         /// \return true if stopped or already stopped
         [[nodiscard]] bool internal_stop();
+        ///
+        /// \return true if the service transitioned to STOPPING and stop() may be called through internal_run_stop()
+        [[nodiscard]] bool internal_prepare_stop();
+        ///
+        /// Only calls the user provided stop(), no state is touched so this can be called off the event loop thread.
+        /// \return result of stop()
+        [[nodiscard]] bool internal_run_stop();
+        ///
+        /// \param stopped result of internal_run_stop()
+        /// \return stopped
+        bool internal_finish_stop(bool stopped);
+        [[nodiscard]] static uint64_t takeServiceId() noexcept;
         [[nodiscard]] ServiceState getState() const noexcept;
         void setProperties(CppelixProperties&& properties);
 
 
+        CppelixProperties _properties;
         uint64_t _serviceId;
         sole::uuid _serviceGid;
         ServiceState _serviceState;
-        static std::atomic<uint64_t> _serviceIdCounter;
+        static std::atomic<uint64_t> _serviceIdCounter; // only for services constructed outside of a DependencyManager
+        static thread_local uint64_t _nextServiceId; // slot map id reserved by the DependencyManager for the service it is constructing
         DependencyManager *_manager{nullptr};
 
         friend class DependencyManager;
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "Common.h"
+#include <memory>
+#include <string>
+#include <vector>
+#include <unordered_map>
+
+namespace Cppelix {
+    class ILifecycleManager;
+    class Filter;
+
+    /// Inverted indexes over the services of a DependencyManager, so finding the services affected by a provider coming online or going offline
+    /// is an intersection of a few sorted id lists instead of a scan over all services.
+    /// Properties are indexed when the service is added, which is fine because IService::getProperties() is read-only after registration.
+    /// Only equality terms of a filter are looked up here, so candidates still have to be verified with Filter::compareTo.
+    /// Not thread-safe, only used from the event loop thread.
+    class ServiceIndex final {
+    public:
+        void add(const std::shared_ptr<ILifecycleManager> &manager);
+        void remove(const std::shared_ptr<ILifecycleManager> &manager);
+        void clear() noexcept;
+
+        /// \param provider service providing interfaces
+        /// \param filter optional filter of the provider, restricting the dependents it may be injected into
+        /// \param out sorted ids of services that requested any of the interfaces of provider and possibly match the filter
+        void findDependents(const ILifecycleManager &provider, const Filter *filter, std::vector<uint64_t> &out) const;
+
+        /// \param dependent service requesting interfaces
+        /// \param out sorted ids of services providing any of the interfaces requested by dependent
+        void findProviders(const ILifecycleManager &dependent, std::vector<uint64_t> &out) const;
+
+        /// \param out sorted ids of services that requested interfaceNameHash, in any version
+        void findRequesters(uint64_t interfaceNameHash, std::vector<uint64_t> &out) const;
+
+        /// \return true if any service requested interfaceNameHash, regardless of filters
+        [[nodiscard]] bool hasDependents(uint64_t interfaceNameHash) const noexcept;
+
+    private:
+        std::unordered_map<uint64_t, std::vector<uint64_t>> _dependentsByInterface{}; // key = interface name hash, value = sorted service ids
+        std::unordered_map<uint64_t, std::vector<uint64_t>> _providersByInterface{}; // key = interface name hash, value = sorted service ids
+        std::unordered_map<std::string, std::unordered_map<std::string, std::vector<uint64_t>>> _servicesByProperty{}; // key = property key, value = property value -> sorted service ids
+    };
+}
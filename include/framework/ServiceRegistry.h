@@ -0,0 +1,127 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace Cppelix {
+    class ILifecycleManager;
+
+    /// Generational slot map holding the lifecycle managers of a DependencyManager.
+    /// A service id is (generation << 40) | (owner << 20) | slot, so a lookup is an index into the slot array and a generation compare.
+    /// The owner is the id of the DependencyManager, which makes service ids unique within the process: an id that travelled to another
+    /// manager through the CommunicationChannel never resolves to one of that manager's services. Only managers whose ids are 2^20 apart
+    /// share an owner. The top bit marks services of other processes, see FOREIGN_BIT.
+    /// Removing a service bumps the generation of its slot, ids of removed services never resolve again, even when the slot is reused.
+    /// Managers are stored densely, iterating over all services walks one array. Removal moves the last entry into the hole, which
+    /// invalidates iterators and references into the registry: hold a copy of the shared_ptr while calling into a service.
+    /// Not thread-safe, only used from the event loop thread.
+    class ServiceRegistry final {
+    public:
+        using value_type = std::pair<uint64_t, std::shared_ptr<ILifecycleManager>>;
+        using iterator = std::vector<value_type>::iterator;
+        using const_iterator = std::vector<value_type>::const_iterator;
+
+        static constexpr uint32_t SLOT_BITS = 20;
+        static constexpr uint32_t OWNER_BITS = 20;
+        static constexpr uint32_t GENERATION_BITS = 23;
+        /// Set on ids that arrive from another process, no registry hands out ids with it
+        static constexpr uint64_t FOREIGN_BIT = uint64_t{1} << 63U;
+
+        explicit ServiceRegistry(uint64_t ownerId = 0) noexcept : _owner(static_cast<uint32_t>(ownerId & OWNER_MASK)) {}
+
+        [[nodiscard]] static constexpr uint32_t slotOf(uint64_t serviceId) noexcept {
+            return static_cast<uint32_t>(serviceId & SLOT_MASK);
+        }
+
+        [[nodiscard]] static constexpr uint32_t ownerOf(uint64_t serviceId) noexcept {
+            return static_cast<uint32_t>((serviceId >> SLOT_BITS) & OWNER_MASK);
+        }
+
+        [[nodiscard]] static constexpr uint32_t generationOf(uint64_t serviceId) noexcept {
+            // leaves out FOREIGN_BIT, no slot ever has a generation that includes it
+            return static_cast<uint32_t>(serviceId >> (SLOT_BITS + OWNER_BITS));
+        }
+
+        /// Allocate an id for a service that is about to be constructed, find() does not return it until insert() is called.
+        /// Throws std::runtime_error when all slots are in use.
+        [[nodiscard]] uint64_t reserve();
+
+        /// Give back an id from reserve() whose service never got inserted
+        void release(uint64_t serviceId) noexcept;
+
+        /// Throws std::runtime_error if serviceId was not reserved
+        void insert(uint64_t serviceId, std::shared_ptr<ILifecycleManager> manager);
+
+        /// \return false if serviceId is unknown or belongs to an already removed service
+        bool erase(uint64_t serviceId);
+
+        void clear() noexcept;
+
+        [[nodiscard]] iterator find(uint64_t serviceId) noexcept {
+            auto index = denseIndexOf(serviceId);
+            return index < _entries.size() ? _entries.begin() + index : _entries.end();
+        }
+
+        [[nodiscard]] const_iterator find(uint64_t serviceId) const noexcept {
+            auto index = denseIndexOf(serviceId);
+            return index < _entries.size() ? _entries.begin() + index : _entries.end();
+        }
+
+        [[nodiscard]] bool contains(uint64_t serviceId) const noexcept {
+            return denseIndexOf(serviceId) < _entries.size();
+        }
+
+        [[nodiscard]] iterator begin() noexcept { return _entries.begin(); }
+        [[nodiscard]] iterator end() noexcept { return _entries.end(); }
+        [[nodiscard]] const_iterator begin() const noexcept { return _entries.begin(); }
+        [[nodiscard]] const_iterator end() const noexcept { return _entries.end(); }
+
+        [[nodiscard]] size_t size() const noexcept {
+            return _entries.size();
+        }
+
+        [[nodiscard]] bool empty() const noexcept {
+            return _entries.empty();
+        }
+
+        /// \return entry at position index of the dense array, for loops that have to survive services being added while iterating
+        [[nodiscard]] value_type& at(size_t index) {
+            return _entries.at(index);
+        }
+
+    private:
+        static constexpr uint64_t SLOT_MASK = (uint64_t{1} << SLOT_BITS) - 1;
+        static constexpr uint64_t OWNER_MASK = (uint64_t{1} << OWNER_BITS) - 1;
+        static constexpr uint32_t GENERATION_MASK = (uint32_t{1} << GENERATION_BITS) - 1;
+        static constexpr uint32_t FREE = std::numeric_limits<uint32_t>::max();
+        static constexpr uint32_t RESERVED = FREE - 1;
+
+        struct Slot final {
+            uint32_t generation;
+            uint32_t denseIndex; // FREE or RESERVED when no manager occupies the slot
+        };
+
+        [[nodiscard]] uint32_t denseIndexOf(uint64_t serviceId) const noexcept {
+            auto slot = slotOf(serviceId);
+            if(slot >= _slots.size() || _slots[slot].generation != generationOf(serviceId) || ownerOf(serviceId) != _owner) {
+                return FREE;
+            }
+            return _slots[slot].denseIndex;
+        }
+
+        void retire(uint32_t slot) noexcept;
+
+        std::vector<Slot> _slots{};
+        std::vector<uint32_t> _freeSlots{}; // capacity always covers every slot, release(), erase() and clear() push without allocating
+        std::vector<value_type> _entries{};
+        uint32_t _owner;
+    };
+
+    [[nodiscard]] inline ServiceRegistry::iterator begin(ServiceRegistry &registry) noexcept { return registry.begin(); }
+    [[nodiscard]] inline ServiceRegistry::iterator end(ServiceRegistry &registry) noexcept { return registry.end(); }
+    [[nodiscard]] inline ServiceRegistry::const_iterator begin(const ServiceRegistry &registry) noexcept { return registry.begin(); }
+    [[nodiscard]] inline ServiceRegistry::const_iterator end(const ServiceRegistry &registry) noexcept { return registry.end(); }
+}
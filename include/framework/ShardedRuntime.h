@@ -0,0 +1,126 @@
+#pragma once
+
+#include "DependencyManager.h"
+#include "CommunicationChannel.h"
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace Cppelix {
+    struct ShardedRuntimeOptions final {
+        /// Cores to run a shard on, all cores the process may run on when empty
+        std::vector<uint32_t> cores{};
+        /// Restrict every shard thread to its core. Best effort, a thread that can't be pinned runs unpinned.
+        bool pinThreads{true};
+        /// Prefer memory of the NUMA node a shard runs on for everything allocated on its thread, its manager and services included.
+        /// Best effort, ignored by kernels without NUMA support.
+        bool numaLocal{false};
+    };
+
+    /// Thread-per-core runtime: one DependencyManager per selected core, each running on its own thread pinned to that core, all joined in one
+    /// CommunicationChannel. Shards share nothing but the channel. A service created with createShardedService() lives on the single shard that
+    /// owns its key, and sendEventToShard() pushes events for that key into that shard only, so state keyed the same way never crosses cores.
+    ///
+    ///     ShardedRuntime runtime{};
+    ///     runtime.onEveryShard([](DependencyManager &dm, size_t) { dm.createServiceManager<CoutFrameworkLogger, IFrameworkLogger>(); });
+    ///     runtime.createShardedService<ConnectionService, IConnectionService>(connectionHash);
+    ///     runtime.start();
+    ///     runtime.sendEventToShard<DataEvent>(connectionHash, 0, ...);
+    ///     runtime.stop();
+    ///     runtime.join();
+    class ShardedRuntime final {
+    public:
+        /// Property every service created through createShardedService() gets, holding its key as uint64_t
+        static constexpr std::string_view SHARD_KEY_PROPERTY = "ShardKey";
+
+        explicit ShardedRuntime(ShardedRuntimeOptions options = {});
+        /// Stops the shards if they are still running and waits for them
+        ~ShardedRuntime();
+
+        ShardedRuntime(const ShardedRuntime&) = delete;
+        ShardedRuntime(ShardedRuntime&&) = delete;
+        ShardedRuntime& operator=(const ShardedRuntime&) = delete;
+        ShardedRuntime& operator=(ShardedRuntime&&) = delete;
+
+        [[nodiscard]] size_t shardCount() const noexcept {
+            return _cores.size();
+        }
+
+        [[nodiscard]] uint32_t coreOf(size_t shard) const {
+            return _cores.at(shard);
+        }
+
+        /// Keys are mixed before they are mapped, sequential keys like connection ids spread evenly as well
+        /// \return shard owning key, the same for as long as the runtime exists
+        [[nodiscard]] size_t shardOf(uint64_t key) const noexcept;
+
+        /// Only valid after start() returned
+        /// \return DependencyManager::getId() of the manager of shard, to use with the CommunicationChannel
+        [[nodiscard]] uint64_t managerIdOf(size_t shard) const {
+            return _managers.at(shard)->getId();
+        }
+
+        [[nodiscard]] CommunicationChannel& getCommunicationChannel() noexcept {
+            return _channel;
+        }
+
+        /// Run setup on the thread of every shard, before its manager starts. Setups and sharded services are created in the order they were added,
+        /// so add the framework logger first. Has to be called before start()
+        void onEveryShard(std::function<void(DependencyManager&, size_t shard)> setup);
+
+        /// Create Impl on the shard owning key only, with key stored in the SHARD_KEY_PROPERTY property. Has to be called before start()
+        template <typename Impl, typename... Interfaces>
+        requires ImplementsAll<Impl, Interfaces...>
+        void createShardedService(uint64_t key, CppelixProperties properties = CppelixProperties{}) {
+            checkNotStarted();
+            properties.insert_or_assign(SHARD_KEY_PROPERTY, key);
+            _setups[shardOf(key)].emplace_back([properties = std::move(properties)](DependencyManager &dm, size_t) {
+                dm.createServiceManager<Impl, Interfaces...>(properties);
+            });
+        }
+
+        /// Spawn the shard threads. Returns once every manager exists and is part of the channel, its services might not be started yet.
+        void start();
+
+        /// Ask every shard to quit, from any thread including the shards' own. Use join() to wait for them.
+        void stop();
+
+        /// Wait until every shard's manager quit, either through stop() or by a QuitEvent of its own, then destroy the managers.
+        /// Not from a shard thread.
+        void join();
+
+        /// Push EventT into the shard owning key, from any thread. Only valid between start() and join()
+        template <typename EventT, typename... Args>
+        requires Derived<EventT, Event>
+        void sendEventToShard(uint64_t key, uint64_t originatingServiceId, Args&&... args) {
+            _managers[shardOf(key)]->template pushEvent<EventT>(originatingServiceId, std::forward<Args>(args)...);
+        }
+
+        /// \return runtime the calling thread is a shard of, nullptr for any other thread
+        [[nodiscard]] static ShardedRuntime* current() noexcept;
+
+        /// \return shard the calling thread runs, empty for threads that are not a shard
+        [[nodiscard]] static std::optional<size_t> currentShard() noexcept;
+
+    private:
+        void checkNotStarted() const;
+        void runShard(size_t shard);
+
+        std::vector<uint32_t> _cores;
+        bool _pinThreads;
+        bool _numaLocal;
+        CommunicationChannel _channel{};
+        std::vector<std::vector<std::function<void(DependencyManager&, size_t)>>> _setups;
+        // created on the shard threads, destroyed by join() once all of them returned
+        std::vector<std::unique_ptr<DependencyManager>> _managers;
+        std::vector<std::thread> _threads{};
+        std::mutex _readyMutex{};
+        std::condition_variable _readyCondition{};
+        size_t _readyShards{0};
+        bool _started{false};
+    };
+}
@@ -0,0 +1,248 @@
+#pragma once
+
+#include "DependencyManager.h"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace Cppelix {
+    class ISerializationAdmin;
+
+    /// Trivially copyable types that point into the memory of the sending process, copying them to another process makes no sense
+    template <class T>
+    struct ProcessLocalTrait : std::integral_constant<bool, std::is_pointer_v<T> || std::is_member_pointer_v<T>> {};
+
+    template <class CharT, class Traits>
+    struct ProcessLocalTrait<std::basic_string_view<CharT, Traits>> : std::true_type {};
+
+    template <class T, size_t Extent>
+    struct ProcessLocalTrait<std::span<T, Extent>> : std::true_type {};
+
+    template <class T>
+    struct ProcessLocalTrait<std::reference_wrapper<T>> : std::true_type {};
+
+    template <class... Args>
+    concept CrossProcessArguments = !(ProcessLocalTrait<std::decay_t<Args>>::value || ...);
+
+    /// Moves events between DependencyManagers of different processes on the same host, through a POSIX shared memory segment.
+    /// Every attached manager owns a ring in the segment that any process can write to. Writers only serialize on reserving space, which
+    /// is taken over from a writer that died meanwhile, and copy their events in concurrently. A thread per attached manager reads its
+    /// ring and pushes the events into the manager, skipping records of writers that died before finishing them.
+    /// An event crosses as the arguments of its constructor, after id, originating service and priority. When all of them are trivially
+    /// copyable they are copied as is, otherwise they are serialized as a std::tuple of them through the ISerializationAdmin, which then
+    /// needs a serializer for that tuple type in both processes. The transport only forward declares ISerializationAdmin, code sending or
+    /// registering such events has to include <optional_bundles/serialization_bundle/ISerializationAdmin.h> itself.
+    /// Pointers, references, std::string_view and std::span are refused at compile time, pass the data they refer to instead.
+    /// Attach a transport to a CommunicationChannel to have its broadcastEvent and sendEventTo reach other processes as well.
+    class SharedMemoryTransport final {
+    public:
+        /// Set in every id handed out by attachManager and findManager, so they never collide with DependencyManager::getId()
+        static constexpr uint64_t REMOTE_MANAGER_BIT = 1ULL << 63U;
+        static constexpr size_t MAX_NAME_LENGTH = 47;
+
+        /// Maps the segment name, creating it when no process did yet. All processes have to use the same maxManagers and ringBytes.
+        /// Throws std::runtime_error when the segment can't be mapped or was created with a different layout.
+        /// \param ringBytes capacity of the ring of every manager, a power of two of at least 4096
+        explicit SharedMemoryTransport(std::string name, uint32_t maxManagers = 16, uint32_t ringBytes = 1U << 20U);
+        /// Detaches the managers attached through this transport. The segment itself stays until unlink().
+        ~SharedMemoryTransport();
+
+        SharedMemoryTransport(const SharedMemoryTransport&) = delete;
+        SharedMemoryTransport(SharedMemoryTransport&&) = delete;
+        SharedMemoryTransport& operator=(const SharedMemoryTransport&) = delete;
+        SharedMemoryTransport& operator=(SharedMemoryTransport&&) = delete;
+
+        /// Remove the segment name, processes that have it mapped keep using it
+        static void unlink(std::string name);
+
+        /// Claim a ring for manager, visible to other processes under name. Rings of processes that died are reused.
+        /// Throws std::runtime_error when all rings are taken or the name is too long.
+        /// \return id to pass to sendEventTo, from any process
+        uint64_t attachManager(DependencyManager *manager, std::string_view name);
+        void detachManager(DependencyManager *manager);
+
+        /// \return id of the manager attached under name by any process, empty if there is none
+        [[nodiscard]] std::optional<uint64_t> findManager(std::string_view name) const;
+
+        /// Allow EventT to cross, in both the sending and the receiving process. Args are the decayed types of the constructor arguments
+        /// after id, originating service and priority. Senders have to pass exactly these types.
+        /// Register all event types before attaching managers, the receiving threads read the registrations without locking.
+        template <typename EventT, typename... Args>
+        requires Derived<EventT, Event>
+        void registerEventType() {
+            static_assert(CrossProcessArguments<Args...>, "event arguments pointing into the sending process can't cross processes");
+            _eventTypes.insert_or_assign(EventT::TYPE, EventTypeInfo{typeNameHash<std::tuple<Args...>>(), &decode<EventT, Args...>});
+        }
+
+        [[nodiscard]] bool isRegistered(uint64_t eventType) const noexcept {
+            return _eventTypes.contains(eventType);
+        }
+
+        /// Needed for event types with arguments that are not trivially copyable, in every process using them
+        void setSerializationAdmin(ISerializationAdmin *admin) noexcept {
+            _serializationAdmin.store(admin, std::memory_order_release);
+        }
+
+        /// Blocks while the ring of the receiver is full, for at most the send timeout.
+        /// Throws std::runtime_error when id is not attached (anymore), EventT is not registered with these argument types, or the ring
+        /// stayed full, because the receiving process died or didn't keep up.
+        template <typename EventT, typename... Args>
+        requires Derived<EventT, Event>
+        void sendEventTo(uint64_t id, uint64_t originatingServiceId, const Args&... args) {
+            encode<EventT>(originatingServiceId, [this, id](const MessageHeader &header, std::byte const *payload) {
+                write(id, header, payload);
+            }, args...);
+        }
+
+        /// Send to the managers attached by other processes, the ones of this process are reached through the CommunicationChannel.
+        /// Event types that are not registered stay local. Receivers whose ring stays full for the send timeout miss the event, see
+        /// undeliveredEvents().
+        template <typename EventT, typename... Args>
+        requires Derived<EventT, Event>
+        void broadcastEvent(uint64_t originatingServiceId, const Args&... args) {
+            if(!isRegistered(EventT::TYPE)) {
+                return;
+            }
+
+            encode<EventT>(originatingServiceId, [this](const MessageHeader &header, std::byte const *payload) {
+                writeToOtherProcesses(header, payload);
+            }, args...);
+        }
+
+        /// \return amount of received events that were not registered, did not match the registered arguments, failed to deserialize or were
+        /// left unfinished by a sender that died
+        [[nodiscard]] uint64_t droppedEvents() const noexcept {
+            return _droppedEvents.load(std::memory_order_relaxed);
+        }
+
+        /// \return amount of broadcast events not written to a receiver, because its ring stayed full or it went away meanwhile
+        [[nodiscard]] uint64_t undeliveredEvents() const noexcept {
+            return _undeliveredEvents.load(std::memory_order_relaxed);
+        }
+
+        /// How long sending waits for room in the ring of a receiver before giving up. Defaults to one second.
+        void setSendTimeout(std::chrono::milliseconds timeout) noexcept {
+            _sendTimeout.store(timeout.count(), std::memory_order_relaxed);
+        }
+
+    private:
+        struct MessageHeader final {
+            uint64_t eventType;
+            uint64_t argsHash;
+            uint64_t originatingService;
+            uint32_t payloadSize;
+            bool serialized;
+        };
+
+        using DecodeFn = bool (*)(DependencyManager &manager, uint64_t originatingServiceId, std::byte const *payload, uint32_t size, bool serialized, ISerializationAdmin *admin);
+
+        struct EventTypeInfo final {
+            uint64_t argsHash;
+            DecodeFn decode;
+        };
+
+        /// ISerializationAdmin, as a type depending on the event arguments so it only has to be complete for events that get serialized
+        template <typename>
+        struct DeferredSerializationAdmin final {
+            using type = ISerializationAdmin;
+        };
+
+        struct Attachment final {
+            DependencyManager *manager;
+            uint32_t ring;
+            std::atomic<bool> running{true};
+            std::thread thread{};
+        };
+
+        template <typename EventT, typename WriteFn, typename... Args>
+        void encode(uint64_t originatingServiceId, WriteFn &&writeFn, const Args&... args) {
+            using ArgsT = std::tuple<std::decay_t<Args>...>;
+            static_assert(CrossProcessArguments<Args...>, "event arguments pointing into the sending process can't cross processes");
+            auto argsHash = typeNameHash<ArgsT>();
+            checkRegistration(EventT::TYPE, argsHash);
+
+            if constexpr ((std::is_trivially_copyable_v<std::decay_t<Args>> && ...)) {
+                std::array<std::byte, (size_t{0} + ... + sizeof(std::decay_t<Args>))> payload;
+                [[maybe_unused]] size_t offset = 0;
+                ((std::memcpy(payload.data() + offset, &args, sizeof(std::decay_t<Args>)), offset += sizeof(std::decay_t<Args>)), ...);
+                writeFn(MessageHeader{EventT::TYPE, argsHash, originatingServiceId, static_cast<uint32_t>(payload.size()), false}, payload.data());
+            } else {
+                typename DeferredSerializationAdmin<ArgsT>::type &admin = serializationAdmin();
+                auto bytes = admin.template serialize<ArgsT>(ArgsT{args...});
+                writeFn(MessageHeader{EventT::TYPE, argsHash, originatingServiceId, static_cast<uint32_t>(bytes.size()), true}, reinterpret_cast<std::byte const *>(bytes.data()));
+            }
+        }
+
+        template <typename EventT, typename... Args>
+        static bool decode(DependencyManager &manager, uint64_t originatingServiceId, std::byte const *payload, uint32_t size, bool serialized, ISerializationAdmin *admin) {
+            auto push = [&manager, originatingServiceId](Args&... args) {
+                manager.template pushEvent<EventT>(originatingServiceId, std::move(args)...);
+            };
+
+            if constexpr ((std::is_trivially_copyable_v<Args> && ...)) {
+                if(serialized || size != (size_t{0} + ... + sizeof(Args))) {
+                    return false;
+                }
+
+                std::tuple<Args...> args{};
+                std::apply([payload](Args&... elements) {
+                    [[maybe_unused]] size_t offset = 0;
+                    ((std::memcpy(&elements, payload + offset, sizeof(Args)), offset += sizeof(Args)), ...);
+                }, args);
+                std::apply(push, args);
+            } else {
+                if(!serialized || admin == nullptr) {
+                    return false;
+                }
+
+                typename DeferredSerializationAdmin<std::tuple<Args...>>::type *deferredAdmin = admin;
+                auto const *bytes = reinterpret_cast<uint8_t const *>(payload);
+                auto args = deferredAdmin->template deserialize<std::tuple<Args...>>(std::vector<uint8_t>(bytes, bytes + size));
+                if(!args) {
+                    return false;
+                }
+                std::apply(push, *args);
+            }
+
+            return true;
+        }
+
+        /// Throws std::runtime_error if eventType is not registered with argsHash
+        void checkRegistration(uint64_t eventType, uint64_t argsHash) const;
+        /// Throws std::runtime_error if no ISerializationAdmin is set
+        [[nodiscard]] ISerializationAdmin& serializationAdmin() const;
+        void write(uint64_t id, const MessageHeader &header, std::byte const *payload);
+        void writeToOtherProcesses(const MessageHeader &header, std::byte const *payload);
+        void writeToRing(uint32_t ring, uint32_t generation, const MessageHeader &header, std::byte const *payload);
+        void receive(Attachment &attachment);
+        void dispatch(DependencyManager &manager, const MessageHeader &header, std::byte const *payload);
+        void stopReceiving(Attachment &attachment);
+
+        std::string _name;
+        uint32_t _maxManagers;
+        uint32_t _ringBytes;
+        size_t _segmentSize;
+        std::byte *_segment;
+        std::unordered_map<uint64_t, EventTypeInfo> _eventTypes{};
+        std::atomic<ISerializationAdmin*> _serializationAdmin{nullptr};
+        std::atomic<uint64_t> _droppedEvents{0};
+        std::atomic<uint64_t> _undeliveredEvents{0};
+        std::atomic<std::chrono::milliseconds::rep> _sendTimeout{1'000};
+        std::mutex _attachmentsMutex{};
+        std::vector<std::unique_ptr<Attachment>> _attachments{};
+    };
+}
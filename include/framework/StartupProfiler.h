@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <chrono>
+#include <mutex>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Cppelix {
+    struct ServiceStartupRecord final {
+        using time_point = std::chrono::steady_clock::time_point;
+
+        uint64_t serviceId{0};
+        std::string_view implementationName{};
+        // service whose DependencyOnlineEvent satisfied the last required dependency, 0 if none was needed
+        uint64_t gatingServiceId{0};
+        uint32_t startAttempts{0};
+        bool started{false};
+        time_point installed{};
+        time_point dependenciesSatisfied{};
+        time_point startBegin{};
+        time_point startEnd{};
+    };
+
+    /// Records install, dependency-satisfied, start-begin and start-end timestamps for every service of a DependencyManager.
+    /// Only the first successful start of a service is kept, so memory use is bounded by the amount of services.
+    /// Recording is a steady_clock read and an uncontended lock, start() may run on the lifecycle thread pool so it has to be thread safe.
+    class StartupProfiler final {
+    public:
+        StartupProfiler();
+
+        void setEnabled(bool enabled) noexcept {
+            _enabled.store(enabled, std::memory_order_release);
+        }
+
+        [[nodiscard]] bool enabled() const noexcept {
+            return _enabled.load(std::memory_order_acquire);
+        }
+
+        void serviceInstalled(uint64_t serviceId, std::string_view implementationName);
+        void dependenciesSatisfied(uint64_t serviceId, uint64_t gatingServiceId);
+        void startBegin(uint64_t serviceId);
+        void startEnd(uint64_t serviceId, bool started);
+        void serviceRemoved(uint64_t serviceId);
+
+        /// \return copy of all records, ordered by install time
+        [[nodiscard]] std::vector<ServiceStartupRecord> getRecords() const;
+
+        /// Follows the gating services back from the service that finished starting last.
+        /// \return the chain of services that determined how long startup took, first entry started first
+        [[nodiscard]] std::vector<ServiceStartupRecord> getCriticalPath() const;
+
+        /// Export all records as Chrome trace event JSON, loadable in chrome://tracing and Perfetto.
+        /// Each service gets its own track with a "waiting" slice until its dependencies were satisfied and a "start" slice for start().
+        [[nodiscard]] std::string toChromeTrace() const;
+
+    private:
+        [[nodiscard]] std::vector<ServiceStartupRecord> getCriticalPathLocked() const;
+
+        std::chrono::steady_clock::time_point _epoch;
+        std::vector<ServiceStartupRecord> _records{}; // sorted by service id, one contiguous block to not fragment the heap next to the services
+        mutable std::mutex _mutex{};
+        std::atomic<bool> _enabled{true};
+    };
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <vector>
+
+namespace Cppelix {
+    // Minimal fixed size pool, used by the DependencyManager to run work off the event loop thread.
+    // The destructor runs the tasks that are still queued before joining the threads.
+    class ThreadPool final {
+    public:
+        explicit ThreadPool(uint32_t threadCount);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+        ThreadPool& operator=(ThreadPool&&) = delete;
+
+        void submit(std::function<void()> task);
+
+        [[nodiscard]] uint32_t threadCount() const noexcept {
+            return static_cast<uint32_t>(_threads.size());
+        }
+
+    private:
+        void run();
+
+        std::vector<std::thread> _threads{};
+        std::deque<std::function<void()>> _tasks{};
+        std::mutex _mutex{};
+        std::condition_variable _wakeUp{};
+        bool _quit{false};
+    };
+}
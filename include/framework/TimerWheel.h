@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <optional>
+#include <vector>
+
+namespace Cppelix {
+    /// Hierarchical timing wheel. Time is counted in ticks of whatever unit the owner chooses, the DependencyManager uses microseconds.
+    /// Every level has 64 slots, a slot of level n spans 64^n ticks. A timer sits in the level of the highest 6 bit group in which its expiry
+    /// differs from the current tick and moves down a level whenever the wheel reaches its slot, so scheduling and cancelling are O(1)
+    /// and advancing skips empty slots through a bitmap per level instead of visiting every tick.
+    /// Periodic timers keep absolute deadlines, each one interval after the previous, so they don't drift. When advance() finds a timer
+    /// more than an interval late, the deadlines it missed are folded into one expiration instead of firing back to back.
+    /// A timer with slack fires at the first multiple of the largest power of two not above its slack, at or after its deadline. Timers with
+    /// deadlines close to each other then end up on the same tick and expire together.
+    /// Not thread safe. Callbacks may schedule and cancel timers, the firing one included.
+    class TimerWheel final {
+    public:
+        /// Called with the deadline that expired and the amount of later deadlines that already passed as well and were skipped
+        using Callback = std::function<void(uint64_t deadline, uint64_t missed)>;
+
+        explicit TimerWheel(uint64_t now = 0) noexcept : _current(now) {
+            _heads.fill(NIL);
+        }
+
+        TimerWheel(const TimerWheel&) = delete;
+        TimerWheel(TimerWheel&&) = delete;
+        TimerWheel& operator=(const TimerWheel&) = delete;
+        TimerWheel& operator=(TimerWheel&&) = delete;
+
+        /// A timer with an expiry that already passed fires on the next advance()
+        /// \param interval ticks between expirations after the first one, 0 for a one-shot timer
+        /// \param slack ticks the timer may fire late
+        /// \param owner anything but 0 makes the timer part of what cancelOwnedBy(owner) cancels
+        /// \return handle, never 0
+        uint64_t schedule(uint64_t expiry, uint64_t interval, Callback callback, uint64_t slack = 0, uint64_t owner = 0);
+
+        /// \return false if the timer already fired for the last time or was cancelled before
+        bool cancel(uint64_t handle) noexcept;
+
+        /// Cancel all timers scheduled with owner, visits every timer
+        /// \return amount of timers cancelled
+        size_t cancelOwnedBy(uint64_t owner) noexcept;
+
+        /// Periodic timers move their next deadline to one new interval after the previous deadline, or after they were scheduled.
+        /// From inside its own callback and for one-shot timers it applies from the expiration after the current one on.
+        /// \return false if the timer does not exist anymore
+        bool setInterval(uint64_t handle, uint64_t interval) noexcept;
+
+        /// Fire all timers expiring at or before now, earlier ticks first
+        /// \return amount of callbacks that ran
+        uint64_t advance(uint64_t now);
+
+        /// \return a tick at or before the next expiry: the wheel might only move a timer to a lower level at that tick. Empty without timers
+        [[nodiscard]] std::optional<uint64_t> nextWakeUp() const noexcept;
+
+        [[nodiscard]] uint64_t now() const noexcept {
+            return _current;
+        }
+
+        /// \return amount of scheduled timers
+        [[nodiscard]] size_t size() const noexcept {
+            return _size;
+        }
+
+    private:
+        static constexpr uint32_t SLOT_BITS = 6;
+        static constexpr uint32_t SLOTS = 1U << SLOT_BITS;
+        static constexpr uint32_t LEVELS = (64 + SLOT_BITS - 1) / SLOT_BITS;
+        static constexpr uint32_t DUE_LIST = LEVELS * SLOTS; // timers whose expiry passed, waiting for advance()
+        static constexpr uint32_t FIRING_LIST = DUE_LIST + 1; // timers taken out of their slot during advance()
+        static constexpr uint32_t NIL = UINT32_MAX;
+
+        struct Node final {
+            uint64_t expiry{0};
+            uint64_t previous{0}; // deadline before expiry, setInterval() counts from here
+            uint64_t interval{0};
+            uint64_t granularity{1}; // power of two the tick a timer fires at gets rounded up to, 1 without slack
+            uint64_t owner{0};
+            Callback callback{};
+            uint32_t prev{NIL};
+            uint32_t next{NIL};
+            uint32_t list{NIL}; // NIL while unused or while its callback runs
+            uint32_t generation{1};
+            bool firing{false};
+            bool cancelled{false};
+        };
+
+        struct Boundary final {
+            uint64_t tick;
+            uint32_t level;
+            uint32_t slot;
+        };
+
+        [[nodiscard]] static uint64_t handleOf(uint32_t index, uint32_t generation) noexcept {
+            return (static_cast<uint64_t>(generation) << 32U) | index;
+        }
+
+        /// \return tick at which a timer with this deadline fires
+        [[nodiscard]] static uint64_t dueTickOf(const Node &node) noexcept {
+            return (node.expiry + node.granularity - 1) & ~(node.granularity - 1);
+        }
+
+        /// \return amount of deadlines after deadline that are at or before now
+        [[nodiscard]] static uint64_t passedDeadlines(uint64_t deadline, uint64_t interval, uint64_t now) noexcept {
+            return interval == 0 || now <= deadline ? 0 : (now - deadline) / interval;
+        }
+
+        /// \return node of a live handle, nullptr for handles that were released
+        [[nodiscard]] Node* find(uint64_t handle) noexcept;
+        /// \return next tick after the current one at which a slot has to be processed
+        [[nodiscard]] std::optional<Boundary> nextBoundary() const noexcept;
+        void place(uint32_t index) noexcept;
+        void push(uint32_t list, uint32_t index) noexcept;
+        void unlink(uint32_t index) noexcept;
+        /// Move a whole list to the firing list
+        void take(uint32_t list) noexcept;
+        uint64_t fireTaken(uint64_t now);
+        void cancelAt(uint32_t index) noexcept;
+        void release(uint32_t index) noexcept;
+
+        // deque, so a callback scheduling a new timer doesn't move the node whose callback is running
+        std::deque<Node> _nodes{};
+        std::vector<uint32_t> _freeNodes{};
+        std::array<uint32_t, LEVELS * SLOTS + 2> _heads{};
+        std::array<uint64_t, LEVELS> _occupied{}; // bit n set when slot n of that level holds timers
+        uint64_t _current;
+        size_t _size{0};
+    };
+}
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+
+namespace Cppelix {
+    /// Time of a DependencyManager that simulates instead of waiting. It only moves forward through advanceTo() and advanceBy(), or when
+    /// the event loop runs out of events and jumps straight to its next timer or idle service timeout. With events pushed from the event
+    /// loop thread only, a run replays identically every time, however much time it simulates.
+    /// Values are steady_clock time points, so timer deadlines keep their type whichever clock a manager runs on.
+    class VirtualClock final {
+    public:
+        explicit VirtualClock(std::chrono::steady_clock::time_point start = {}) noexcept : _now(start.time_since_epoch().count()) {}
+
+        VirtualClock(const VirtualClock&) = delete;
+        VirtualClock(VirtualClock&&) = delete;
+        VirtualClock& operator=(const VirtualClock&) = delete;
+        VirtualClock& operator=(VirtualClock&&) = delete;
+
+        [[nodiscard]] std::chrono::steady_clock::time_point now() const noexcept {
+            return std::chrono::steady_clock::time_point{std::chrono::steady_clock::duration{_now.load(std::memory_order_acquire)}};
+        }
+
+        /// Does nothing when time is past time already, the clock never goes back
+        void advanceTo(std::chrono::steady_clock::time_point time) noexcept {
+            auto target = time.time_since_epoch().count();
+            auto current = _now.load(std::memory_order_relaxed);
+            while(target > current && !_now.compare_exchange_weak(current, target, std::memory_order_acq_rel)) {
+            }
+        }
+
+        void advanceBy(std::chrono::steady_clock::duration duration) noexcept {
+            if(duration.count() > 0) {
+                _now.fetch_add(duration.count(), std::memory_order_acq_rel);
+            }
+        }
+
+    private:
+        std::atomic<std::chrono::steady_clock::rep> _now;
+    };
+}
@@ -8,6 +8,9 @@
 namespace Cppelix {
     class EtcdService final : public IEtcdService, public Service {
     public:
+        // creating the grpc channel does not touch the DependencyManager
+        static constexpr bool parallelStartSafe = true;
+
         EtcdService(DependencyRegister &reg, CppelixProperties props);
         ~EtcdService() final = default;
 
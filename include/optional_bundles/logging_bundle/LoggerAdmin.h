@@ -56,7 +56,14 @@ namespace Cppelix {
         }
 
         void handleDependencyUndoRequest(ILogger *, DependencyUndoRequestEvent const *const evt) {
-            _loggers.erase(evt->originatingService);
+            auto logger = _loggers.find(evt->originatingService);
+            if(logger == end(_loggers)) {
+                return;
+            }
+
+            // the logger only serves the service that went away, leaving it installed would make every later ILogger request scan it
+            getManager()->template pushEvent<RemoveServiceEvent>(getServiceId(), logger->second->getServiceId());
+            _loggers.erase(logger);
         }
 
     private:
@@ -1,43 +1,53 @@
 #pragma once
 
+#include <deque>
 #include <unordered_map>
+#include <framework/Histogram.h>
 #include <framework/Service.h>
 #include <optional_bundles/logging_bundle/Logger.h>
 #include <optional_bundles/timer_bundle/TimerService.h>
 
 namespace Cppelix {
 
-    struct StatisticEntry {
-        StatisticEntry() = default;
-        StatisticEntry(uint64_t _timestamp, uint64_t _processingTimeRequired) : timestamp(_timestamp), processingTimeRequired(_processingTimeRequired) {}
-        uint64_t timestamp;
-        uint64_t processingTimeRequired;
+    /// Processing times of one event type, the histograms hold nanoseconds
+    struct EventTypeStatistics {
+        explicit EventTypeStatistics(std::string_view _name) : name(_name) {}
+        std::string_view name;
+        Histogram interval{}; // since the last averaging interval ended
+        Histogram total{}; // since the service started
     };
 
+    /// Processing time percentiles of one event type over one averaging interval, in nanoseconds
     struct AveragedStatisticEntry {
         AveragedStatisticEntry() = default;
-        AveragedStatisticEntry(uint64_t _timestamp, uint64_t _minProcessingTimeRequired, uint64_t _maxProcessingTimeRequired, uint64_t _avgProcessingTimeRequired, uint64_t _occurances) :
-            timestamp(_timestamp), minProcessingTimeRequired(_minProcessingTimeRequired), maxProcessingTimeRequired(_maxProcessingTimeRequired), avgProcessingTimeRequired(_avgProcessingTimeRequired),
-            occurances(_occurances) {}
-        uint64_t timestamp;
-        uint64_t minProcessingTimeRequired;
-        uint64_t maxProcessingTimeRequired;
-        uint64_t avgProcessingTimeRequired;
+        AveragedStatisticEntry(uint64_t _timestamp, uint64_t _occurances, uint64_t _p50, uint64_t _p90, uint64_t _p99, uint64_t _p999, uint64_t _max) :
+            timestamp(_timestamp), occurances(_occurances), p50(_p50), p90(_p90), p99(_p99), p999(_p999), max(_max) {}
+        uint64_t timestamp; // µs on the clock of the DependencyManager (steady_clock, or its VirtualClock) at the end of the interval
         uint64_t occurances;
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t max;
     };
 
     class IEventStatisticsService : public virtual IService {
     public:
-        static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+        static constexpr InterfaceVersion version = InterfaceVersion{2, 0, 0};
 
         ~IEventStatisticsService() override = default;
 
-        virtual const std::unordered_map<std::string_view, std::vector<StatisticEntry>>& getRecentStatistics() = 0;
-        virtual const std::unordered_map<std::string_view, std::vector<AveragedStatisticEntry>>& getAverageStatistics() = 0;
+        /// key = event type
+        virtual const std::unordered_map<uint64_t, EventTypeStatistics>& getRecentStatistics() = 0;
+        /// key = event type, oldest interval first. Keeps the last "MaxAveragedIntervals" intervals, 720 by default
+        virtual const std::unordered_map<uint64_t, std::deque<AveragedStatisticEntry>>& getAverageStatistics() = 0;
     };
 
+    /// With "ShowStatisticsOnStop" set it also enables the HandlerProfiler of its manager and logs the handlers that took the most time on stop
     class EventStatisticsService final : public IEventStatisticsService, public Service {
     public:
+        static constexpr size_t SLOWEST_HANDLERS_SHOWN = 10;
+
         EventStatisticsService(DependencyRegister &reg, CppelixProperties props);
         ~EventStatisticsService() final = default;
 
@@ -52,14 +62,15 @@ namespace Cppelix {
         bool start() final;
         bool stop() final;
 
-        const std::unordered_map<std::string_view, std::vector<StatisticEntry>>& getRecentStatistics() override;
-        const std::unordered_map<std::string_view, std::vector<AveragedStatisticEntry>>& getAverageStatistics() override;
+        const std::unordered_map<uint64_t, EventTypeStatistics>& getRecentStatistics() override;
+        const std::unordered_map<uint64_t, std::deque<AveragedStatisticEntry>>& getAverageStatistics() override;
     private:
-        std::unordered_map<std::string_view, std::vector<StatisticEntry>> _recentEventStatistics{};
-        std::unordered_map<std::string_view, std::vector<AveragedStatisticEntry>> _averagedStatistics{};
-        uint64_t _startProcessingTimestamp{};
+        std::unordered_map<uint64_t, EventTypeStatistics> _recentEventStatistics{};
+        std::unordered_map<uint64_t, std::deque<AveragedStatisticEntry>> _averagedStatistics{};
+        std::chrono::steady_clock::time_point _startProcessingTimestamp{};
         bool _showStatisticsOnStop{false};
         uint64_t _averagingIntervalMs{5000};
+        uint64_t _maxAveragedIntervals{720};
         std::unique_ptr<EventHandlerRegistration> _timerEventRegistration{nullptr};
         std::unique_ptr<EventInterceptorRegistration> _interceptorRegistration{nullptr};
         ILogger *_logger{nullptr};
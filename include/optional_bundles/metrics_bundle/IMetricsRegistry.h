@@ -0,0 +1,40 @@
+#pragma once
+
+#include <framework/Service.h>
+#include <framework/Histogram.h>
+#include <optional_bundles/metrics_bundle/Metrics.h>
+
+namespace Cppelix {
+    class PrometheusTextWriter;
+
+    /// Metrics any service can register, to be read by exporters. Registering the same name and labels again returns the metric registered
+    /// first, so services can look their metrics up instead of keeping them around. Metrics live as long as the registry.
+    /// Updating a metric never takes a lock and can be done from any thread, the registry only locks while registering and exporting.
+    class IMetricsRegistry : public virtual IService {
+    public:
+        static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+
+        ~IMetricsRegistry() override = default;
+
+        /// Names have to match [a-zA-Z_:][a-zA-Z0-9_:]*, throws std::runtime_error otherwise or when name is registered as another kind of metric
+        virtual Counter& counter(std::string_view name, std::string_view help, const MetricLabels &labels) = 0;
+        virtual Gauge& gauge(std::string_view name, std::string_view help, const MetricLabels &labels) = 0;
+        /// Exported as a summary with the 0.5, 0.9, 0.99 and 0.999 quantiles
+        virtual Histogram& histogram(std::string_view name, std::string_view help, const MetricLabels &labels) = 0;
+
+        /// Read every metric, the metrics keep being updated meanwhile
+        virtual void writeTo(PrometheusTextWriter &writer) const = 0;
+
+        Counter& counter(std::string_view name, std::string_view help) {
+            return counter(name, help, MetricLabels{});
+        }
+
+        Gauge& gauge(std::string_view name, std::string_view help) {
+            return gauge(name, help, MetricLabels{});
+        }
+
+        Histogram& histogram(std::string_view name, std::string_view help) {
+            return histogram(name, help, MetricLabels{});
+        }
+    };
+}
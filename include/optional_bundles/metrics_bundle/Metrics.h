@@ -0,0 +1,76 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Cppelix {
+    /// Label names and values of a metric, e.g. {{"connection", "backend"}}
+    using MetricLabels = std::vector<std::pair<std::string, std::string>>;
+
+    /// Monotonically increasing count. Every thread adds to a stripe of its own, so threads counting at the same time don't fight over
+    /// one cache line. Reading sums up the stripes.
+    class Counter final {
+    public:
+        static constexpr size_t STRIPES = 16;
+
+        Counter() = default;
+        Counter(const Counter&) = delete;
+        Counter(Counter&&) = delete;
+        Counter& operator=(const Counter&) = delete;
+        Counter& operator=(Counter&&) = delete;
+
+        void increment(uint64_t amount = 1) noexcept {
+            _stripes[stripeOfThisThread()].value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] uint64_t value() const noexcept {
+            uint64_t total = 0;
+            for(auto const &stripe : _stripes) {
+                total += stripe.value.load(std::memory_order_relaxed);
+            }
+            return total;
+        }
+
+    private:
+        struct alignas(64) Stripe final {
+            std::atomic<uint64_t> value{0};
+        };
+
+        [[nodiscard]] static size_t stripeOfThisThread() noexcept {
+            static std::atomic<size_t> nextStripe{0};
+            thread_local size_t stripe = nextStripe.fetch_add(1, std::memory_order_relaxed) % STRIPES;
+            return stripe;
+        }
+
+        std::array<Stripe, STRIPES> _stripes{};
+    };
+
+    /// Value that goes up and down, e.g. a queue length or the amount of open connections
+    class Gauge final {
+    public:
+        Gauge() = default;
+        Gauge(const Gauge&) = delete;
+        Gauge(Gauge&&) = delete;
+        Gauge& operator=(const Gauge&) = delete;
+        Gauge& operator=(Gauge&&) = delete;
+
+        void set(double value) noexcept {
+            _value.store(value, std::memory_order_relaxed);
+        }
+
+        void add(double amount) noexcept {
+            _value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        [[nodiscard]] double value() const noexcept {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+    private:
+        std::atomic<double> _value{0};
+    };
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <map>
+#include <memory>
+#include <mutex>
+#include <variant>
+#include <framework/Service.h>
+#include <optional_bundles/metrics_bundle/IMetricsRegistry.h>
+
+namespace Cppelix {
+    class MetricsRegistry final : public IMetricsRegistry, public Service {
+    public:
+        MetricsRegistry() = default;
+        ~MetricsRegistry() final = default;
+
+        bool start() final;
+        bool stop() final;
+
+        Counter& counter(std::string_view name, std::string_view help, const MetricLabels &labels) final;
+        Gauge& gauge(std::string_view name, std::string_view help, const MetricLabels &labels) final;
+        Histogram& histogram(std::string_view name, std::string_view help, const MetricLabels &labels) final;
+
+        void writeTo(PrometheusTextWriter &writer) const final;
+
+        using IMetricsRegistry::counter;
+        using IMetricsRegistry::gauge;
+        using IMetricsRegistry::histogram;
+
+    private:
+        using Metric = std::variant<std::unique_ptr<Counter>, std::unique_ptr<Gauge>, std::unique_ptr<Histogram>>;
+
+        struct Family final {
+            std::string help;
+            size_t kind; // index into Metric of all metrics of the family
+            std::map<MetricLabels, Metric> metrics{};
+        };
+
+        /// \return metric of kind T for name and labels, registered now if it wasn't before
+        template <typename T>
+        T& findOrAdd(std::string_view name, std::string_view help, const MetricLabels &labels);
+
+        std::map<std::string, Family, std::less<>> _families{}; // ordered, so exports list metrics in the same order every time
+        mutable std::mutex _mutex{};
+    };
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <framework/Service.h>
+#include <optional_bundles/logging_bundle/Logger.h>
+#include <optional_bundles/metrics_bundle/IMetricsRegistry.h>
+#include <optional_bundles/network_bundle/tcp/HttpListener.h>
+
+namespace Cppelix {
+    class IPrometheusExporter : public virtual IService {
+    public:
+        static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+
+        ~IPrometheusExporter() override = default;
+
+        /// \return port the endpoint listens on, 0 while not started
+        [[nodiscard]] virtual uint16_t getPort() const = 0;
+    };
+
+    /// Serves the metrics of the registry, together with the event queue and handler metrics of its DependencyManager, on GET /metrics.
+    /// Requests are answered on a thread of the exporter from atomics and snapshots, a busy or blocked event loop doesn't hold up scrapes.
+    /// Properties: "Address" (std::string, default 0.0.0.0) and "Port" (uint16_t, default 9464, 0 picks a free port).
+    class PrometheusExporter final : public IPrometheusExporter, public Service {
+    public:
+        static constexpr uint16_t DEFAULT_PORT = 9464;
+
+        PrometheusExporter(DependencyRegister &reg, CppelixProperties props);
+        ~PrometheusExporter() final = default;
+
+        bool start() final;
+        bool stop() final;
+
+        void addDependencyInstance(ILogger *logger);
+        void removeDependencyInstance(ILogger *logger);
+
+        void addDependencyInstance(IMetricsRegistry *registry);
+        void removeDependencyInstance(IMetricsRegistry *registry);
+
+        [[nodiscard]] uint16_t getPort() const final;
+
+    private:
+        /// \return body of a scrape, runs on the listener thread
+        [[nodiscard]] std::string scrape();
+
+        std::unique_ptr<HttpListener> _listener{};
+        std::atomic<IMetricsRegistry*> _registry{nullptr};
+        ILogger *_logger{nullptr};
+    };
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <framework/Histogram.h>
+#include <optional_bundles/metrics_bundle/Metrics.h>
+
+namespace Cppelix {
+    enum class MetricType {
+        COUNTER,
+        GAUGE,
+        SUMMARY
+    };
+
+    /// Builds a scrape response in the Prometheus text exposition format, version 0.0.4. Samples of a family have to follow its family() call.
+    class PrometheusTextWriter final {
+    public:
+        static constexpr std::string_view CONTENT_TYPE = "text/plain; version=0.0.4; charset=utf-8";
+
+        /// Write the HELP and TYPE lines of a family, only the first time name is passed
+        void family(std::string_view name, MetricType type, std::string_view help);
+
+        void sample(std::string_view name, const MetricLabels &labels, uint64_t value);
+        void sample(std::string_view name, const MetricLabels &labels, double value);
+
+        /// Quantile samples plus name_sum and name_count
+        void summary(std::string_view name, const MetricLabels &labels, const HistogramSummary &summary);
+
+        [[nodiscard]] const std::string& text() const noexcept {
+            return _text;
+        }
+
+        /// \return true if name matches [a-zA-Z_:][a-zA-Z0-9_:]*
+        [[nodiscard]] static bool validName(std::string_view name) noexcept;
+
+    private:
+        void writeSeries(std::string_view name, const MetricLabels &labels, std::string_view extraLabel = {}, std::string_view extraValue = {});
+
+        std::string _text{};
+        std::unordered_set<std::string> _families{};
+    };
+}
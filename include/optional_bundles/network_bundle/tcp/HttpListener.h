@@ -0,0 +1,73 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <thread>
+
+namespace Cppelix {
+    struct HttpResponse final {
+        uint16_t status{200};
+        std::string contentType{"text/plain; charset=utf-8"};
+        std::string body{};
+    };
+
+    /// Minimal HTTP server on a thread of its own, for scrape and debug endpoints that have to keep answering while the event loop is busy.
+    /// Serves up to MAX_CONNECTIONS connections at once with non-blocking sockets, one request per connection. Each connection gets
+    /// REQUEST_TIMEOUT from accept to the last byte of its response, so clients trickling in their request can't hold up others.
+    /// The handler runs on the listening thread, one request at a time.
+    class HttpListener final {
+    public:
+        static constexpr size_t MAX_CONNECTIONS = 32; // further clients wait in the listen backlog
+        static constexpr std::chrono::milliseconds REQUEST_TIMEOUT{2'000};
+
+        /// Gets the method and the path without query string of every request
+        using Handler = std::function<HttpResponse(std::string_view method, std::string_view path)>;
+
+        explicit HttpListener(Handler handler) noexcept : _handler(std::move(handler)) {}
+        ~HttpListener();
+
+        HttpListener(const HttpListener&) = delete;
+        HttpListener(HttpListener&&) = delete;
+        HttpListener& operator=(const HttpListener&) = delete;
+        HttpListener& operator=(HttpListener&&) = delete;
+
+        /// Bind and start the listening thread, throws std::runtime_error when binding fails. Stops a previous listen() first.
+        /// \param address IPv4 address to bind to, 0.0.0.0 for all interfaces
+        /// \param port 0 to let the kernel pick one, see port()
+        void listen(const std::string &address, uint16_t port);
+
+        /// Close the socket and join the listening thread. A handler already running is finished first, connections still open are closed.
+        void stop();
+
+        /// \return port bound to, 0 before listen()
+        [[nodiscard]] uint16_t port() const noexcept {
+            return _port;
+        }
+
+    private:
+        struct Connection final {
+            int socket;
+            std::chrono::steady_clock::time_point deadline;
+            std::string request{};
+            std::string response{}; // empty until the request is complete
+            size_t sent{0};
+        };
+
+        void run();
+        /// \return false once the connection is done with, answered or broken
+        bool receive(Connection &connection);
+        /// \return false once the connection is done with, answered or broken
+        bool send(Connection &connection);
+        [[nodiscard]] std::string respond(std::string_view request);
+
+        Handler _handler;
+        int _socket{-1};
+        uint16_t _port{0};
+        std::atomic<bool> _quit{false};
+        std::thread _thread{};
+    };
+}
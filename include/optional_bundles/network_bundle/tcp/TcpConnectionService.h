@@ -7,6 +7,11 @@
 namespace Cppelix {
     class TcpConnectionService final : public IConnectionService, public Service {
     public:
+        // connecting may block, better done on the lifecycle thread pool
+        static constexpr bool parallelStartSafe = true;
+        // joining the listen thread can take a while
+        static constexpr bool parallelStopSafe = true;
+
         TcpConnectionService(DependencyRegister &reg, CppelixProperties props);
         ~TcpConnectionService() final = default;
 
@@ -8,6 +8,11 @@
 namespace Cppelix {
     class TcpHostService final : public IHostService, public Service {
     public:
+        // binding only uses pushEvent, which is thread safe
+        static constexpr bool parallelStartSafe = true;
+        // joining the listen thread can take a while
+        static constexpr bool parallelStopSafe = true;
+
         TcpHostService(DependencyRegister &reg, CppelixProperties props);
         ~TcpHostService() final = default;
 
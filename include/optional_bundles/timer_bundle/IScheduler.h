@@ -0,0 +1,49 @@
+#pragma once
+
+#include "framework/Service.h"
+#include <chrono>
+#include <cstdint>
+#include <functional>
+
+namespace Cppelix {
+    /// Identifies one timer of an IScheduler. Plain value, dropping it does not cancel the timer.
+    struct TimerHandle final {
+        uint64_t id{0};
+
+        /// \return false for a default constructed handle, true even after its timer fired or got cancelled
+        [[nodiscard]] explicit operator bool() const noexcept {
+            return id != 0;
+        }
+    };
+
+    /// Timeouts and periodic callbacks that don't need a service of their own, e.g. a deadline per request or an idle timeout per connection.
+    /// Callbacks run on the event loop thread of the scheduler's DependencyManager. A service has to cancel its timers before it goes away,
+    /// stopping the scheduler cancels all of them.
+    struct IScheduler : virtual public IService {
+        static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+
+        /// Called with the deadline that expired and the amount of deadlines after it that passed as well. Those only occur for periodic
+        /// timers and don't get a call of their own.
+        using Callback = std::function<void(std::chrono::steady_clock::time_point deadline, uint64_t missedTicks)>;
+
+        /// Run callback once, delay from now
+        /// \param slack how much later than the deadline the callback may run, so timers with nearby deadlines can share one wakeup
+        virtual TimerHandle scheduleOnce(std::chrono::nanoseconds delay, Callback callback, std::chrono::nanoseconds slack) = 0;
+
+        /// Run callback every interval, starting one interval from now
+        /// \param slack see scheduleOnce(), capped to interval
+        virtual TimerHandle scheduleEvery(std::chrono::nanoseconds interval, Callback callback, std::chrono::nanoseconds slack) = 0;
+
+        /// Safe to call with handles of timers that fired or got cancelled already
+        /// \return true if the timer was still pending
+        virtual bool cancel(TimerHandle handle) = 0;
+
+        TimerHandle scheduleOnce(std::chrono::nanoseconds delay, Callback callback) {
+            return scheduleOnce(delay, std::move(callback), std::chrono::nanoseconds{0});
+        }
+
+        TimerHandle scheduleEvery(std::chrono::nanoseconds interval, Callback callback) {
+            return scheduleEvery(interval, std::move(callback), std::chrono::nanoseconds{0});
+        }
+    };
+}
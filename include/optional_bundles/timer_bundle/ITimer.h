@@ -1,18 +1,25 @@
 #pragma once
 
 #include "framework/Events.h"
+#include "framework/Histogram.h"
+#include <chrono>
 
 namespace Cppelix {
     struct TimerEvent final : public Event {
-        TimerEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority) noexcept : Event(TYPE, NAME, _id, _originatingService, _priority) {}
+        TimerEvent(uint64_t _id, uint64_t _originatingService, uint64_t _priority, std::chrono::steady_clock::time_point _deadline = {}, uint64_t _missedTicks = 0) noexcept :
+                Event(TYPE, NAME, _id, _originatingService, _priority), deadline(_deadline), missedTicks(_missedTicks) {}
         ~TimerEvent() final = default;
 
+        /// When the tick was due
+        const std::chrono::steady_clock::time_point deadline;
+        /// Ticks after this one that had passed as well by the time it fired, they don't get an event of their own
+        const uint64_t missedTicks;
         static constexpr uint64_t TYPE = typeNameHash<TimerEvent>();
         static constexpr std::string_view NAME= typeName<TimerEvent>();
     };
 
     struct ITimer : virtual public IService {
-        static constexpr InterfaceVersion version = InterfaceVersion{1, 0, 0};
+        static constexpr InterfaceVersion version = InterfaceVersion{1, 1, 0};
 
         virtual void startTimer() = 0;
         virtual void stopTimer() = 0;
@@ -21,9 +28,18 @@ namespace Cppelix {
         virtual void setPriority(uint64_t priority) = 0;
         virtual uint64_t getPriority() const = 0;
 
+        /// \return ticks skipped because the event loop was late, over the lifetime of the timer
+        [[nodiscard]] virtual uint64_t getMissedTicks() const = 0;
+
+        /// Record the lateness of every tick from now on, in nanoseconds from its deadline until its TimerEvent got pushed
+        virtual void enableLatenessHistogram() = 0;
+
+        /// \return nullptr unless enableLatenessHistogram() was called
+        [[nodiscard]] virtual const Histogram* getLatenessHistogram() const = 0;
+
         template <typename Dur>
         void setChronoInterval(Dur duration) {
             setInterval(std::chrono::nanoseconds(duration).count());
         }
     };
-}
\ No newline at end of file
+}
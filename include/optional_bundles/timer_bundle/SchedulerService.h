@@ -0,0 +1,41 @@
+#pragma once
+
+#include "framework/Common.h"
+#include "framework/Service.h"
+#include "framework/DependencyManager.h"
+#include "IScheduler.h"
+
+namespace Cppelix {
+
+    /// IScheduler on the timing wheel of its DependencyManager. A timer costs a wheel entry and its callback, not a service, so one scheduler
+    /// per manager serves any amount of timeouts.
+    class Scheduler final : public IScheduler, public Service {
+    public:
+        Scheduler() = default;
+        ~Scheduler() final = default;
+
+        bool start() final {
+            return true;
+        }
+
+        bool stop() final {
+            getManager()->cancelTimersOf(getServiceId());
+            return true;
+        }
+
+        TimerHandle scheduleOnce(std::chrono::nanoseconds delay, Callback callback, std::chrono::nanoseconds slack) final {
+            return TimerHandle{getManager()->scheduleTimer(delay, std::chrono::nanoseconds{0}, std::move(callback), slack, getServiceId())};
+        }
+
+        TimerHandle scheduleEvery(std::chrono::nanoseconds interval, Callback callback, std::chrono::nanoseconds slack) final {
+            return TimerHandle{getManager()->scheduleTimer(interval, interval, std::move(callback), slack, getServiceId())};
+        }
+
+        bool cancel(TimerHandle handle) final {
+            return handle && getManager()->cancelTimer(handle.id);
+        }
+
+        using IScheduler::scheduleOnce;
+        using IScheduler::scheduleEvery;
+    };
+}
@@ -3,17 +3,19 @@
 #include "framework/Common.h"
 #include "framework/Service.h"
 #include "framework/DependencyManager.h"
+#include <algorithm>
 #include <chrono>
-#include <thread>
+#include <mutex>
 #include "ITimer.h"
 
 namespace Cppelix {
 
-    // Rather shoddy implementation, setting the interval does not reset the insertEventLoop function and the sleep_for is sketchy at best.
+    /// Pushes a TimerEvent every interval, with deadlines counted from startTimer() so ticks don't drift.
+    /// The timer lives in the timing wheel of its DependencyManager's event loop, any amount of timers share that one thread.
+    /// When the loop falls more than an interval behind, the ticks it missed are counted and folded into the next TimerEvent.
     class Timer final : public ITimer, public Service {
     public:
-        Timer() : _intervalNanosec(0), _eventInsertionThread(nullptr), _quit(true), _priority(INTERNAL_EVENT_PRIORITY) {
-        }
+        Timer() = default;
 
         ~Timer() final {
             stopTimer();
@@ -29,26 +31,42 @@ namespace Cppelix {
         }
 
         void startTimer() final {
-            bool expected = true;
-            if(_quit.compare_exchange_strong(expected, false)) {
-                _eventInsertionThread = std::make_unique<std::thread>([this]() { this->insertEventLoop(); });
+            std::lock_guard lg(_mutex);
+            if(_timerHandle != 0) {
+                return;
             }
+
+            auto interval = std::chrono::nanoseconds(_intervalNanosec);
+            _timerHandle = getManager()->scheduleTimer(interval, interval, [this](std::chrono::steady_clock::time_point deadline, uint64_t missedTicks) {
+                if(auto *histogram = _latenessHistogram.load(std::memory_order_acquire); histogram != nullptr) {
+                    histogram->record(static_cast<uint64_t>(std::max<int64_t>(0, (getManager()->now() - deadline).count())));
+                }
+                _missedTicks.fetch_add(missedTicks, std::memory_order_relaxed);
+                getManager()->pushPrioritisedEvent<TimerEvent>(getServiceId(), _priority.load(std::memory_order_acquire), deadline, missedTicks);
+            });
         }
 
         void stopTimer() final {
-            bool expected = false;
-            if(_quit.compare_exchange_strong(expected, true)) {
-                _eventInsertionThread->join();
-                _eventInsertionThread = nullptr;
+            std::lock_guard lg(_mutex);
+            if(_timerHandle == 0) {
+                return;
             }
+
+            getManager()->cancelTimer(_timerHandle);
+            _timerHandle = 0;
         }
 
         bool running() const final {
-            return !_quit;
+            std::lock_guard lg(_mutex);
+            return _timerHandle != 0;
         };
 
         void setInterval(uint64_t nanoseconds) final {
+            std::lock_guard lg(_mutex);
             _intervalNanosec = nanoseconds;
+            if(_timerHandle != 0) {
+                getManager()->setTimerInterval(_timerHandle, std::chrono::nanoseconds(nanoseconds));
+            }
         }
 
 
@@ -60,24 +78,29 @@ namespace Cppelix {
             return _priority.load(std::memory_order_acquire);
         }
 
-    private:
-        void insertEventLoop() {
-            auto now = std::chrono::system_clock::now();
-            auto next = now + std::chrono::nanoseconds(_intervalNanosec.load(std::memory_order_acquire));
-            while(!_quit.load(std::memory_order_acquire)) {
-                while(now < next && !_quit.load(std::memory_order_acquire)) {
-                    std::this_thread::sleep_for(std::chrono::nanoseconds(_intervalNanosec.load(std::memory_order_acquire)/10));
-                    now = std::chrono::system_clock::now();
-                }
-                getManager()->pushPrioritisedEvent<TimerEvent>(getServiceId(), _priority.load(std::memory_order_acquire));
+        uint64_t getMissedTicks() const final {
+            return _missedTicks.load(std::memory_order_relaxed);
+        }
 
-                next += std::chrono::nanoseconds(_intervalNanosec.load(std::memory_order_acquire));
+        void enableLatenessHistogram() final {
+            std::lock_guard lg(_mutex);
+            if(!_latenessHistogramStorage) {
+                _latenessHistogramStorage = std::make_unique<Histogram>();
+                _latenessHistogram.store(_latenessHistogramStorage.get(), std::memory_order_release);
             }
         }
 
-        std::atomic<uint64_t> _intervalNanosec;
-        std::unique_ptr<std::thread> _eventInsertionThread;
-        std::atomic<bool> _quit;
-        std::atomic<uint64_t> _priority;
+        const Histogram* getLatenessHistogram() const final {
+            return _latenessHistogram.load(std::memory_order_acquire);
+        }
+
+    private:
+        uint64_t _intervalNanosec{0};
+        uint64_t _timerHandle{0}; // 0 while stopped
+        std::atomic<uint64_t> _priority{INTERNAL_EVENT_PRIORITY};
+        std::atomic<uint64_t> _missedTicks{0};
+        std::unique_ptr<Histogram> _latenessHistogramStorage{};
+        std::atomic<Histogram*> _latenessHistogram{nullptr}; // read by the timer callback without taking _mutex
+        mutable std::mutex _mutex{};
     };
-}
\ No newline at end of file
+}
@@ -3,6 +3,8 @@
 #include "framework/DependencyManager.h"
 #include "framework/Callback.h"
 #include "framework/CommunicationChannel.h"
+#include <algorithm>
+#include <sys/prctl.h>
 
 #if !__has_include(<spdlog/spdlog.h>)
 #define SPDLOG_DEBUG(x)
@@ -17,20 +19,76 @@ void on_sigint([[maybe_unused]] int sig) {
     sigintQuit.store(true, std::memory_order_release);
 }
 
+namespace {
+    [[nodiscard]] const Cppelix::Filter* filterOf(const Cppelix::ILifecycleManager &manager) {
+        auto const &properties = *manager.getProperties();
+        auto filterProp = properties.find("Filter");
+        if (filterProp == end(properties)) {
+            return nullptr;
+        }
+        return std::any_cast<const Cppelix::Filter>(&filterProp->second);
+    }
+
+    [[nodiscard]] bool hasDependents(const Cppelix::ServiceIndex &index, const Cppelix::ServiceRegistry &services, const std::shared_ptr<Cppelix::ILifecycleManager> &provider) {
+        const Cppelix::Filter *filter = filterOf(*provider);
+
+        std::vector<uint64_t> dependentIds;
+        index.findDependents(*provider, filter, dependentIds);
+        return std::any_of(begin(dependentIds), end(dependentIds), [&](uint64_t dependentId) {
+            return filter == nullptr || filter->compareTo(services.find(dependentId)->second);
+        });
+    }
+
+    /// Shutdown goes on when a service throws from stop(), the throw counts as a failed stop
+    [[nodiscard]] bool runStopNoThrow(Cppelix::ILifecycleManager &manager) noexcept {
+        try {
+            return manager.runStop();
+        } catch (...) {
+            return false;
+        }
+    }
+}
+
 void Cppelix::DependencyManager::start() {
     assert(_logger != nullptr);
     LOG_DEBUG(_logger, "starting dm");
 
     ::signal(SIGINT, on_sigint);
 
+    if(_timerSlack) {
+        // 0 would reset the slack to the default
+        ::prctl(PR_SET_TIMERSLACK, static_cast<unsigned long>(std::max<int64_t>(_timerSlack->count(), 1)), 0, 0, 0);
+    }
+
     while(!_quit.load(std::memory_order_acquire)) {
         _quit.store(sigintQuit.load(std::memory_order_acquire), std::memory_order_release);
+
+        if(_idleServiceFactoryCount > 0) {
+            reclaimIdleServices();
+        }
+
+        if(timersDue()) {
+            fireTimers();
+        }
+
         std::unique_lock lck(_eventQueueMutex);
         while (!_quit.load(std::memory_order_acquire) && !_eventQueue.empty()) {
             auto evtNode = _eventQueue.extract(_eventQueue.begin());
             lck.unlock();
+            _queueMetrics.dequeued(evtNode.key());
             _quit.store(sigintQuit.load(std::memory_order_acquire), std::memory_order_release);
 
+            if(holdUntilParallelStartsFinish(evtNode.mapped().get())) {
+                // counted as dispatched once it is released
+                _eventsWaitingOnParallelStarts.emplace_back(std::move(evtNode.mapped()));
+                lck.lock();
+                continue;
+            }
+            _queueMetrics.dispatched(evtNode.key(), evtNode.mapped().getEnqueuedAt());
+
+            auto *dispatchedEvt = evtNode.mapped().get();
+            _flightRecorder.begin(dispatchedEvt->type, dispatchedEvt->name, dispatchedEvt->id, dispatchedEvt->originatingService, dispatchedEvt->priority, evtNode.mapped().getEnqueuedAt());
+            EventTracer::DispatchScope traceScope(_id, dispatchedEvt, evtNode.mapped().getTrace());
             bool allowProcessing = true;
             auto interceptorsForAllEvents = _eventInterceptors.find(0);
             auto interceptorsForEvent = _eventInterceptors.find(evtNode.mapped().getType());
@@ -57,13 +115,19 @@ void Cppelix::DependencyManager::start() {
                         SPDLOG_DEBUG("DependencyOnlineEvent");
                         auto depOnlineEvt = static_cast<DependencyOnlineEvent *>(evtNode.mapped().get());
 
-                        auto filterProp = depOnlineEvt->manager->getProperties()->find("Filter");
-                        const Filter *filter = nullptr;
-                        if (filterProp != end(*depOnlineEvt->manager->getProperties())) {
-                            filter = std::any_cast<const Filter>(&filterProp->second);
+                        auto replacement = _pendingReplacements.find(depOnlineEvt->manager->serviceId());
+                        if (replacement != end(_pendingReplacements)) {
+                            auto replacedServiceId = replacement->second;
+                            _pendingReplacements.erase(replacement);
+                            swapProvider(replacedServiceId, depOnlineEvt->manager);
                         }
 
-                        for (auto &[key, possibleDependentLifecycleManager] : _services) {
+                        const Filter *filter = filterOf(*depOnlineEvt->manager);
+
+                        std::vector<uint64_t> dependentIds;
+                        _serviceIndex.findDependents(*depOnlineEvt->manager, filter, dependentIds);
+                        for (auto dependentId : dependentIds) {
+                            auto possibleDependentLifecycleManager = _services.find(dependentId)->second;
                             if (filter != nullptr && !filter->compareTo(possibleDependentLifecycleManager)) {
                                 continue;
                             }
@@ -78,13 +142,12 @@ void Cppelix::DependencyManager::start() {
                         SPDLOG_DEBUG("DependencyOfflineEvent");
                         auto depOfflineEvt = static_cast<DependencyOfflineEvent *>(evtNode.mapped().get());
 
-                        auto filterProp = depOfflineEvt->manager->getProperties()->find("Filter");
-                        const Filter *filter = nullptr;
-                        if (filterProp != end(*depOfflineEvt->manager->getProperties())) {
-                            filter = std::any_cast<const Filter>(&filterProp->second);
-                        }
+                        const Filter *filter = filterOf(*depOfflineEvt->manager);
 
-                        for (auto &[key, possibleDependentLifecycleManager] : _services) {
+                        std::vector<uint64_t> dependentIds;
+                        _serviceIndex.findDependents(*depOfflineEvt->manager, filter, dependentIds);
+                        for (auto dependentId : dependentIds) {
+                            auto possibleDependentLifecycleManager = _services.find(dependentId)->second;
                             if (filter != nullptr && !filter->compareTo(possibleDependentLifecycleManager)) {
                                 continue;
                             }
@@ -98,53 +161,21 @@ void Cppelix::DependencyManager::start() {
                     case DependencyRequestEvent::TYPE: {
                         auto depReqEvt = static_cast<DependencyRequestEvent *>(evtNode.mapped().get());
 
-                        auto trackers = _dependencyRequestTrackers.find(depReqEvt->dependency.interfaceNameHash);
-                        if (trackers == end(_dependencyRequestTrackers)) {
-                            break;
-                        }
-
-                        for (DependencyTrackerInfo &info : trackers->second) {
-                            info.trackFunc(depReqEvt);
-                        }
+                        instantiateServiceFactoriesFor(depReqEvt->dependency.interfaceNameHash);
+                        callDependencyTrackers(depReqEvt->dependency.interfaceNameHash, depReqEvt, &DependencyTrackerInfo::requestFunc);
                     }
                         break;
                     case DependencyUndoRequestEvent::TYPE: {
                         auto depUndoReqEvt = static_cast<DependencyUndoRequestEvent *>(evtNode.mapped().get());
 
-                        auto trackers = _dependencyUndoRequestTrackers.find(depUndoReqEvt->dependency.interfaceNameHash);
-                        if (trackers == end(_dependencyUndoRequestTrackers)) {
-                            break;
-                        }
-
-                        for (DependencyTrackerInfo &info : trackers->second) {
-                            info.trackFunc(depUndoReqEvt);
-                        }
+                        markIdleServiceFactories(depUndoReqEvt->dependency.interfaceNameHash);
+                        callDependencyTrackers(depUndoReqEvt->dependency.interfaceNameHash, depUndoReqEvt, &DependencyTrackerInfo::undoRequestFunc);
                     }
                         break;
                     case QuitEvent::TYPE: {
                         SPDLOG_DEBUG("QuitEvent");
-                        auto _quitEvt = static_cast<QuitEvent *>(evtNode.mapped().get());
-                        if (!_quitEvt->dependenciesStopped) {
-                            for (auto &[key, possibleManager] : _services) {
-                                pushEventInternal<StopServiceEvent>(_quitEvt->originatingService, INTERNAL_EVENT_PRIORITY, possibleManager->serviceId());
-                            }
-
-                            pushEventInternal<QuitEvent>(_quitEvt->originatingService, INTERNAL_EVENT_PRIORITY + 1, true);
-                        } else {
-                            bool canFinally_quit = true;
-                            for (auto &[key, manager] : _services) {
-                                if (manager->getServiceState() != ServiceState::INSTALLED) {
-                                    canFinally_quit = false;
-                                    break;
-                                }
-                            }
-
-                            if (canFinally_quit) {
-                                _quit.store(true, std::memory_order_release);
-                            } else {
-                                pushEventInternal<QuitEvent>(_quitEvt->originatingService, INTERNAL_EVENT_PRIORITY + 1, false);
-                            }
-                        }
+                        stopAllServices();
+                        _quit.store(true, std::memory_order_release);
                     }
                         break;
                     case StopServiceEvent::TYPE: {
@@ -159,7 +190,7 @@ void Cppelix::DependencyManager::start() {
                             break;
                         }
 
-                        auto &toStopService = toStopServiceIt->second;
+                        auto toStopService = toStopServiceIt->second;
                         if (stopServiceEvt->dependenciesStopped) {
                             if (toStopService->getServiceState() == ServiceState::ACTIVE && !toStopService->stop()) {
                                 LOG_ERROR(_logger, "Couldn't stop service {}: {} but all dependencies stopped", stopServiceEvt->serviceId,
@@ -186,7 +217,7 @@ void Cppelix::DependencyManager::start() {
                             break;
                         }
 
-                        auto &toRemoveService = toRemoveServiceIt->second;
+                        auto toRemoveService = toRemoveServiceIt->second;
                         if (removeServiceEvt->dependenciesStopped) {
                             if (toRemoveService->getServiceState() == ServiceState::ACTIVE && !toRemoveService->stop()) {
                                 LOG_ERROR(_logger, "Couldn't remove service {}: {} but all dependencies stopped", removeServiceEvt->serviceId,
@@ -194,7 +225,11 @@ void Cppelix::DependencyManager::start() {
                                 handleEventError(removeServiceEvt);
                             } else {
                                 handleEventCompletion(removeServiceEvt);
-                                _services.erase(toRemoveServiceIt);
+                                _pendingReplacements.erase(removeServiceEvt->serviceId);
+                                _startupProfiler.serviceRemoved(removeServiceEvt->serviceId);
+                                _handlerProfiler.serviceRemoved(removeServiceEvt->serviceId);
+                                _serviceIndex.remove(toRemoveService);
+                                _services.erase(removeServiceEvt->serviceId);
                             }
                         } else {
                             pushEventInternal<DependencyOfflineEvent>(0, INTERNAL_EVENT_PRIORITY, toRemoveService);
@@ -206,6 +241,7 @@ void Cppelix::DependencyManager::start() {
                     case StartServiceEvent::TYPE: {
                         SPDLOG_DEBUG("StartServiceEvent");
                         auto startServiceEvt = static_cast<StartServiceEvent *>(evtNode.mapped().get());
+                        _queuedStarts.erase(startServiceEvt->serviceId);
 
                         auto toStartServiceIt = _services.find(startServiceEvt->serviceId);
 
@@ -215,9 +251,21 @@ void Cppelix::DependencyManager::start() {
                             break;
                         }
 
-                        auto &toStartService = toStartServiceIt->second;
+                        // copy, start() may add services and move the registry entries
+                        auto toStartService = toStartServiceIt->second;
                         if(toStartService->getServiceState() == ServiceState::ACTIVE) {
                             handleEventCompletion(startServiceEvt);
+                        } else if (_lifecycleThreadPool != nullptr && toStartService->parallelStartSafe()) {
+                            auto parallelStart = _parallelStarts.find(startServiceEvt->serviceId);
+                            if(parallelStart != end(_parallelStarts)) {
+                                // start() is still running on the thread pool, try again when it failed
+                                parallelStart->second.startRequestedAgain = true;
+                            } else if(toStartService->prepareStart()) {
+                                startServiceInThreadPool(toStartService, startServiceEvt->originatingService);
+                            } else {
+                                LOG_TRACE(_logger, "Couldn't start service {}: {}", startServiceEvt->serviceId, toStartService->implementationName());
+                                handleEventError(startServiceEvt);
+                            }
                         } else if (!toStartService->start()) {
                             LOG_TRACE(_logger, "Couldn't start service {}: {}", startServiceEvt->serviceId, toStartService->implementationName());
                             handleEventError(startServiceEvt);
@@ -227,6 +275,41 @@ void Cppelix::DependencyManager::start() {
                         }
                     }
                         break;
+                    case StartServiceCompletedEvent::TYPE: {
+                        SPDLOG_DEBUG("StartServiceCompletedEvent");
+                        auto startCompletedEvt = static_cast<StartServiceCompletedEvent *>(evtNode.mapped().get());
+                        auto serviceId = startCompletedEvt->manager->serviceId();
+
+                        auto parallelStart = _parallelStarts.extract(serviceId);
+                        auto startedService = _services.find(serviceId);
+                        bool started = startCompletedEvt->manager->finishStart(startCompletedEvt->started);
+                        StartServiceEvent startServiceEvt{0, parallelStart.mapped().originatingServiceId, INTERNAL_EVENT_PRIORITY, serviceId};
+
+                        if(startedService == end(_services) || startedService->second != startCompletedEvt->manager) {
+                            // removed while starting
+                            if(started) {
+                                (void)startCompletedEvt->manager->stop();
+                            }
+                        } else if(started) {
+                            pushEventInternal<DependencyOnlineEvent>(0, INTERNAL_EVENT_PRIORITY, startCompletedEvt->manager);
+                            handleEventCompletion(&startServiceEvt);
+                        } else {
+                            LOG_TRACE(_logger, "Couldn't start service {}: {}", serviceId, startCompletedEvt->manager->implementationName());
+                            handleEventError(&startServiceEvt);
+                            if(parallelStart.mapped().startRequestedAgain) {
+                                requestStart(serviceId, parallelStart.mapped().originatingServiceId);
+                            }
+                        }
+
+                        if(!_eventsWaitingOnParallelStarts.empty()) {
+                            releaseEventsWaitingOnParallelStarts();
+                        }
+
+                        if(startCompletedEvt->exception) {
+                            std::rethrow_exception(startCompletedEvt->exception);
+                        }
+                    }
+                        break;
                     case DoWorkEvent::TYPE: {
                         SPDLOG_DEBUG("DoWorkEvent");
                         handleEventCompletion(evtNode.mapped().get());
@@ -270,18 +353,22 @@ void Cppelix::DependencyManager::start() {
                         SPDLOG_DEBUG("RemoveTrackerEvent");
                         auto removeTrackerEvt = static_cast<RemoveTrackerEvent *>(evtNode.mapped().get());
 
-                        _dependencyRequestTrackers.erase(removeTrackerEvt->interfaceNameHash);
-                        _dependencyUndoRequestTrackers.erase(removeTrackerEvt->interfaceNameHash);
+                        removeDependencyTracker(removeTrackerEvt->interfaceNameHash, removeTrackerEvt->trackerId);
                     }
                         break;
                     case ContinuableEvent::TYPE: {
                         SPDLOG_DEBUG("ContinuableEvent");
                         auto continuableEvt = static_cast<ContinuableEvent *>(evtNode.mapped().get());
 
+                        bool profile = _handlerProfiler.enabled();
+                        auto before = profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
                         auto it = continuableEvt->generator.begin();
+                        if(profile) {
+                            _handlerProfiler.slice(continuableEvt->listeningServiceId, continuableEvt->eventType, std::chrono::steady_clock::now() - before);
+                        }
 
                         if (it != continuableEvt->generator.end()) {
-                            pushEventInternal<ContinuableEvent>(continuableEvt->originatingService, evtNode.key(), std::move(continuableEvt->generator));
+                            pushEventInternal<ContinuableEvent>(continuableEvt->originatingService, evtNode.key(), std::move(continuableEvt->generator), continuableEvt->listeningServiceId, continuableEvt->eventType);
                         }
                     }
                         break;
@@ -305,25 +392,402 @@ void Cppelix::DependencyManager::start() {
                 }
             }
 
+            _flightRecorder.end();
+            // timer callbacks run outside of event handling, what they push starts a new trace
+            traceScope.close();
+            if(timersDue()) {
+                fireTimers();
+            }
+
             lck.lock();
         }
 
-        _wakeUp.wait_for(lck, std::chrono::milliseconds(1), [this]{return !_eventQueue.empty(); });
+        waitForWork(lck);
+        _timersChanged = false;
 
         lck.unlock();
     }
 
-    for(auto &[key, manager] : _services) {
+    // the thread pool runs the start() calls still queued before it goes, finish them so none of their services is left STARTING
+    _lifecycleThreadPool = nullptr;
+    {
+        std::lock_guard lg(_eventQueueMutex);
+        for(auto &[priority, evt] : _eventQueue) {
+            if(evt.getType() == StartServiceCompletedEvent::TYPE) {
+                auto *startCompletedEvt = static_cast<StartServiceCompletedEvent *>(evt.get());
+                (void)startCompletedEvt->manager->finishStart(startCompletedEvt->started);
+            }
+        }
+    }
+    _parallelStarts.clear();
+    _queuedStarts.clear();
+    _eventsWaitingOnParallelStarts.clear();
+    _servicesHeldByWaitingEvents.clear();
+    _quitWaiting = false;
+
+    for(size_t i = 0; i < _services.size(); i++) {
+        auto manager = _services.at(i).second;
         manager->stop();
     }
 
     _services.clear();
+    _serviceIndex.clear();
 
     if(_communicationChannel != nullptr) {
         _communicationChannel->removeManager(this);
     }
 }
 
+void Cppelix::DependencyManager::instantiateServiceFactory(size_t factoryIndex) {
+    auto &factory = _serviceFactories[factoryIndex];
+    if(factory.idleSince) {
+        factory.idleSince.reset();
+        _idleServiceFactoryCount--;
+    }
+
+    if(factory.serviceId != 0 && _services.contains(factory.serviceId)) {
+        return;
+    }
+
+    // create() may register more factories, don't hold on to the reference
+    auto serviceId = factory.create();
+    _serviceFactories[factoryIndex].serviceId = serviceId;
+    LOG_DEBUG(_logger, "instantiated {} with id {} on request", _serviceFactories[factoryIndex].implementationName, serviceId);
+}
+
+void Cppelix::DependencyManager::instantiateServiceFactoriesFor(uint64_t interfaceNameHash) {
+    if(!_serviceFactoriesByInterface.contains(interfaceNameHash)) {
+        return;
+    }
+
+    // look the list up again every iteration, instantiating may register more factories
+    for(size_t i = 0; i < _serviceFactoriesByInterface[interfaceNameHash].size(); i++) {
+        instantiateServiceFactory(_serviceFactoriesByInterface[interfaceNameHash][i]);
+    }
+}
+
+void Cppelix::DependencyManager::markIdleServiceFactories(uint64_t interfaceNameHash) {
+    auto factories = _serviceFactoriesByInterface.find(interfaceNameHash);
+    if(factories == end(_serviceFactoriesByInterface)) {
+        return;
+    }
+
+    for(auto factoryIndex : factories->second) {
+        auto &factory = _serviceFactories[factoryIndex];
+        if(!factory.idleTimeout || factory.idleSince || factory.serviceId == 0) {
+            continue;
+        }
+
+        auto service = _services.find(factory.serviceId);
+        if(service == end(_services) || hasDependents(_serviceIndex, _services, service->second)) {
+            continue;
+        }
+
+        factory.idleSince = now();
+        _idleServiceFactoryCount++;
+    }
+}
+
+void Cppelix::DependencyManager::reclaimIdleServices() {
+    auto now = this->now();
+
+    for(auto &factory : _serviceFactories) {
+        if(!factory.idleSince || now - *factory.idleSince < *factory.idleTimeout) {
+            continue;
+        }
+
+        factory.idleSince.reset();
+        _idleServiceFactoryCount--;
+
+        auto service = _services.find(factory.serviceId);
+        if(service == end(_services)) {
+            factory.serviceId = 0;
+            continue;
+        }
+
+        // a dependent may have been installed since, its request is then still queued
+        if(hasDependents(_serviceIndex, _services, service->second)) {
+            continue;
+        }
+
+        LOG_DEBUG(_logger, "removing idle {} with id {}", factory.implementationName, factory.serviceId);
+        pushEventInternal<RemoveServiceEvent>(0, INTERNAL_EVENT_PRIORITY, factory.serviceId);
+        factory.serviceId = 0;
+    }
+}
+
+uint64_t Cppelix::DependencyManager::scheduleTimer(std::chrono::nanoseconds delay, std::chrono::nanoseconds interval, TimerCallback callback, std::chrono::nanoseconds slack, uint64_t ownerServiceId) {
+    auto expiry = timerTickOf(now() + delay);
+    // a periodic timer has to move forward, below a microsecond it would fire on every advance
+    uint64_t intervalTicks = interval.count() <= 0 ? 0 : std::max<uint64_t>(1, static_cast<uint64_t>(std::chrono::ceil<std::chrono::microseconds>(interval).count()));
+    uint64_t slackTicks = slack.count() <= 0 ? 0 : static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(slack).count());
+
+    uint64_t handle;
+    {
+        std::lock_guard lg(_timerMutex);
+        handle = _timerWheel.schedule(expiry, intervalTicks, [this, callback = std::move(callback)](uint64_t deadline, uint64_t missed) {
+            callback(_timerEpoch + std::chrono::microseconds(deadline), missed);
+        }, slackTicks, ownerServiceId);
+        _nextTimerTick.store(std::min(_nextTimerTick.load(std::memory_order_relaxed), expiry), std::memory_order_relaxed);
+    }
+
+    {
+        std::lock_guard lg(_eventQueueMutex);
+        _timersChanged = true;
+    }
+    _wakeUp.notify_all();
+    return handle;
+}
+
+bool Cppelix::DependencyManager::cancelTimer(uint64_t handle) {
+    std::lock_guard lg(_timerMutex);
+    return _timerWheel.cancel(handle);
+}
+
+size_t Cppelix::DependencyManager::cancelTimersOf(uint64_t ownerServiceId) {
+    std::lock_guard lg(_timerMutex);
+    return _timerWheel.cancelOwnedBy(ownerServiceId);
+}
+
+bool Cppelix::DependencyManager::setTimerInterval(uint64_t handle, std::chrono::nanoseconds interval) {
+    std::lock_guard lg(_timerMutex);
+    if(!_timerWheel.setInterval(handle, std::max<uint64_t>(1, static_cast<uint64_t>(std::chrono::ceil<std::chrono::microseconds>(interval).count())))) {
+        return false;
+    }
+
+    // the deadline might have moved closer, the loop only looks at the wheel again after this
+    _nextTimerTick.store(_timerWheel.nextWakeUp().value_or(std::numeric_limits<uint64_t>::max()), std::memory_order_relaxed);
+    return true;
+}
+
+uint64_t Cppelix::DependencyManager::timerTickOf(std::chrono::steady_clock::time_point time) const noexcept {
+    if(time <= _timerEpoch) {
+        return 0;
+    }
+    return static_cast<uint64_t>(std::chrono::ceil<std::chrono::microseconds>(time - _timerEpoch).count());
+}
+
+uint64_t Cppelix::DependencyManager::currentTimerTick() const noexcept {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(now() - _timerEpoch).count());
+}
+
+void Cppelix::DependencyManager::fireTimers() {
+    std::lock_guard lg(_timerMutex);
+    _timerWheel.advance(currentTimerTick());
+    _nextTimerTick.store(_timerWheel.nextWakeUp().value_or(std::numeric_limits<uint64_t>::max()), std::memory_order_relaxed);
+}
+
+std::chrono::steady_clock::time_point Cppelix::DependencyManager::nextTimerWakeUp(std::chrono::steady_clock::time_point latest) const noexcept {
+    auto next = _nextTimerTick.load(std::memory_order_relaxed);
+    if(next == std::numeric_limits<uint64_t>::max()) {
+        return latest;
+    }
+    return std::min(latest, _timerEpoch + std::chrono::microseconds(next));
+}
+
+Cppelix::QueueMetricsSnapshot Cppelix::DependencyManager::getQueueMetrics() {
+    QueueMetricsSnapshot snapshot{};
+    _queueMetrics.fill(snapshot);
+    snapshot.taken = std::chrono::steady_clock::now();
+    return snapshot;
+}
+
+void Cppelix::DependencyManager::waitForWork(std::unique_lock<std::mutex> &lck) {
+    auto hasWork = [this]{ return !_eventQueue.empty() || _timersChanged; };
+    if(_virtualClock == nullptr) {
+        // wake up at least every millisecond to notice SIGINT and idle timeouts
+        _wakeUp.wait_until(lck, nextTimerWakeUp(std::chrono::steady_clock::now() + std::chrono::milliseconds(1)), hasWork);
+        return;
+    }
+
+    // a start() running on the thread pool still pushes its completion, skipping time before that would depend on thread timing
+    if(hasWork() || !_parallelStarts.empty()) {
+        _wakeUp.wait_for(lck, std::chrono::milliseconds(1), hasWork);
+        return;
+    }
+
+    std::optional<std::chrono::steady_clock::time_point> next{};
+    if(auto tick = _nextTimerTick.load(std::memory_order_relaxed); tick != std::numeric_limits<uint64_t>::max()) {
+        next = _timerEpoch + std::chrono::microseconds(tick);
+    }
+    if(_idleServiceFactoryCount > 0) {
+        for(auto const &factory : _serviceFactories) {
+            if(factory.idleSince && (!next || *factory.idleSince + *factory.idleTimeout < *next)) {
+                next = *factory.idleSince + *factory.idleTimeout;
+            }
+        }
+    }
+
+    if(next) {
+        _virtualClock->advanceTo(*next);
+        return;
+    }
+
+    // nothing scheduled, only another thread can still push an event
+    _wakeUp.wait_for(lck, std::chrono::milliseconds(1), hasWork);
+}
+
+void Cppelix::DependencyManager::checkReplaceable(uint64_t serviceId, const std::vector<InterfaceKey> &interfaces) const {
+    auto service = _services.find(serviceId);
+    if(service == end(_services)) {
+        throw std::runtime_error("Cannot replace service " + std::to_string(serviceId) + ", missing from known services");
+    }
+
+    for(auto const &interface : service->second->getInterfaces()) {
+        bool provided = std::any_of(begin(interfaces), end(interfaces), [&interface](const InterfaceKey &key) {
+            return key == InterfaceKey{interface.interfaceNameHash, interface.interfaceVersion};
+        });
+
+        if(!provided) {
+            throw std::runtime_error("Cannot replace " + std::string{service->second->implementationName()} + ", replacement does not provide all of its interfaces");
+        }
+    }
+}
+
+void Cppelix::DependencyManager::sortByRanking(std::vector<uint64_t> &serviceIds) const {
+    if(serviceIds.size() < 2) {
+        return;
+    }
+
+    std::vector<std::pair<int32_t, uint64_t>> ranked;
+    ranked.reserve(serviceIds.size());
+    bool anyRanked = false;
+    for(auto serviceId : serviceIds) {
+        auto ranking = serviceRankingOf(*_services.find(serviceId)->second->getProperties());
+        anyRanked |= ranking != 0;
+        ranked.emplace_back(ranking, serviceId);
+    }
+
+    if(!anyRanked) {
+        return;
+    }
+
+    std::stable_sort(begin(ranked), end(ranked), [](const std::pair<int32_t, uint64_t> &a, const std::pair<int32_t, uint64_t> &b) {
+        return a.first > b.first;
+    });
+    for(size_t i = 0; i < ranked.size(); i++) {
+        serviceIds[i] = ranked[i].second;
+    }
+}
+
+void Cppelix::DependencyManager::swapProvider(uint64_t oldServiceId, const std::shared_ptr<ILifecycleManager> &newProvider) {
+    auto oldService = _services.find(oldServiceId);
+    if(oldService == end(_services)) {
+        return;
+    }
+
+    // copy, erasing it from the registry below would destroy it while still in use
+    auto oldProvider = oldService->second;
+    const Filter *oldFilter = filterOf(*oldProvider);
+    const Filter *newFilter = filterOf(*newProvider);
+
+    std::vector<uint64_t> dependentIds;
+    _serviceIndex.findDependents(*oldProvider, oldFilter, dependentIds);
+    for (auto dependentId : dependentIds) {
+        auto dependent = _services.find(dependentId)->second;
+        if (oldFilter != nullptr && !oldFilter->compareTo(dependent)) {
+            continue;
+        }
+
+        if (newFilter != nullptr && !newFilter->compareTo(dependent)) {
+            if (dependent->dependencyOffline(oldProvider)) {
+                pushEventInternal<DependencyOfflineEvent>(0, INTERNAL_EVENT_PRIORITY, dependent);
+            }
+            continue;
+        }
+
+        dependent->replaceDependency(oldProvider, newProvider);
+    }
+
+    if (oldProvider->getServiceState() == ServiceState::ACTIVE && !oldProvider->stop()) {
+        LOG_ERROR(_logger, "Couldn't stop replaced service {}: {}", oldServiceId, oldProvider->implementationName());
+    }
+
+    LOG_DEBUG(_logger, "replaced {} {} with {} {}", oldProvider->implementationName(), oldServiceId, newProvider->implementationName(), newProvider->serviceId());
+    _pendingReplacements.erase(oldServiceId);
+    _startupProfiler.serviceRemoved(oldServiceId);
+    _handlerProfiler.serviceRemoved(oldServiceId);
+    _serviceIndex.remove(oldProvider);
+    _services.erase(oldServiceId);
+}
+
+void Cppelix::DependencyManager::replayDependencyRequests(InterfaceKey key, const std::function<void(Event const * const)> &requestFunc) {
+    std::vector<uint64_t> requesterIds;
+    _serviceIndex.findRequesters(key.typenameHash, requesterIds);
+
+    for(auto requesterId : requesterIds) {
+        auto requester = _services.find(requesterId);
+        // the tracker may have removed services in the meantime
+        if(requester == end(_services)) {
+            continue;
+        }
+
+        // copy, the tracker may create services and move the registry entries
+        auto mgr = requester->second;
+        auto const *depRegistry = mgr->getDependencyRegistry();
+        auto slot = depRegistry->slotOf(key);
+        if(slot == DependencyRegister::NO_SLOT) {
+            continue;
+        }
+
+        const auto &registration = depRegistry->_registrations[slot];
+        const auto &props = registration.properties;
+        DependencyRequestEvent evt{0, mgr->serviceId(), INTERNAL_EVENT_PRIORITY, mgr, registration.dependency, props.has_value() ? &props.value() : std::optional<CppelixProperties const *>{}};
+        requestFunc(&evt);
+    }
+}
+
+uint64_t Cppelix::DependencyManager::addDependencyTracker(uint64_t interfaceNameHash, DependencyTrackerInfo info) {
+    info.trackerId = _dependencyTrackerIdCounter++;
+    info.registeredAt = _eventIdCounter.load(std::memory_order_acquire);
+    auto &trackers = _dependencyTrackers[interfaceNameHash];
+    trackers.emplace_back(std::move(info));
+    return trackers.back().trackerId;
+}
+
+void Cppelix::DependencyManager::removeDependencyTracker(uint64_t interfaceNameHash, uint64_t trackerId) {
+    auto trackers = _dependencyTrackers.find(interfaceNameHash);
+    if(trackers == end(_dependencyTrackers)) {
+        return;
+    }
+
+    auto &infos = trackers->second;
+    auto tracker = std::lower_bound(begin(infos), end(infos), trackerId, [](const DependencyTrackerInfo &info, uint64_t id) {
+        return info.trackerId < id;
+    });
+    if(tracker == end(infos) || tracker->trackerId != trackerId) {
+        return;
+    }
+
+    infos.erase(tracker);
+    if(infos.empty()) {
+        _dependencyTrackers.erase(trackers);
+    }
+}
+
+void Cppelix::DependencyManager::callDependencyTrackers(uint64_t interfaceNameHash, Event const *evt, std::function<void(Event const * const)> DependencyTrackerInfo::*func) {
+    uint64_t lastCalled = 0;
+    while(true) {
+        // looked up again for every tracker, one registering a tracker for another interface can rehash the map
+        auto trackers = _dependencyTrackers.find(interfaceNameHash);
+        if(trackers == end(_dependencyTrackers)) {
+            return;
+        }
+
+        auto next = std::upper_bound(begin(trackers->second), end(trackers->second), lastCalled, [](uint64_t id, const DependencyTrackerInfo &info) {
+            return id < info.trackerId;
+        });
+        if(next == end(trackers->second) || next->registeredAt > evt->id) {
+            return;
+        }
+
+        lastCalled = next->trackerId;
+        // copy, the tracker may add trackers to the vector it is in
+        auto call = (*next).*func;
+        call(evt);
+    }
+}
+
 void Cppelix::DependencyManager::handleEventCompletion(const Cppelix::Event *const evt) const  {
     if(evt->originatingService == 0) {
         return;
@@ -358,12 +822,17 @@ void Cppelix::DependencyManager::broadcastEvent(const Cppelix::Event *const evt)
             continue;
         }
 
+        bool profile = _handlerProfiler.enabled();
+        auto before = profile ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{};
         auto ret = callbackInfo.callback(evt);
         auto it = ret.begin();
+        if(profile) {
+            _handlerProfiler.invocation(callbackInfo.listeningServiceId, service->second->implementationName(), evt->type, evt->name, std::chrono::steady_clock::now() - before);
+        }
 
         bool allowOtherHandlers = *it;
         if(it != ret.end()) {
-            pushEventInternal<ContinuableEvent>(evt->originatingService, evt->priority, std::move(ret));
+            pushEventInternal<ContinuableEvent>(evt->originatingService, evt->priority, std::move(ret), callbackInfo.listeningServiceId, evt->type);
         }
 
         if(!allowOtherHandlers) {
@@ -382,6 +851,301 @@ std::optional<std::string_view> Cppelix::DependencyManager::getImplementationNam
     return service->second->implementationName();
 }
 
+void Cppelix::DependencyManager::stopAllServices() {
+    struct ShutdownNode final {
+        std::shared_ptr<ILifecycleManager> manager;
+        std::vector<uint32_t> dependents;
+        std::vector<uint32_t> providers;
+        uint32_t runningDependents;
+        bool stopped;
+    };
+
+    struct PoolStops final {
+        std::mutex mutex;
+        std::condition_variable done;
+        std::vector<std::pair<uint32_t, bool>> results; // node index + result of stop()
+        std::vector<std::chrono::nanoseconds> durations;
+    };
+
+    std::vector<ShutdownNode> nodes;
+    std::unordered_map<uint64_t, uint32_t> nodeIndexById; // key = service id
+    nodes.reserve(_services.size());
+    nodeIndexById.reserve(_services.size());
+
+    for(auto &[serviceId, manager] : _services) {
+        // keep logging until the very end
+        if(manager == _preventEarlyDestructionOfFrameworkLogger) {
+            continue;
+        }
+
+        nodeIndexById.emplace(serviceId, static_cast<uint32_t>(nodes.size()));
+        nodes.push_back(ShutdownNode{manager, {}, {}, 0, false});
+    }
+
+    // same candidates and filter check as DependencyOnlineEvent, a provider only orders the services it can have been injected into
+    std::vector<uint64_t> dependentIds;
+    for(uint32_t provider = 0; provider < nodes.size(); provider++) {
+        const Filter *filter = filterOf(*nodes[provider].manager);
+        _serviceIndex.findDependents(*nodes[provider].manager, filter, dependentIds);
+
+        for(auto dependentId : dependentIds) {
+            auto dependent = nodeIndexById.find(dependentId);
+            if(dependent == end(nodeIndexById) || dependent->second == provider) {
+                continue;
+            }
+
+            if(filter != nullptr && !filter->compareTo(nodes[dependent->second].manager)) {
+                continue;
+            }
+
+            nodes[provider].dependents.push_back(dependent->second);
+            nodes[provider].runningDependents++;
+            nodes[dependent->second].providers.push_back(provider);
+        }
+    }
+
+    std::vector<uint32_t> wave;
+    std::vector<uint32_t> nextWave;
+    for(uint32_t i = 0; i < nodes.size(); i++) {
+        if(nodes[i].runningDependents == 0) {
+            wave.push_back(i);
+        }
+    }
+
+    PoolStops poolStops{};
+    _slowStoppers.clear();
+
+    auto notifyDependents = [&nodes](uint32_t index) {
+        // dependents are already stopped, this only removes the injected dependency
+        for(auto dependent : nodes[index].dependents) {
+            (void)nodes[dependent].manager->dependencyOffline(nodes[index].manager);
+        }
+    };
+
+    auto finishStop = [this, &nodes, &notifyDependents](uint32_t index, bool stopped, std::chrono::nanoseconds duration) {
+        auto &node = nodes[index];
+        if(!node.manager->finishStop(stopped)) {
+            LOG_ERROR(_logger, "Couldn't stop service {}: {}", node.manager->serviceId(), node.manager->implementationName());
+        }
+
+        if(duration > _stopTimeout) {
+            LOG_WARN(_logger, "Stopping service {}: {} took {} ms", node.manager->serviceId(), node.manager->implementationName(),
+                     std::chrono::duration_cast<std::chrono::milliseconds>(duration).count());
+            _slowStoppers.push_back(SlowStopper{node.manager->serviceId(), node.manager->implementationName(), duration});
+        }
+
+        notifyDependents(index);
+    };
+
+    while(!wave.empty()) {
+        uint32_t stopsInPool = 0;
+
+        for(auto index : wave) {
+            auto &node = nodes[index];
+            node.stopped = true;
+
+            if(!node.manager->prepareStop()) {
+                notifyDependents(index);
+                continue;
+            }
+
+            if(_lifecycleThreadPool != nullptr && node.manager->parallelStopSafe()) {
+                stopsInPool++;
+                _lifecycleThreadPool->submit([&poolStops, &nodes, index]() {
+                    auto before = std::chrono::steady_clock::now();
+                    bool stopped = runStopNoThrow(*nodes[index].manager);
+                    auto duration = std::chrono::steady_clock::now() - before;
+
+                    std::lock_guard lg(poolStops.mutex);
+                    poolStops.results.emplace_back(index, stopped);
+                    poolStops.durations.emplace_back(duration);
+                    poolStops.done.notify_one();
+                });
+                continue;
+            }
+
+            auto before = std::chrono::steady_clock::now();
+            bool stopped = runStopNoThrow(*node.manager);
+            finishStop(index, stopped, std::chrono::steady_clock::now() - before);
+        }
+
+        if(stopsInPool > 0) {
+            std::unique_lock lck(poolStops.mutex);
+            if(!poolStops.done.wait_for(lck, _stopTimeout, [&poolStops, stopsInPool]{ return poolStops.results.size() == stopsInPool; })) {
+                LOG_ERROR(_logger, "{} services still stopping after {} ms, waiting for them before stopping their dependencies", stopsInPool - poolStops.results.size(), _stopTimeout.count());
+                poolStops.done.wait(lck, [&poolStops, stopsInPool]{ return poolStops.results.size() == stopsInPool; });
+            }
+
+            for(size_t i = 0; i < poolStops.results.size(); i++) {
+                finishStop(poolStops.results[i].first, poolStops.results[i].second, poolStops.durations[i]);
+            }
+            poolStops.results.clear();
+            poolStops.durations.clear();
+        }
+
+        for(auto index : wave) {
+            for(auto provider : nodes[index].providers) {
+                if(--nodes[provider].runningDependents == 0) {
+                    nextWave.push_back(provider);
+                }
+            }
+        }
+
+        wave.swap(nextWave);
+        nextWave.clear();
+    }
+
+    // whatever is left depends on itself through optional dependencies, stop it in any order
+    for(uint32_t i = 0; i < nodes.size(); i++) {
+        if(nodes[i].stopped) {
+            continue;
+        }
+
+        LOG_WARN(_logger, "Service {}: {} is part of a dependency cycle, stopping in arbitrary order", nodes[i].manager->serviceId(), nodes[i].manager->implementationName());
+        nodes[i].stopped = true;
+        if(nodes[i].manager->prepareStop()) {
+            auto before = std::chrono::steady_clock::now();
+            bool stopped = runStopNoThrow(*nodes[i].manager);
+            finishStop(i, stopped, std::chrono::steady_clock::now() - before);
+        } else {
+            notifyDependents(i);
+        }
+    }
+
+    if(_preventEarlyDestructionOfFrameworkLogger != nullptr) {
+        (void)_preventEarlyDestructionOfFrameworkLogger->stop();
+    }
+
+    std::sort(begin(_slowStoppers), end(_slowStoppers), [](const SlowStopper &a, const SlowStopper &b) {
+        return a.duration > b.duration;
+    });
+}
+
+void Cppelix::DependencyManager::enableLifecycleThreadPool(uint32_t threadCount) {
+    if(threadCount == 0) {
+        throw std::runtime_error("lifecycle thread pool needs at least one thread");
+    }
+
+    _lifecycleThreadPool = std::make_unique<ThreadPool>(threadCount);
+}
+
+void Cppelix::DependencyManager::startServiceInThreadPool(const std::shared_ptr<ILifecycleManager> &service, uint64_t originatingServiceId) {
+    _parallelStarts.emplace(service->serviceId(), ParallelStartInfo{originatingServiceId, false});
+
+    _lifecycleThreadPool->submit([this, service]() {
+        bool started = false;
+        std::exception_ptr exception{};
+
+        try {
+            started = service->runStart();
+        } catch (...) {
+            exception = std::current_exception();
+        }
+
+        pushEventInternal<StartServiceCompletedEvent>(0, INTERNAL_EVENT_PRIORITY, service, started, exception);
+    });
+}
+
+void Cppelix::DependencyManager::appendServicesChangedBy(Event const *evt, std::vector<uint64_t> &out) const {
+    std::shared_ptr<ILifecycleManager> service{};
+    switch(evt->type) {
+        case DependencyOfflineEvent::TYPE:
+            service = static_cast<DependencyOfflineEvent const *>(evt)->manager;
+            break;
+        case StopServiceEvent::TYPE:
+        case RemoveServiceEvent::TYPE: {
+            auto serviceId = evt->type == StopServiceEvent::TYPE ? static_cast<StopServiceEvent const *>(evt)->serviceId : static_cast<RemoveServiceEvent const *>(evt)->serviceId;
+            auto known = _services.find(serviceId);
+            if(known == end(_services)) {
+                out.push_back(serviceId);
+                return;
+            }
+            service = known->second;
+        }
+            break;
+        case StartServiceEvent::TYPE:
+            out.push_back(static_cast<StartServiceEvent const *>(evt)->serviceId);
+            return;
+        case DependencyOnlineEvent::TYPE: {
+            // swapProvider() stops the replaced service and replaces it in its dependents
+            auto replacement = _pendingReplacements.find(static_cast<DependencyOnlineEvent const *>(evt)->manager->serviceId());
+            if(replacement == end(_pendingReplacements)) {
+                return;
+            }
+            auto replaced = _services.find(replacement->second);
+            if(replaced == end(_services)) {
+                return;
+            }
+            service = replaced->second;
+        }
+            break;
+        default:
+            return;
+    }
+
+    // without the filter check, holding back a few events too many is harmless
+    std::vector<uint64_t> dependentIds;
+    _serviceIndex.findDependents(*service, nullptr, dependentIds);
+    out.push_back(service->serviceId());
+    out.insert(end(out), begin(dependentIds), end(dependentIds));
+}
+
+bool Cppelix::DependencyManager::holdUntilParallelStartsFinish(Event const *evt) {
+    if(_parallelStarts.empty() && _eventsWaitingOnParallelStarts.empty()) {
+        return false;
+    }
+
+    if(evt->type == QuitEvent::TYPE) {
+        _quitWaiting = true;
+        return true;
+    }
+
+    std::vector<uint64_t> serviceIds;
+    appendServicesChangedBy(evt, serviceIds);
+    if(serviceIds.empty()) {
+        return false;
+    }
+
+    bool hold = _quitWaiting;
+    if(evt->type == StartServiceEvent::TYPE) {
+        // a start() already running on the thread pool handles a repeated StartServiceEvent by itself
+        hold = hold || _servicesHeldByWaitingEvents.contains(serviceIds.front());
+    } else {
+        hold = hold || std::any_of(begin(serviceIds), end(serviceIds), [this](uint64_t serviceId) {
+            return _parallelStarts.contains(serviceId) || _servicesHeldByWaitingEvents.contains(serviceId);
+        });
+    }
+
+    if(hold) {
+        _servicesHeldByWaitingEvents.insert(begin(serviceIds), end(serviceIds));
+    }
+    return hold;
+}
+
+void Cppelix::DependencyManager::releaseEventsWaitingOnParallelStarts() {
+    std::vector<EventStackUniquePtr> waiting;
+    waiting.swap(_eventsWaitingOnParallelStarts);
+    _servicesHeldByWaitingEvents.clear();
+    _quitWaiting = false;
+
+    // held back again against what is still running and what stays held back in front of them
+    std::vector<EventStackUniquePtr> released;
+    for(auto &waitingEvt : waiting) {
+        if(holdUntilParallelStartsFinish(waitingEvt.get())) {
+            _eventsWaitingOnParallelStarts.emplace_back(std::move(waitingEvt));
+        } else {
+            released.emplace_back(std::move(waitingEvt));
+        }
+    }
+
+    std::lock_guard lg(_eventQueueMutex);
+    for(auto releasedEvt = released.rbegin(); releasedEvt != released.rend(); releasedEvt++) {
+        auto priority = releasedEvt->get()->priority;
+        _eventQueue.emplace_hint(_eventQueue.lower_bound(priority), priority, std::move(*releasedEvt));
+        _queueMetrics.enqueued(priority);
+    }
+}
+
 void Cppelix::DependencyManager::setCommunicationChannel(Cppelix::CommunicationChannel *channel) {
     _communicationChannel = channel;
 }
@@ -406,6 +1170,6 @@ Cppelix::EventInterceptorRegistration::~EventInterceptorRegistration() {
 
 Cppelix::DependencyTrackerRegistration::~DependencyTrackerRegistration() {
     if(_mgr != nullptr) {
-        _mgr->pushEvent<RemoveTrackerEvent>(0, _interfaceNameHash);
+        _mgr->pushEvent<RemoveTrackerEvent>(0, _interfaceNameHash, _trackerId);
     }
 }
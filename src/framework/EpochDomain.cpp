@@ -0,0 +1,98 @@
+#include "framework/EpochDomain.h"
+#include <algorithm>
+#include <thread>
+
+Cppelix::EpochDomain::ThreadState::~ThreadState() {
+    if(record != nullptr) {
+        record->epoch.store(QUIESCENT, std::memory_order_release);
+        record->inUse.store(false, std::memory_order_release);
+    }
+}
+
+Cppelix::EpochDomain::ThreadState& Cppelix::EpochDomain::threadState() noexcept {
+    thread_local ThreadState state{};
+    return state;
+}
+
+Cppelix::EpochDomain::Guard::Guard(EpochDomain &domain) : _state(&threadState()), _outermost(_state->depth == 0) {
+    if(_state->record == nullptr) {
+        _state->record = domain.acquireRecord();
+    }
+
+    _state->depth++;
+    if(_outermost) {
+        // seq_cst on both sides: a writer scanning the records either sees this pin or we see everything it published before scanning
+        _state->record->epoch.store(domain._globalEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+    }
+}
+
+Cppelix::EpochDomain::Guard::~Guard() {
+    _state->depth--;
+    if(_outermost) {
+        _state->record->epoch.store(QUIESCENT, std::memory_order_release);
+    }
+}
+
+Cppelix::EpochDomain::Record* Cppelix::EpochDomain::acquireRecord() {
+    for(auto *record = _records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        bool expected = false;
+        if(!record->inUse.load(std::memory_order_relaxed) && record->inUse.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return record;
+        }
+    }
+
+    // records are never freed, the list only grows to the highest amount of threads that pinned at the same time
+    auto *record = new Record();
+    record->next = _records.load(std::memory_order_relaxed);
+    while(!_records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+    return record;
+}
+
+uint64_t Cppelix::EpochDomain::oldestPinnedEpoch() const noexcept {
+    auto oldest = _globalEpoch.load(std::memory_order_seq_cst);
+    for(auto *record = _records.load(std::memory_order_acquire); record != nullptr; record = record->next) {
+        auto epoch = record->epoch.load(std::memory_order_seq_cst);
+        if(epoch != QUIESCENT && epoch < oldest) {
+            oldest = epoch;
+        }
+    }
+    return oldest;
+}
+
+void Cppelix::EpochDomain::retire(void *ptr, void (*deleter)(void*)) {
+    {
+        std::lock_guard l(_retiredMutex);
+        // threads pinned at this epoch or earlier may still hold ptr, anyone pinning from now on gets the next epoch
+        _retired.push_back(Retired{_globalEpoch.fetch_add(1, std::memory_order_seq_cst), ptr, deleter});
+    }
+    reclaim();
+}
+
+void Cppelix::EpochDomain::reclaim() {
+    std::vector<Retired> freeable;
+    {
+        std::lock_guard l(_retiredMutex);
+        if(_retired.empty()) {
+            return;
+        }
+
+        auto oldest = oldestPinnedEpoch();
+        auto it = std::partition(begin(_retired), end(_retired), [oldest](const Retired &retired) { return retired.epoch >= oldest; });
+        freeable.assign(it, end(_retired));
+        _retired.erase(it, end(_retired));
+    }
+
+    // outside of the lock, a deleter may retire something itself
+    for(auto const &retired : freeable) {
+        retired.deleter(retired.ptr);
+    }
+}
+
+void Cppelix::EpochDomain::synchronize() {
+    auto epoch = _globalEpoch.fetch_add(1, std::memory_order_seq_cst);
+    while(oldestPinnedEpoch() <= epoch) {
+        std::this_thread::yield();
+    }
+    reclaim();
+}
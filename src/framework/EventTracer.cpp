@@ -0,0 +1,132 @@
+#include "framework/EventTracer.h"
+#include <algorithm>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <fmt/format.h>
+
+namespace {
+    // only its own thread writes to a ring, the mutex is there for collect() and clear()
+    struct SpanRing final {
+        std::mutex mutex{};
+        std::vector<Cppelix::TraceSpan> spans{};
+        uint64_t written{0};
+    };
+
+    // rings outlive their threads, spans of a thread that ended can still be exported
+    std::mutex ringsMutex{};
+    std::vector<std::shared_ptr<SpanRing>> rings{};
+    std::vector<std::shared_ptr<SpanRing>> freeRings{}; // rings of threads that ended, capacity always covers all rings
+
+    // hands the ring back when its thread exits, so threads coming and going don't each allocate one
+    struct ThreadRing final {
+        std::shared_ptr<SpanRing> ring{};
+
+        ~ThreadRing() {
+            if(ring) {
+                std::lock_guard lg(ringsMutex);
+                freeRings.push_back(std::move(ring));
+            }
+        }
+    };
+    thread_local ThreadRing threadRing{};
+}
+
+void Cppelix::EventTracer::acquireRing() {
+    if(threadRing.ring) {
+        return;
+    }
+
+    {
+        std::lock_guard lg(ringsMutex);
+        if(!freeRings.empty()) {
+            threadRing.ring = std::move(freeRings.back());
+            freeRings.pop_back();
+            return;
+        }
+    }
+
+    auto ring = std::make_shared<SpanRing>();
+    ring->spans.resize(SPANS_PER_THREAD);
+    std::lock_guard lg(ringsMutex);
+    freeRings.reserve(rings.size() + 1);
+    rings.push_back(ring);
+    threadRing.ring = std::move(ring);
+}
+
+void Cppelix::EventTracer::record(TraceSpan const &span) noexcept {
+    auto *ring = threadRing.ring.get();
+    if(ring == nullptr) {
+        return;
+    }
+
+    std::lock_guard lg(ring->mutex);
+    ring->spans[ring->written % SPANS_PER_THREAD] = span;
+    ring->written++;
+}
+
+std::vector<Cppelix::TraceSpan> Cppelix::EventTracer::collect() {
+    std::vector<TraceSpan> spans;
+    std::lock_guard lg(ringsMutex);
+    for(auto const &ring : rings) {
+        std::lock_guard ringLg(ring->mutex);
+        auto available = std::min<uint64_t>(ring->written, SPANS_PER_THREAD);
+        for(uint64_t i = ring->written - available; i < ring->written; i++) {
+            spans.push_back(ring->spans[i % SPANS_PER_THREAD]);
+        }
+    }
+    return spans;
+}
+
+std::string Cppelix::EventTracer::toChromeTrace() {
+    auto spans = collect();
+
+    uint64_t epoch = std::numeric_limits<uint64_t>::max();
+    std::unordered_map<uint64_t, uint64_t> managerOfSpan;
+    for(auto const &span : spans) {
+        epoch = std::min(epoch, span.pushedAt != 0 ? std::min(span.pushedAt, span.start) : span.start);
+        managerOfSpan.emplace(span.spanId, span.managerId);
+    }
+
+    auto toUs = [epoch](uint64_t ns) {
+        return static_cast<double>(ns - epoch) / 1'000.0;
+    };
+
+    fmt::memory_buffer out;
+    fmt::format_to(out, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    std::vector<uint64_t> namedManagers;
+    for(auto const &span : spans) {
+        if(!first) {
+            fmt::format_to(out, ",");
+        }
+        first = false;
+
+        if(std::find(namedManagers.begin(), namedManagers.end(), span.managerId) == namedManagers.end()) {
+            namedManagers.push_back(span.managerId);
+            fmt::format_to(out, "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"DependencyManager {}\"}}}},", span.managerId, span.managerId);
+        }
+
+        fmt::format_to(out, "{{\"name\":\"{}\",\"cat\":\"event\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"eventId\":{},\"parentEventId\":{},\"traceId\":{},\"queuedUs\":{:.3f}}}}}",
+                       span.eventName, span.managerId, toUs(span.start), toUs(span.end) - toUs(span.start), span.eventId, span.parentEventId, span.traceId, toUs(span.start) - toUs(span.pushedAt));
+
+        // the push happened while the parent span ran, which may already have been overwritten
+        auto parent = managerOfSpan.find(span.parentSpanId);
+        if(span.parentSpanId != 0 && parent != end(managerOfSpan)) {
+            fmt::format_to(out, ",{{\"name\":\"push\",\"cat\":\"causality\",\"ph\":\"s\",\"id\":{},\"pid\":1,\"tid\":{},\"ts\":{:.3f}}}", span.spanId, parent->second, toUs(span.pushedAt));
+            fmt::format_to(out, ",{{\"name\":\"push\",\"cat\":\"causality\",\"ph\":\"f\",\"bp\":\"e\",\"id\":{},\"pid\":1,\"tid\":{},\"ts\":{:.3f}}}", span.spanId, span.managerId, toUs(span.start));
+        }
+    }
+    fmt::format_to(out, "]}}");
+
+    return fmt::to_string(out);
+}
+
+void Cppelix::EventTracer::clear() noexcept {
+    std::lock_guard lg(ringsMutex);
+    for(auto const &ring : rings) {
+        std::lock_guard ringLg(ring->mutex);
+        ring->written = 0;
+    }
+}
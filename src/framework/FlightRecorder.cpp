@@ -0,0 +1,284 @@
+#include "framework/FlightRecorder.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+    std::array<std::atomic<Cppelix::FlightRecorder*>, Cppelix::FlightRecorder::MAX_RECORDERS> recorders{};
+    std::atomic<uint32_t> dumpsInProgress{0}; // ~FlightRecorder() waits for these to finish before freeing its slots
+    std::array<char, 256> signalDumpDirectory{};
+    constexpr std::array<int, 6> DUMP_SIGNALS{SIGUSR1, SIGSEGV, SIGBUS, SIGFPE, SIGILL, SIGABRT};
+    std::array<struct sigaction, DUMP_SIGNALS.size()> previousActions{}; // what was installed for DUMP_SIGNALS before us, same order
+
+    void onDumpSignal(int sig, siginfo_t *info, void *context) {
+        auto savedErrno = errno;
+        Cppelix::FlightRecorder::dumpAll(signalDumpDirectory.data());
+        errno = savedErrno;
+
+        auto index = static_cast<size_t>(std::find(DUMP_SIGNALS.begin(), DUMP_SIGNALS.end(), sig) - DUMP_SIGNALS.begin());
+        if(index == DUMP_SIGNALS.size()) {
+            return;
+        }
+        auto const &previous = previousActions[index];
+
+        if(sig != SIGUSR1) {
+            // put the previous disposition back and let it handle the crash, the default one terminates with a core dump
+            ::sigaction(sig, &previous, nullptr);
+            ::raise(sig);
+            return;
+        }
+
+        // the default action of SIGUSR1 would terminate the process, only a handler of the application is called
+        if((previous.sa_flags & SA_SIGINFO) != 0) {
+            if(previous.sa_sigaction != nullptr) {
+                previous.sa_sigaction(sig, info, context);
+            }
+        } else if(previous.sa_handler != SIG_DFL && previous.sa_handler != SIG_IGN) {
+            previous.sa_handler(sig);
+        }
+    }
+
+    /// write() all of size, retrying on partial writes
+    bool writeAll(int fd, const void *data, size_t size) noexcept {
+        auto *bytes = static_cast<const char*>(data);
+        while(size > 0) {
+            auto written = ::write(fd, bytes, size);
+            if(written < 0) {
+                if(errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+            bytes += written;
+            size -= static_cast<size_t>(written);
+        }
+        return true;
+    }
+
+    /// Append the decimal digits of value at out, snprintf is not async signal safe
+    /// \return position after the last digit
+    char* appendNumber(char *out, char *outEnd, uint64_t value) noexcept {
+        std::array<char, 20> digits{};
+        size_t count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while(value != 0);
+
+        while(count > 0 && out < outEnd) {
+            *out++ = digits[--count];
+        }
+        return out;
+    }
+
+    char* appendString(char *out, char *outEnd, const char *str) noexcept {
+        while(*str != '\0' && out < outEnd) {
+            *out++ = *str++;
+        }
+        return out;
+    }
+}
+
+Cppelix::FlightRecorder::FlightRecorder(uint64_t managerId) : _slots(std::make_unique<Slot[]>(CAPACITY)), _managerId(managerId) {
+    for(auto &recorder : recorders) {
+        FlightRecorder *expected = nullptr;
+        if(recorder.compare_exchange_strong(expected, this, std::memory_order_acq_rel)) {
+            break;
+        }
+    }
+}
+
+Cppelix::FlightRecorder::~FlightRecorder() {
+    for(auto &recorder : recorders) {
+        FlightRecorder *expected = this;
+        if(recorder.compare_exchange_strong(expected, nullptr)) {
+            break;
+        }
+    }
+
+    // a dumpAll() that found this recorder before it was taken out might still be reading _slots. Sequentially consistent with the
+    // increment in dumpAll(), so either that one doesn't see this recorder anymore or this sees it running.
+    while(dumpsInProgress.load() != 0) {
+        std::this_thread::yield();
+    }
+}
+
+void Cppelix::FlightRecorder::begin(uint64_t type, std::string_view name, uint64_t id, uint64_t originatingService, uint64_t priority, uint64_t enqueuedAt) noexcept {
+    if(!enabled()) {
+        return;
+    }
+
+    auto written = _written.load(std::memory_order_relaxed);
+    auto &slot = _slots[written % CAPACITY];
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    slot.type.store(type, std::memory_order_relaxed);
+    slot.id.store(id, std::memory_order_relaxed);
+    slot.originatingService.store(originatingService, std::memory_order_relaxed);
+    slot.priority.store(priority, std::memory_order_relaxed);
+    slot.enqueuedAt.store(enqueuedAt, std::memory_order_relaxed);
+    slot.dispatchedAt.store(now(), std::memory_order_relaxed);
+    slot.handlerDuration.store(FlightRecord::IN_PROGRESS, std::memory_order_relaxed);
+    slot.name.store(name.data(), std::memory_order_relaxed);
+    slot.nameLength.store(name.size(), std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+    _written.store(written + 1, std::memory_order_release);
+    _open = true;
+}
+
+void Cppelix::FlightRecorder::end() noexcept {
+    if(!_open) {
+        return;
+    }
+    _open = false;
+
+    auto &slot = _slots[(_written.load(std::memory_order_relaxed) - 1) % CAPACITY];
+    auto sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    auto duration = now() - slot.dispatchedAt.load(std::memory_order_relaxed);
+    slot.handlerDuration.store(duration, std::memory_order_relaxed);
+
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+std::vector<Cppelix::FlightRecord> Cppelix::FlightRecorder::snapshot() const {
+    std::vector<FlightRecord> records;
+    auto written = _written.load(std::memory_order_acquire);
+    auto available = std::min(written, CAPACITY);
+    records.reserve(available);
+
+    FlightRecord record;
+    std::string_view name;
+    for(auto index = written - available; index < written; index++) {
+        if(read(index, record, name)) {
+            records.push_back(record);
+        }
+    }
+    return records;
+}
+
+bool Cppelix::FlightRecorder::dump(const char *path) const noexcept {
+    auto fd = ::open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if(fd < 0) {
+        return false;
+    }
+
+    FlightRecorderFileHeader header;
+    header.managerId = _managerId;
+    header.capacity = CAPACITY;
+    header.dumpedAt = now();
+    // rewritten once the counts are known
+    bool ok = writeAll(fd, &header, sizeof(header));
+
+    // names are deduplicated per type on the stack, anything past the first NAME_SLOTS types goes without
+    constexpr size_t NAME_SLOTS = 256;
+    std::array<FlightRecordName, NAME_SLOTS> names{};
+    std::array<const char*, NAME_SLOTS> nameData{};
+
+    auto written = _written.load(std::memory_order_acquire);
+    auto available = std::min(written, CAPACITY);
+    FlightRecord record;
+    std::string_view name;
+    for(auto index = written - available; ok && index < written; index++) {
+        if(!read(index, record, name)) {
+            continue;
+        }
+
+        ok = writeAll(fd, &record, sizeof(record));
+        header.recordCount++;
+
+        auto known = std::find_if(names.begin(), names.begin() + static_cast<std::ptrdiff_t>(header.nameCount), [&](const FlightRecordName &n) noexcept {
+            return n.type == record.type;
+        });
+        if(known == names.begin() + static_cast<std::ptrdiff_t>(header.nameCount) && header.nameCount < NAME_SLOTS) {
+            names[header.nameCount] = FlightRecordName{record.type, name.size()};
+            nameData[header.nameCount] = name.data();
+            header.nameCount++;
+        }
+    }
+
+    for(uint64_t i = 0; ok && i < header.nameCount; i++) {
+        ok = writeAll(fd, &names[i], sizeof(FlightRecordName)) && writeAll(fd, nameData[i], names[i].length);
+    }
+
+    ok = ok && ::pwrite(fd, &header, sizeof(header), 0) == static_cast<ssize_t>(sizeof(header));
+    ::close(fd);
+    return ok;
+}
+
+size_t Cppelix::FlightRecorder::dumpAll(const char *directory) noexcept {
+    dumpsInProgress.fetch_add(1);
+    size_t dumped = 0;
+    for(auto &slot : recorders) {
+        auto *recorder = slot.load();
+        if(recorder == nullptr) {
+            continue;
+        }
+
+        std::array<char, 320> path{};
+        auto *out = path.data();
+        auto *outEnd = path.data() + path.size() - 1;
+        out = appendString(out, outEnd, directory);
+        out = appendString(out, outEnd, "/flight_");
+        out = appendNumber(out, outEnd, static_cast<uint64_t>(::getpid()));
+        out = appendString(out, outEnd, "_");
+        out = appendNumber(out, outEnd, recorder->_managerId);
+        appendString(out, outEnd, ".bin");
+
+        if(recorder->dump(path.data())) {
+            dumped++;
+        }
+    }
+    dumpsInProgress.fetch_sub(1);
+    return dumped;
+}
+
+void Cppelix::FlightRecorder::installSignalHandlers(std::string_view directory) {
+    auto length = std::min(directory.size(), signalDumpDirectory.size() - 1);
+    std::memcpy(signalDumpDirectory.data(), directory.data(), length);
+    signalDumpDirectory[length] = '\0';
+
+    struct sigaction action{};
+    action.sa_sigaction = onDumpSignal;
+    sigemptyset(&action.sa_mask);
+    for(size_t i = 0; i < DUMP_SIGNALS.size(); i++) {
+        // crash signals go back to the default disposition should dumping crash as well, until the handler restores the previous one
+        action.sa_flags = DUMP_SIGNALS[i] == SIGUSR1 ? SA_SIGINFO | SA_RESTART : SA_SIGINFO | SA_RESETHAND | SA_NODEFER;
+        struct sigaction previous{};
+        ::sigaction(DUMP_SIGNALS[i], &action, &previous);
+        // installed a second time, keep what was there before the first
+        if((previous.sa_flags & SA_SIGINFO) == 0 || previous.sa_sigaction != onDumpSignal) {
+            previousActions[i] = previous;
+        }
+    }
+}
+
+bool Cppelix::FlightRecorder::read(uint64_t index, FlightRecord &record, std::string_view &name) const noexcept {
+    auto &slot = _slots[index % CAPACITY];
+    auto sequence = slot.sequence.load(std::memory_order_acquire);
+    if(sequence % 2 != 0) {
+        return false;
+    }
+
+    record.type = slot.type.load(std::memory_order_relaxed);
+    record.id = slot.id.load(std::memory_order_relaxed);
+    record.originatingService = slot.originatingService.load(std::memory_order_relaxed);
+    record.priority = slot.priority.load(std::memory_order_relaxed);
+    record.enqueuedAt = slot.enqueuedAt.load(std::memory_order_relaxed);
+    record.dispatchedAt = slot.dispatchedAt.load(std::memory_order_relaxed);
+    record.handlerDuration = slot.handlerDuration.load(std::memory_order_relaxed);
+    name = std::string_view{slot.name.load(std::memory_order_relaxed), slot.nameLength.load(std::memory_order_relaxed)};
+
+    std::atomic_thread_fence(std::memory_order_acquire);
+    // overwritten meanwhile, by a later lap of the ring or by end()
+    return slot.sequence.load(std::memory_order_relaxed) == sequence;
+}
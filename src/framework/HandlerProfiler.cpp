@@ -0,0 +1,67 @@
+#include "framework/HandlerProfiler.h"
+#include <algorithm>
+
+void Cppelix::HandlerProfiler::invocation(uint64_t serviceId, std::string_view implementationName, uint64_t eventType, std::string_view eventName, std::chrono::nanoseconds duration) {
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(0, duration.count()));
+    std::lock_guard lg(_mutex);
+    auto &entry = _entries[CallbackKey{serviceId, eventType}];
+    if(!entry) {
+        entry = std::make_shared<Entry>(serviceId, implementationName, eventType, eventName);
+    }
+    entry->invocations++;
+    entry->totalNanoseconds += nanoseconds;
+    entry->nanoseconds.record(nanoseconds);
+}
+
+void Cppelix::HandlerProfiler::slice(uint64_t serviceId, uint64_t eventType, std::chrono::nanoseconds duration) {
+    auto nanoseconds = static_cast<uint64_t>(std::max<int64_t>(0, duration.count()));
+    std::lock_guard lg(_mutex);
+    auto entry = _entries.find(CallbackKey{serviceId, eventType});
+    if(entry == end(_entries)) {
+        return;
+    }
+
+    entry->second->slices++;
+    entry->second->totalNanoseconds += nanoseconds;
+    entry->second->nanoseconds.record(nanoseconds);
+}
+
+std::vector<Cppelix::HandlerLatencyRecord> Cppelix::HandlerProfiler::getRecords() const {
+    std::vector<HandlerLatencyRecord> records;
+    std::vector<std::shared_ptr<Entry>> entries;
+    {
+        // only the counters are copied under the lock, walking the histograms would hold up the event loop's invocation()
+        std::lock_guard lg(_mutex);
+        records.reserve(_entries.size());
+        entries.reserve(_entries.size());
+        for(auto const &[key, entry] : _entries) {
+            records.push_back(HandlerLatencyRecord{entry->serviceId, entry->implementationName, entry->eventType, entry->eventName, entry->invocations, entry->slices,
+                                                   std::chrono::nanoseconds(entry->totalNanoseconds)});
+            entries.push_back(entry);
+        }
+    }
+
+    // histograms take concurrent records
+    for(size_t i = 0; i < records.size(); i++) {
+        records[i].p50 = std::chrono::nanoseconds(entries[i]->nanoseconds.valueAtQuantile(0.5));
+        records[i].p99 = std::chrono::nanoseconds(entries[i]->nanoseconds.valueAtQuantile(0.99));
+        records[i].max = std::chrono::nanoseconds(entries[i]->nanoseconds.max());
+    }
+
+    std::sort(begin(records), end(records), [](const HandlerLatencyRecord &a, const HandlerLatencyRecord &b) {
+        return a.totalTime > b.totalTime;
+    });
+    return records;
+}
+
+void Cppelix::HandlerProfiler::serviceRemoved(uint64_t serviceId) {
+    std::lock_guard lg(_mutex);
+    std::erase_if(_entries, [serviceId](const auto &entry) noexcept {
+        return entry.second->serviceId == serviceId;
+    });
+}
+
+void Cppelix::HandlerProfiler::reset() {
+    std::lock_guard lg(_mutex);
+    _entries.clear();
+}
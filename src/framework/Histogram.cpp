@@ -0,0 +1,60 @@
+#include "framework/Histogram.h"
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+uint64_t Cppelix::Histogram::valueAtQuantile(double quantile) const noexcept {
+    auto total = count();
+    if(total == 0) {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(std::clamp(quantile, 0.0, 1.0) * static_cast<double>(total)));
+    rank = std::max<uint64_t>(rank, 1);
+
+    uint64_t seen = 0;
+    for(uint32_t bucket = 0; bucket < BUCKETS; bucket++) {
+        seen += _buckets[bucket].load(std::memory_order_relaxed);
+        if(seen >= rank) {
+            return std::min(highestValueOf(bucket), max());
+        }
+    }
+
+    // the total was read before buckets recorded into meanwhile
+    return max();
+}
+
+void Cppelix::Histogram::reset() noexcept {
+    for(uint32_t bucket = 0; bucket < BUCKETS; bucket++) {
+        _buckets[bucket].store(0, std::memory_order_relaxed);
+    }
+    _count.store(0, std::memory_order_relaxed);
+    _sum.store(0, std::memory_order_relaxed);
+    _max.store(0, std::memory_order_relaxed);
+}
+
+uint32_t Cppelix::Histogram::bucketOf(uint64_t value) noexcept {
+    if(value < SUB_BUCKETS) {
+        return static_cast<uint32_t>(value);
+    }
+
+    auto exponent = static_cast<uint32_t>(63 - std::countl_zero(value));
+    if(exponent >= MAX_EXPONENT) {
+        return BUCKETS - 1;
+    }
+
+    auto shift = exponent - SUB_BUCKET_BITS;
+    auto subBucket = static_cast<uint32_t>(value >> shift) & (SUB_BUCKETS - 1);
+    return SUB_BUCKETS + shift * SUB_BUCKETS + subBucket;
+}
+
+uint64_t Cppelix::Histogram::highestValueOf(uint32_t bucket) noexcept {
+    if(bucket < SUB_BUCKETS) {
+        return bucket;
+    }
+
+    auto shift = (bucket - SUB_BUCKETS) / SUB_BUCKETS;
+    auto subBucket = static_cast<uint64_t>((bucket - SUB_BUCKETS) % SUB_BUCKETS);
+    auto lowest = (SUB_BUCKETS + subBucket) << shift;
+    return lowest + (uint64_t{1} << shift) - 1;
+}
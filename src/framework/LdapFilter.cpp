@@ -0,0 +1,395 @@
+#include "framework/LdapFilter.h"
+#include "framework/LifecycleManager.h"
+#include <charconv>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace {
+    [[nodiscard]] std::string_view trim(std::string_view str) {
+        while(!str.empty() && str.front() == ' ') {
+            str.remove_prefix(1);
+        }
+        while(!str.empty() && str.back() == ' ') {
+            str.remove_suffix(1);
+        }
+        return str;
+    }
+
+    [[nodiscard]] bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+        if(a.size() != b.size()) {
+            return false;
+        }
+
+        for(size_t i = 0; i < a.size(); i++) {
+            if(std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    [[nodiscard]] std::string unescape(std::string_view value, std::string_view filter) {
+        std::string ret;
+        ret.reserve(value.size());
+
+        for(size_t i = 0; i < value.size(); i++) {
+            if(value[i] != '\\') {
+                ret.push_back(value[i]);
+                continue;
+            }
+
+            uint8_t c{};
+            if(i + 2 >= value.size() || std::from_chars(value.data() + i + 1, value.data() + i + 3, c, 16).ptr != value.data() + i + 3) {
+                throw std::runtime_error("Invalid escape sequence in filter " + std::string{filter});
+            }
+            ret.push_back(static_cast<char>(c));
+            i += 2;
+        }
+
+        return ret;
+    }
+
+    [[nodiscard]] Cppelix::LdapValue parseValue(std::string str) {
+        Cppelix::LdapValue value{std::move(str), {}, {}, {}};
+
+        int64_t integer{};
+        auto const *end = value.str.data() + value.str.size();
+        if(!value.str.empty() && std::from_chars(value.str.data(), end, integer).ptr == end) {
+            value.integer = integer;
+            value.floating = static_cast<double>(integer);
+            return value;
+        }
+
+        if(!value.str.empty()) {
+            char *parsedEnd = nullptr;
+            double floating = std::strtod(value.str.c_str(), &parsedEnd);
+            if(parsedEnd == end) {
+                value.floating = floating;
+            }
+        }
+
+        return value;
+    }
+
+    [[nodiscard]] bool matchesSubstring(std::string_view str, const std::vector<std::string> &segments) {
+        // segments.front() has to be a prefix and segments.back() a suffix, empty when the pattern starts/ends with a wildcard
+        if(!str.starts_with(segments.front())) {
+            return false;
+        }
+        str.remove_prefix(segments.front().size());
+
+        for(size_t i = 1; i + 1 < segments.size(); i++) {
+            auto pos = str.find(segments[i]);
+            if(pos == std::string_view::npos) {
+                return false;
+            }
+            str.remove_prefix(pos + segments[i].size());
+        }
+
+        return str.ends_with(segments.back());
+    }
+
+    template <typename T>
+    [[nodiscard]] bool compareOrdered(T property, T value, Cppelix::LdapOperation op) {
+        switch(op) {
+            case Cppelix::LdapOperation::EQUALS:
+            case Cppelix::LdapOperation::APPROX:
+                return property == value;
+            case Cppelix::LdapOperation::GREATER_OR_EQUAL:
+                return property >= value;
+            case Cppelix::LdapOperation::LESS_OR_EQUAL:
+                return property <= value;
+            default:
+                return false;
+        }
+    }
+
+    [[nodiscard]] std::optional<std::string_view> propertyAsString(const Cppelix::PropertyValue &property) {
+        if(auto const *str = property.get<std::string>()) {
+            return *str;
+        }
+        if(auto const *view = property.get<std::string_view>()) {
+            return *view;
+        }
+        if(auto const *cstr = property.get<const char*>()) {
+            return std::string_view{*cstr};
+        }
+        return {};
+    }
+
+    [[nodiscard]] std::optional<int64_t> propertyAsSigned(const Cppelix::PropertyValue &property) {
+        if(auto const *v = property.get<int64_t>()) { return *v; }
+        if(auto const *v = property.get<int32_t>()) { return *v; }
+        if(auto const *v = property.get<int16_t>()) { return *v; }
+        if(auto const *v = property.get<int8_t>()) { return *v; }
+        return {};
+    }
+
+    [[nodiscard]] std::optional<uint64_t> propertyAsUnsigned(const Cppelix::PropertyValue &property) {
+        if(auto const *v = property.get<uint64_t>()) { return *v; }
+        if(auto const *v = property.get<uint32_t>()) { return *v; }
+        if(auto const *v = property.get<uint16_t>()) { return *v; }
+        if(auto const *v = property.get<uint8_t>()) { return *v; }
+        return {};
+    }
+
+    [[nodiscard]] std::optional<double> propertyAsFloating(const Cppelix::PropertyValue &property) {
+        if(auto const *v = property.get<double>()) { return *v; }
+        if(auto const *v = property.get<float>()) { return *v; }
+        return {};
+    }
+
+    [[nodiscard]] bool compareProperty(const Cppelix::PropertyValue &property, Cppelix::LdapOperation op, const Cppelix::LdapValue &value) {
+        using Cppelix::LdapOperation;
+
+        if(auto str = propertyAsString(property)) {
+            switch(op) {
+                case LdapOperation::EQUALS:
+                    return *str == value.str;
+                case LdapOperation::APPROX:
+                    return equalsIgnoreCase(*str, value.str);
+                case LdapOperation::SUBSTRING:
+                    return matchesSubstring(*str, value.segments);
+                default:
+                    return compareOrdered(*str, std::string_view{value.str}, op);
+            }
+        }
+
+        if(op == LdapOperation::SUBSTRING) {
+            return false;
+        }
+
+        if(auto const *b = property.get<bool>()) {
+            std::string_view boolStr = *b ? "true" : "false";
+            return op == LdapOperation::APPROX ? equalsIgnoreCase(boolStr, value.str) : (op == LdapOperation::EQUALS && boolStr == value.str);
+        }
+
+        if(auto s = propertyAsSigned(property)) {
+            if(value.integer) {
+                return compareOrdered(*s, *value.integer, op);
+            }
+            return value.floating && compareOrdered(static_cast<double>(*s), *value.floating, op);
+        }
+
+        if(auto u = propertyAsUnsigned(property)) {
+            if(value.integer) {
+                if(*value.integer < 0) {
+                    return op == LdapOperation::GREATER_OR_EQUAL;
+                }
+                return compareOrdered(*u, static_cast<uint64_t>(*value.integer), op);
+            }
+            return value.floating && compareOrdered(static_cast<double>(*u), *value.floating, op);
+        }
+
+        if(auto f = propertyAsFloating(property)) {
+            return value.floating && compareOrdered(*f, *value.floating, op);
+        }
+
+        return false;
+    }
+}
+
+std::optional<std::string> Cppelix::propertyToFilterString(const PropertyValue &property) {
+    if(auto str = propertyAsString(property)) {
+        return std::string{*str};
+    }
+    if(auto const *b = property.get<bool>()) {
+        return std::string{*b ? "true" : "false"};
+    }
+    if(auto s = propertyAsSigned(property)) {
+        return std::to_string(*s);
+    }
+    if(auto u = propertyAsUnsigned(property)) {
+        return std::to_string(*u);
+    }
+    if(auto f = propertyAsFloating(property)) {
+        // filter values are only indexed in their integer form, a float equal to one of them compares equal and has to be found under it
+        if(std::trunc(*f) == *f && *f >= -0x1p63 && *f < 0x1p63) {
+            return std::to_string(static_cast<int64_t>(*f));
+        }
+    }
+    return {};
+}
+
+Cppelix::LdapFilter::LdapFilter(std::string_view filter) : _filter(filter) {
+    std::string_view remaining = trim(filter);
+    parseFilter(remaining, 0, false);
+
+    if(!trim(remaining).empty()) {
+        throw std::runtime_error("Trailing characters in filter " + _filter);
+    }
+
+    uint32_t depth = 0;
+    for(auto const &instruction : _program) {
+        switch(instruction.op) {
+            case LdapOperation::AND:
+            case LdapOperation::OR:
+                depth -= instruction.operand - 1;
+                break;
+            case LdapOperation::NOT:
+                break;
+            default:
+                depth++;
+                if(depth > MAX_STACK_DEPTH) {
+                    throw std::runtime_error("Filter too complex " + _filter);
+                }
+                break;
+        }
+    }
+}
+
+void Cppelix::LdapFilter::parseFilter(std::string_view &remaining, uint32_t depth, bool topLevelAnd) {
+    remaining = trim(remaining);
+    if(remaining.empty() || remaining.front() != '(') {
+        throw std::runtime_error("Expected '(' in filter " + _filter);
+    }
+    if(depth >= MAX_STACK_DEPTH) {
+        throw std::runtime_error("Filter nested too deeply " + _filter);
+    }
+    remaining.remove_prefix(1);
+
+    if(remaining.empty()) {
+        throw std::runtime_error("Unexpected end of filter " + _filter);
+    }
+
+    char type = remaining.front();
+    if(type == '&' || type == '|') {
+        remaining.remove_prefix(1);
+        uint32_t operands = 0;
+
+        while(!trim(remaining).empty() && trim(remaining).front() == '(') {
+            parseFilter(remaining, depth + 1, type == '&' && depth == 0);
+            operands++;
+
+            // fold every operand into the result right away, so the stack grows with nesting and not with the length of the list
+            if(operands > 1) {
+                _program.push_back(LdapInstruction{type == '&' ? LdapOperation::AND : LdapOperation::OR, 2, 0});
+            }
+        }
+
+        if(operands == 0) {
+            throw std::runtime_error("Empty filter list in filter " + _filter);
+        }
+    } else if(type == '!') {
+        remaining.remove_prefix(1);
+        parseFilter(remaining, depth + 1, false);
+        _program.push_back(LdapInstruction{LdapOperation::NOT, 0, 0});
+    } else {
+        auto end = remaining.find(')');
+        if(end == std::string_view::npos) {
+            throw std::runtime_error("Missing ')' in filter " + _filter);
+        }
+        parseItem(remaining.substr(0, end), topLevelAnd || depth == 0);
+        remaining.remove_prefix(end);
+    }
+
+    remaining = trim(remaining);
+    if(remaining.empty() || remaining.front() != ')') {
+        throw std::runtime_error("Expected ')' in filter " + _filter);
+    }
+    remaining.remove_prefix(1);
+}
+
+void Cppelix::LdapFilter::parseItem(std::string_view item, bool topLevelAnd) {
+    auto equals = item.find('=');
+    if(equals == std::string_view::npos || equals == 0) {
+        throw std::runtime_error("Missing comparison in filter " + _filter);
+    }
+
+    LdapOperation op = LdapOperation::EQUALS;
+    auto keyEnd = equals;
+    switch(item[equals - 1]) {
+        case '~': op = LdapOperation::APPROX; keyEnd--; break;
+        case '>': op = LdapOperation::GREATER_OR_EQUAL; keyEnd--; break;
+        case '<': op = LdapOperation::LESS_OR_EQUAL; keyEnd--; break;
+        default: break;
+    }
+
+    auto key = trim(item.substr(0, keyEnd));
+    auto rawValue = item.substr(equals + 1);
+    if(key.empty()) {
+        throw std::runtime_error("Missing key in filter " + _filter);
+    }
+
+    LdapValue value{};
+    if(op == LdapOperation::EQUALS && rawValue == "*") {
+        op = LdapOperation::PRESENT;
+    } else if(op == LdapOperation::EQUALS && rawValue.find('*') != std::string_view::npos) {
+        op = LdapOperation::SUBSTRING;
+        while(true) {
+            auto star = rawValue.find('*');
+            value.segments.push_back(unescape(rawValue.substr(0, star), _filter));
+            if(star == std::string_view::npos) {
+                break;
+            }
+            rawValue.remove_prefix(star + 1);
+        }
+    } else {
+        value = parseValue(unescape(rawValue, _filter));
+
+        // only index values that have the same string representation as an indexed property would
+        bool canonical = !value.floating || (value.integer && std::to_string(*value.integer) == value.str);
+        if(op == LdapOperation::EQUALS && topLevelAnd && canonical) {
+            _requiredEqualities.emplace_back(std::string{key}, value.str);
+        }
+    }
+
+    uint32_t keyIndex = 0;
+    while(keyIndex < _keys.size() && _keys[keyIndex] != key) {
+        keyIndex++;
+    }
+    if(keyIndex == _keys.size()) {
+        _keys.emplace_back(key);
+        _keyHashes.push_back(PropertyKey{key}.hash());
+    }
+
+    _values.push_back(std::move(value));
+    _program.push_back(LdapInstruction{op, keyIndex, static_cast<uint32_t>(_values.size() - 1)});
+}
+
+bool Cppelix::LdapFilter::matches(const CppelixProperties &properties) const {
+    std::array<bool, MAX_STACK_DEPTH> stack{};
+    uint32_t top = 0;
+
+    for(auto const &instruction : _program) {
+        switch(instruction.op) {
+            case LdapOperation::AND: {
+                bool result = true;
+                for(uint32_t i = 0; i < instruction.operand; i++) {
+                    result = result && stack[top - 1 - i];
+                }
+                top -= instruction.operand;
+                stack[top++] = result;
+            }
+                break;
+            case LdapOperation::OR: {
+                bool result = false;
+                for(uint32_t i = 0; i < instruction.operand; i++) {
+                    result = result || stack[top - 1 - i];
+                }
+                top -= instruction.operand;
+                stack[top++] = result;
+            }
+                break;
+            case LdapOperation::NOT:
+                stack[top - 1] = !stack[top - 1];
+                break;
+            default: {
+                auto property = properties.find(PropertyKey{_keyHashes[instruction.operand], _keys[instruction.operand]});
+                bool result = property != end(properties) &&
+                              (instruction.op == LdapOperation::PRESENT || compareProperty(property->second, instruction.op, _values[instruction.value]));
+                stack[top++] = result;
+            }
+                break;
+        }
+    }
+
+    return top == 1 && stack[0];
+}
+
+bool Cppelix::LdapFilterEntry::matches(const std::shared_ptr<ILifecycleManager> &manager) const {
+    return _filter->matches(*manager->getProperties());
+}
@@ -0,0 +1,115 @@
+#include "framework/Properties.h"
+#include <algorithm>
+#include <stdexcept>
+
+Cppelix::PropertyType Cppelix::propertyTypeOf(const std::type_info &type) noexcept {
+    if(type == typeid(bool)) { return PropertyType::BOOL; }
+    if(type == typeid(int8_t)) { return PropertyType::INT8; }
+    if(type == typeid(int16_t)) { return PropertyType::INT16; }
+    if(type == typeid(int32_t)) { return PropertyType::INT32; }
+    if(type == typeid(int64_t)) { return PropertyType::INT64; }
+    if(type == typeid(uint8_t)) { return PropertyType::UINT8; }
+    if(type == typeid(uint16_t)) { return PropertyType::UINT16; }
+    if(type == typeid(uint32_t)) { return PropertyType::UINT32; }
+    if(type == typeid(uint64_t)) { return PropertyType::UINT64; }
+    if(type == typeid(float)) { return PropertyType::FLOAT; }
+    if(type == typeid(double)) { return PropertyType::DOUBLE; }
+    if(type == typeid(std::string)) { return PropertyType::STRING; }
+    if(type == typeid(std::string_view)) { return PropertyType::STRING_VIEW; }
+    if(type == typeid(const char*)) { return PropertyType::C_STRING; }
+    return PropertyType::OTHER;
+}
+
+Cppelix::Properties::Properties(std::initializer_list<PropertyEntry> entries) {
+    if(entries.size() == 0) {
+        return;
+    }
+
+    _storage = std::make_shared<Storage>();
+    if(entries.size() > INLINE_CAPACITY) {
+        _storage->overflowEntries.reserve(entries.size());
+    }
+
+    for(auto const &entry : entries) {
+        // same semantics as the unordered_map this replaces: the first occurrence of a key wins
+        if(!contains(PropertyKey{entry.hash(), entry.first})) {
+            append(PropertyEntry{entry});
+        }
+    }
+}
+
+const Cppelix::PropertyValue& Cppelix::Properties::at(PropertyKey key) const {
+    auto it = find(key);
+    if(it == end()) {
+        throw std::out_of_range("No property " + std::string{key.name()});
+    }
+    return it->second;
+}
+
+Cppelix::PropertyValue& Cppelix::Properties::operator[](PropertyKey key) {
+    auto &storage = mutableStorage();
+    auto *entries = storage.data();
+    for(uint32_t i = 0; i < storage.size; i++) {
+        if(entries[i].matches(key)) {
+            return entries[i].second;
+        }
+    }
+
+    return const_cast<PropertyEntry*>(append(PropertyEntry{key, PropertyValue{}}))->second;
+}
+
+Cppelix::Properties::size_type Cppelix::Properties::erase(PropertyKey key) {
+    if(!contains(key)) {
+        return 0;
+    }
+
+    auto &storage = mutableStorage();
+    if(!storage.overflowEntries.empty()) {
+        auto it = std::find_if(storage.overflowEntries.begin(), storage.overflowEntries.end(), [&key](const PropertyEntry &entry) { return entry.matches(key); });
+        storage.overflowEntries.erase(it);
+        storage.size--;
+        return 1;
+    }
+
+    auto *entries = storage.inlineEntries.data();
+    uint32_t i = 0;
+    while(!entries[i].matches(key)) {
+        i++;
+    }
+    for(; i + 1 < storage.size; i++) {
+        entries[i] = std::move(entries[i + 1]);
+    }
+    storage.size--;
+    entries[storage.size] = PropertyEntry{};
+    return 1;
+}
+
+Cppelix::Properties::Storage& Cppelix::Properties::mutableStorage() {
+    if(!_storage) {
+        _storage = std::make_shared<Storage>();
+    } else if(_storage.use_count() > 1) {
+        _storage = std::make_shared<Storage>(*_storage);
+    }
+    return *_storage;
+}
+
+Cppelix::Properties::iterator Cppelix::Properties::append(PropertyEntry &&entry) {
+    auto &storage = mutableStorage();
+
+    if(storage.overflowEntries.empty() && storage.size < INLINE_CAPACITY) {
+        storage.inlineEntries[storage.size] = std::move(entry);
+        return &storage.inlineEntries[storage.size++];
+    }
+
+    if(storage.overflowEntries.empty()) {
+        storage.overflowEntries.reserve(INLINE_CAPACITY * 2);
+        for(auto &inlineEntry : storage.inlineEntries) {
+            storage.overflowEntries.push_back(std::move(inlineEntry));
+            inlineEntry = PropertyEntry{};
+        }
+    }
+
+    storage.overflowEntries.push_back(std::move(entry));
+    storage.size++;
+    return &storage.overflowEntries.back();
+}
@@ -0,0 +1,95 @@
+#include "framework/QueueMetrics.h"
+#include <algorithm>
+
+void Cppelix::QueueMetrics::setEnabled(bool enabled) {
+    if(enabled) {
+        // before the release store below, the event loop only touches the histograms after seeing it
+        std::call_once(_histogramsCreated, [this] {
+            for(auto &slot : _waitByPriority) {
+                slot.wait = std::make_unique<Histogram>();
+            }
+        });
+    }
+    _enabled.store(enabled, std::memory_order_release);
+}
+
+void Cppelix::QueueMetrics::dispatched(uint64_t priority, uint64_t enqueuedAt) noexcept {
+    _dispatched.fetch_add(1, std::memory_order_relaxed);
+    // the flight recorder stamps events as well
+    if(enqueuedAt == 0 || !enabled()) {
+        return;
+    }
+
+    auto now = timestamp();
+    auto wait = now > enqueuedAt ? now - enqueuedAt : 0;
+    _wait.record(wait);
+    if(priority == UNUSED_SLOT) {
+        return;
+    }
+
+    // only this thread claims slots, the first unused one ends the ones in use
+    for(auto &slot : _waitByPriority) {
+        auto slotPriority = slot.priority.load(std::memory_order_relaxed);
+        if(slotPriority == UNUSED_SLOT) {
+            slot.wait->record(wait);
+            slot.priority.store(priority, std::memory_order_release);
+            return;
+        }
+        if(slotPriority == priority) {
+            slot.wait->record(wait);
+            return;
+        }
+    }
+}
+
+Cppelix::QueueMetrics::DepthSlot& Cppelix::QueueMetrics::depthSlotOf(uint64_t priority) noexcept {
+    if(priority == UNUSED_SLOT) {
+        return _depthOfOtherPriorities;
+    }
+
+    // pushes from any thread race to claim slots, a slot never changes its priority once claimed
+    for(auto &slot : _depthByPriority) {
+        auto slotPriority = slot.priority.load(std::memory_order_acquire);
+        if(slotPriority == UNUSED_SLOT && slot.priority.compare_exchange_strong(slotPriority, priority, std::memory_order_acq_rel)) {
+            return slot;
+        }
+        if(slotPriority == priority) {
+            return slot;
+        }
+    }
+    return _depthOfOtherPriorities;
+}
+
+void Cppelix::QueueMetrics::fill(QueueMetricsSnapshot &snapshot) const {
+    snapshot.pushed = _pushed.load(std::memory_order_relaxed);
+    snapshot.dispatched = _dispatched.load(std::memory_order_relaxed);
+    snapshot.wait = _wait.summarize();
+
+    snapshot.depthByPriority.clear();
+    for(auto const &slot : _depthByPriority) {
+        // slots are claimed in order, but a claim may become visible here before the one of the slot in front of it
+        auto priority = slot.priority.load(std::memory_order_acquire);
+        if(priority == UNUSED_SLOT) {
+            continue;
+        }
+        if(auto depth = slot.depth(); depth > 0) {
+            snapshot.depthByPriority.emplace_back(priority, depth);
+        }
+    }
+    std::sort(begin(snapshot.depthByPriority), end(snapshot.depthByPriority));
+    snapshot.depthOfOtherPriorities = _depthOfOtherPriorities.depth();
+
+    snapshot.depth = snapshot.depthOfOtherPriorities;
+    for(auto const &[priority, depth] : snapshot.depthByPriority) {
+        snapshot.depth += depth;
+    }
+
+    snapshot.waitByPriority.clear();
+    for(auto const &slot : _waitByPriority) {
+        auto priority = slot.priority.load(std::memory_order_acquire);
+        if(priority == UNUSED_SLOT) {
+            break;
+        }
+        snapshot.waitByPriority.emplace_back(priority, slot.wait->summarize());
+    }
+}
@@ -1,13 +1,44 @@
 #include "framework/Service.h"
+#include "framework/DependencyManager.h"
+#include "framework/ConstevalHash.h"
+#include <random>
+
+namespace {
+    // wyrand, seeded once per thread. sole::uuid4() goes through a mutex protected std::random_device for every id, which
+    // showed up when creating services in bulk. Gids only have to be unique, not unpredictable.
+    sole::uuid fastUuid4() noexcept {
+        thread_local uint64_t state = [] {
+            std::random_device rd;
+            return (static_cast<uint64_t>(rd()) << 32U) ^ rd();
+        }();
+
+        auto next = [] {
+            state += 0xa0761d6478bd642fULL;
+            return consteval_wymum(state ^ 0xe7037ed1a0b428dbULL, state);
+        };
+
+        sole::uuid gid;
+        gid.ab = (next() & 0xFFFFFFFFFFFF0FFFULL) | 0x0000000000004000ULL;
+        gid.cd = (next() & 0x3FFFFFFFFFFFFFFFULL) | 0x8000000000000000ULL;
+        return gid;
+    }
+}
 
 std::atomic<uint64_t> Cppelix::Service::_serviceIdCounter = 1;
+thread_local uint64_t Cppelix::Service::_nextServiceId = 0;
 
-Cppelix::Service::Service() noexcept : IService(), _serviceId(_serviceIdCounter.fetch_add(1, std::memory_order_acq_rel)), _serviceGid(sole::uuid4()), _serviceState(ServiceState::INSTALLED) {
+Cppelix::Service::Service() noexcept : IService(), _serviceId(takeServiceId()), _serviceGid(fastUuid4()), _serviceState(ServiceState::INSTALLED) {
 
 }
 
-Cppelix::Service::Service(Cppelix::CppelixProperties props) noexcept : IService(), _properties(std::move(props)), _serviceId(_serviceIdCounter.fetch_add(1, std::memory_order_acq_rel)), _serviceGid(sole::uuid4()), _serviceState(ServiceState::INSTALLED) {
+Cppelix::Service::Service(Cppelix::CppelixProperties props) noexcept : IService(), _properties(std::move(props)), _serviceId(takeServiceId()), _serviceGid(fastUuid4()), _serviceState(ServiceState::INSTALLED) {
+
+}
 
+uint64_t Cppelix::Service::takeServiceId() noexcept {
+    // reserved ids are (generation << 40) | (owner << 20) | slot with a generation of at least 1, the fallback counter can't realistically reach them
+    auto id = std::exchange(_nextServiceId, 0);
+    return id != 0 ? id : _serviceIdCounter.fetch_add(1, std::memory_order_acq_rel);
 }
 
 Cppelix::Service::~Service() {
@@ -19,12 +50,32 @@ Cppelix::Service::~Service() {
 
 
 bool Cppelix::Service::internal_start() {
+    if(!internal_prepare_start()) {
+        return false;
+    }
+
+    return internal_finish_start(internal_run_start());
+}
+
+bool Cppelix::Service::internal_prepare_start() {
     if(_serviceState != ServiceState::INSTALLED) {
         return false;
     }
 
     _serviceState = ServiceState::STARTING;
-    if(start()) {
+    return true;
+}
+
+bool Cppelix::Service::internal_run_start() {
+    auto &profiler = _manager->getStartupProfiler();
+    profiler.startBegin(_serviceId);
+    bool started = start();
+    profiler.startEnd(_serviceId, started);
+    return started;
+}
+
+bool Cppelix::Service::internal_finish_start(bool started) {
+    if(started) {
         _serviceState = ServiceState::ACTIVE;
         return true;
     } else {
@@ -35,12 +86,28 @@ bool Cppelix::Service::internal_start() {
 }
 
 bool Cppelix::Service::internal_stop() {
-    if(_serviceState != ServiceState::ACTIVE) {
+    if(!internal_prepare_stop()) {
         return true;
     }
 
+    return internal_finish_stop(internal_run_stop());
+}
+
+bool Cppelix::Service::internal_prepare_stop() {
+    if(_serviceState != ServiceState::ACTIVE) {
+        return false;
+    }
+
     _serviceState = ServiceState::STOPPING;
-    if(stop()) {
+    return true;
+}
+
+bool Cppelix::Service::internal_run_stop() {
+    return stop();
+}
+
+bool Cppelix::Service::internal_finish_stop(bool stopped) {
+    if(stopped) {
         _serviceState = ServiceState::INSTALLED;
         return true;
     } else {
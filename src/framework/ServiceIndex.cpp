@@ -0,0 +1,208 @@
+#include "framework/ServiceIndex.h"
+#include "framework/LifecycleManager.h"
+#include "framework/Filter.h"
+#include <algorithm>
+
+namespace {
+    void insertSorted(std::vector<uint64_t> &ids, uint64_t id) {
+        // service ids are mostly handed out in increasing order, so this nearly always appends
+        if(ids.empty() || ids.back() < id) {
+            ids.push_back(id);
+            return;
+        }
+
+        auto it = std::lower_bound(begin(ids), end(ids), id);
+        if(it == end(ids) || *it != id) {
+            ids.insert(it, id);
+        }
+    }
+
+    void eraseSorted(std::vector<uint64_t> &ids, uint64_t id) {
+        auto it = std::lower_bound(begin(ids), end(ids), id);
+        if(it != end(ids) && *it == id) {
+            ids.erase(it);
+        }
+    }
+
+    template <typename FuncT>
+    void forEachRequestedInterface(const Cppelix::ILifecycleManager &manager, FuncT &&func) {
+        auto const *registry = manager.getDependencyRegistry();
+        if(registry == nullptr) {
+            return;
+        }
+
+        for(auto const &registration : registry->_registrations) {
+            func(registration.dependency.interfaceNameHash);
+        }
+    }
+
+    void mergeInto(std::vector<uint64_t> &out, const std::vector<uint64_t> &ids) {
+        if(out.empty()) {
+            out = ids;
+            return;
+        }
+
+        std::vector<uint64_t> merged;
+        merged.reserve(out.size() + ids.size());
+        std::set_union(begin(out), end(out), begin(ids), end(ids), std::back_inserter(merged));
+        out.swap(merged);
+    }
+}
+
+void Cppelix::ServiceIndex::add(const std::shared_ptr<ILifecycleManager> &manager) {
+    auto serviceId = manager->serviceId();
+
+    for(auto const &interface : manager->getInterfaces()) {
+        insertSorted(_providersByInterface[interface.interfaceNameHash], serviceId);
+    }
+
+    forEachRequestedInterface(*manager, [this, serviceId](uint64_t interfaceNameHash) {
+        insertSorted(_dependentsByInterface[interfaceNameHash], serviceId);
+    });
+
+    for(auto const &[key, value] : *manager->getProperties()) {
+        if(auto str = propertyToFilterString(value)) {
+            insertSorted(_servicesByProperty[key][*str], serviceId);
+        }
+    }
+}
+
+void Cppelix::ServiceIndex::remove(const std::shared_ptr<ILifecycleManager> &manager) {
+    auto serviceId = manager->serviceId();
+
+    for(auto const &interface : manager->getInterfaces()) {
+        auto providers = _providersByInterface.find(interface.interfaceNameHash);
+        if(providers != end(_providersByInterface)) {
+            eraseSorted(providers->second, serviceId);
+        }
+    }
+
+    forEachRequestedInterface(*manager, [this, serviceId](uint64_t interfaceNameHash) {
+        auto dependents = _dependentsByInterface.find(interfaceNameHash);
+        if(dependents != end(_dependentsByInterface)) {
+            eraseSorted(dependents->second, serviceId);
+        }
+    });
+
+    for(auto const &[key, value] : *manager->getProperties()) {
+        auto str = propertyToFilterString(value);
+        if(!str) {
+            continue;
+        }
+
+        auto values = _servicesByProperty.find(key);
+        if(values == end(_servicesByProperty)) {
+            continue;
+        }
+
+        auto ids = values->second.find(*str);
+        if(ids == end(values->second)) {
+            continue;
+        }
+
+        eraseSorted(ids->second, serviceId);
+        if(ids->second.empty()) {
+            values->second.erase(ids);
+        }
+    }
+}
+
+void Cppelix::ServiceIndex::clear() noexcept {
+    _dependentsByInterface.clear();
+    _providersByInterface.clear();
+    _servicesByProperty.clear();
+}
+
+void Cppelix::ServiceIndex::findDependents(const ILifecycleManager &provider, const Filter *filter, std::vector<uint64_t> &out) const {
+    out.clear();
+
+    std::vector<std::vector<uint64_t> const *> dependentLists;
+    for(auto const &interface : provider.getInterfaces()) {
+        auto dependents = _dependentsByInterface.find(interface.interfaceNameHash);
+        if(dependents != end(_dependentsByInterface) && !dependents->second.empty()) {
+            dependentLists.push_back(&dependents->second);
+        }
+    }
+
+    if(dependentLists.empty()) {
+        return;
+    }
+
+    auto isDependent = [&dependentLists](uint64_t id) {
+        return std::any_of(begin(dependentLists), end(dependentLists), [id](std::vector<uint64_t> const *ids) {
+            return std::binary_search(begin(*ids), end(*ids), id);
+        });
+    };
+
+    FilterIndexTerms const *terms = filter != nullptr ? &filter->indexTerms() : nullptr;
+
+    if(terms != nullptr && terms->serviceId) {
+        if(isDependent(*terms->serviceId)) {
+            out.push_back(*terms->serviceId);
+        }
+        return;
+    }
+
+    if(terms == nullptr || terms->equalities.empty()) {
+        for(auto const *ids : dependentLists) {
+            mergeInto(out, *ids);
+        }
+        return;
+    }
+
+    // walk the smallest posting list and check membership in the rest
+    std::vector<std::vector<uint64_t> const *> postings;
+    postings.reserve(terms->equalities.size());
+    for(auto const &[key, value] : terms->equalities) {
+        auto values = _servicesByProperty.find(key);
+        if(values == end(_servicesByProperty)) {
+            return;
+        }
+
+        auto ids = values->second.find(value);
+        if(ids == end(values->second)) {
+            return;
+        }
+
+        postings.push_back(&ids->second);
+    }
+
+    std::sort(begin(postings), end(postings), [](std::vector<uint64_t> const *a, std::vector<uint64_t> const *b) {
+        return a->size() < b->size();
+    });
+
+    for(auto id : *postings.front()) {
+        bool inAll = std::all_of(begin(postings) + 1, end(postings), [id](std::vector<uint64_t> const *ids) {
+            return std::binary_search(begin(*ids), end(*ids), id);
+        });
+
+        if(inAll && isDependent(id)) {
+            out.push_back(id);
+        }
+    }
+}
+
+void Cppelix::ServiceIndex::findProviders(const ILifecycleManager &dependent, std::vector<uint64_t> &out) const {
+    out.clear();
+
+    forEachRequestedInterface(dependent, [this, &out](uint64_t interfaceNameHash) {
+        auto providers = _providersByInterface.find(interfaceNameHash);
+        if(providers != end(_providersByInterface)) {
+            mergeInto(out, providers->second);
+        }
+    });
+}
+
+bool Cppelix::ServiceIndex::hasDependents(uint64_t interfaceNameHash) const noexcept {
+    auto dependents = _dependentsByInterface.find(interfaceNameHash);
+    return dependents != end(_dependentsByInterface) && !dependents->second.empty();
+}
+
+void Cppelix::ServiceIndex::findRequesters(uint64_t interfaceNameHash, std::vector<uint64_t> &out) const {
+    out.clear();
+
+    auto dependents = _dependentsByInterface.find(interfaceNameHash);
+    if(dependents != end(_dependentsByInterface)) {
+        out = dependents->second;
+    }
+}
@@ -0,0 +1,78 @@
+#include "framework/ServiceRegistry.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+uint64_t Cppelix::ServiceRegistry::reserve() {
+    uint32_t slot;
+    if(!_freeSlots.empty()) {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    } else {
+        if(_slots.size() > SLOT_MASK) {
+            throw std::runtime_error("Out of service slots");
+        }
+
+        // every slot fits in the free list without growing it, so retire() never allocates
+        if(_freeSlots.capacity() <= _slots.size()) {
+            _freeSlots.reserve(std::max<size_t>(_slots.size() + 1, 2 * _freeSlots.capacity()));
+        }
+
+        slot = static_cast<uint32_t>(_slots.size());
+        // generation 0 is never handed out, so id 0 keeps meaning "no service"
+        _slots.push_back(Slot{1, FREE});
+    }
+
+    _slots[slot].denseIndex = RESERVED;
+    return (static_cast<uint64_t>(_slots[slot].generation) << (SLOT_BITS + OWNER_BITS)) | (static_cast<uint64_t>(_owner) << SLOT_BITS) | slot;
+}
+
+void Cppelix::ServiceRegistry::release(uint64_t serviceId) noexcept {
+    if(denseIndexOf(serviceId) == RESERVED) {
+        retire(slotOf(serviceId));
+    }
+}
+
+void Cppelix::ServiceRegistry::insert(uint64_t serviceId, std::shared_ptr<ILifecycleManager> manager) {
+    if(denseIndexOf(serviceId) != RESERVED) {
+        throw std::runtime_error("Service id " + std::to_string(serviceId) + " was not reserved");
+    }
+
+    _slots[slotOf(serviceId)].denseIndex = static_cast<uint32_t>(_entries.size());
+    _entries.emplace_back(serviceId, std::move(manager));
+}
+
+bool Cppelix::ServiceRegistry::erase(uint64_t serviceId) {
+    auto index = denseIndexOf(serviceId);
+    if(index >= _entries.size()) {
+        return false;
+    }
+
+    // destroy the manager only once the registry is consistent again, its destructor may push events
+    auto removed = std::move(_entries[index].second);
+    if(index != _entries.size() - 1) {
+        _entries[index] = std::move(_entries.back());
+        _slots[slotOf(_entries[index].first)].denseIndex = index;
+    }
+    _entries.pop_back();
+    retire(slotOf(serviceId));
+
+    return true;
+}
+
+void Cppelix::ServiceRegistry::clear() noexcept {
+    // retire instead of forgetting the slots, ids handed out before clear() must stay stale
+    for(auto const &[serviceId, manager] : _entries) {
+        retire(slotOf(serviceId));
+    }
+    _entries.clear();
+}
+
+void Cppelix::ServiceRegistry::retire(uint32_t slot) noexcept {
+    _slots[slot].denseIndex = FREE;
+    // a slot whose generation wrapped around is never reused, its ids could otherwise match again
+    _slots[slot].generation = (_slots[slot].generation + 1) & GENERATION_MASK;
+    if(_slots[slot].generation != 0) {
+        _freeSlots.push_back(slot);
+    }
+}
@@ -0,0 +1,153 @@
+#include "framework/ShardedRuntime.h"
+#include "framework/ConstevalHash.h"
+#include <linux/mempolicy.h>
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    struct CurrentShard final {
+        Cppelix::ShardedRuntime *runtime{nullptr};
+        size_t shard{0};
+    };
+
+    thread_local CurrentShard currentShardOfThread{};
+
+    std::vector<uint32_t> allowedCores() {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        std::vector<uint32_t> cores;
+        if(sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for(uint32_t core = 0; core < CPU_SETSIZE; core++) {
+                if(CPU_ISSET(core, &set)) {
+                    cores.push_back(core);
+                }
+            }
+        }
+
+        if(cores.empty()) {
+            for(uint32_t core = 0; core < std::max(std::thread::hardware_concurrency(), 1U); core++) {
+                cores.push_back(core);
+            }
+        }
+        return cores;
+    }
+}
+
+Cppelix::ShardedRuntime::ShardedRuntime(ShardedRuntimeOptions options) : _cores(options.cores.empty() ? allowedCores() : std::move(options.cores)),
+        _pinThreads(options.pinThreads), _numaLocal(options.numaLocal), _setups(_cores.size()), _managers(_cores.size()) {
+    for(auto core : _cores) {
+        if(core >= CPU_SETSIZE) {
+            throw std::runtime_error("Core out of range");
+        }
+    }
+}
+
+Cppelix::ShardedRuntime::~ShardedRuntime() {
+    stop();
+    join();
+}
+
+size_t Cppelix::ShardedRuntime::shardOf(uint64_t key) const noexcept {
+    return consteval_wymum(key ^ 0x8bb84b93962eacc9ULL, 0x4b33a62ed433d4a3ULL) % _cores.size();
+}
+
+void Cppelix::ShardedRuntime::onEveryShard(std::function<void(DependencyManager&, size_t)> setup) {
+    checkNotStarted();
+    for(auto &setups : _setups) {
+        setups.push_back(setup);
+    }
+}
+
+void Cppelix::ShardedRuntime::start() {
+    checkNotStarted();
+    _started = true;
+
+    _threads.reserve(_cores.size());
+    for(size_t shard = 0; shard < _cores.size(); shard++) {
+        _threads.emplace_back([this, shard] { runShard(shard); });
+    }
+
+    std::unique_lock l(_readyMutex);
+    _readyCondition.wait(l, [this] { return _readyShards == _cores.size(); });
+}
+
+void Cppelix::ShardedRuntime::stop() {
+    if(!_started) {
+        return;
+    }
+
+    for(auto &manager : _managers) {
+        if(manager) {
+            manager->pushEvent<QuitEvent>(0);
+        }
+    }
+}
+
+void Cppelix::ShardedRuntime::join() {
+    for(auto &thread : _threads) {
+        if(thread.joinable()) {
+            thread.join();
+        }
+    }
+
+    // only the shards could still be pushing into each other, the managers removed themselves from the channel when they quit
+    for(auto &manager : _managers) {
+        manager.reset();
+    }
+}
+
+Cppelix::ShardedRuntime* Cppelix::ShardedRuntime::current() noexcept {
+    return currentShardOfThread.runtime;
+}
+
+std::optional<size_t> Cppelix::ShardedRuntime::currentShard() noexcept {
+    if(currentShardOfThread.runtime == nullptr) {
+        return {};
+    }
+    return currentShardOfThread.shard;
+}
+
+void Cppelix::ShardedRuntime::checkNotStarted() const {
+    if(_started) {
+        throw std::runtime_error("ShardedRuntime already started");
+    }
+}
+
+void Cppelix::ShardedRuntime::runShard(size_t shard) {
+    currentShardOfThread = CurrentShard{this, shard};
+
+    if(_pinThreads) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(_cores[shard], &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+    }
+
+    if(_numaLocal) {
+        // from now on pages first touched by this thread come from the node it runs on. Done through the syscall to not depend on libnuma.
+        syscall(SYS_set_mempolicy, MPOL_LOCAL, nullptr, 0);
+    }
+
+    // constructed here so that the manager's memory is local to the shard as well
+    auto manager = std::make_unique<DependencyManager>();
+    _channel.addManager(manager.get());
+    auto &dm = *manager;
+    _managers[shard] = std::move(manager);
+
+    {
+        std::unique_lock l(_readyMutex);
+        _readyShards++;
+    }
+    _readyCondition.notify_all();
+
+    for(auto &setup : _setups[shard]) {
+        setup(dm, shard);
+    }
+    _setups[shard].clear();
+
+    dm.start();
+}
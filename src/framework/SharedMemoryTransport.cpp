@@ -0,0 +1,502 @@
+#include "framework/SharedMemoryTransport.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <csignal>
+#include <stdexcept>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+namespace {
+    // Layout of the segment: SegmentHeader, maxManagers RingControls, then maxManagers rings of ringBytes each.
+    // The segment is shared between processes, so everything in it is a plain integer accessed through std::atomic_ref.
+
+    constexpr uint64_t SEGMENT_MAGIC = 0x43505058'53484d32ULL; // "CPPXSHM2"
+    constexpr uint32_t SEGMENT_UNINITIALIZED = 0;
+    constexpr uint32_t SEGMENT_INITIALIZING = 1;
+    constexpr uint32_t SEGMENT_READY = 2;
+
+    constexpr uint32_t RING_FREE = 0;
+    constexpr uint32_t RING_CLAIMED = 1;
+    constexpr uint32_t RING_ACTIVE = 2;
+
+    constexpr uint64_t COMMITTED_BIT = 1ULL << 63U;
+    constexpr uint64_t PADDING_BIT = 1ULL << 31U;
+    constexpr uint64_t LENGTH_MASK = PADDING_BIT - 1;
+    constexpr uint32_t SPIN_ITERATIONS = 4'000;
+
+    uint32_t spinIterations() noexcept {
+        // on a single core, spinning only keeps the sender from running
+        static const uint32_t iterations = std::thread::hardware_concurrency() > 1 ? SPIN_ITERATIONS : 0;
+        return iterations;
+    }
+
+    struct alignas(64) SegmentHeader final {
+        uint64_t magic;
+        uint32_t state;
+        uint32_t maxManagers;
+        uint32_t ringBytes;
+    };
+
+    struct alignas(64) RingControl final {
+        uint32_t state;
+        uint32_t generation;
+        int32_t pid;
+        char name[Cppelix::SharedMemoryTransport::MAX_NAME_LENGTH + 1];
+        alignas(64) uint64_t tail; // reserved by producers while holding reserver
+        int32_t reserver; // pid of the process reserving space, 0 when none
+        alignas(64) uint64_t head; // advanced by the owning process once a record is handled
+        alignas(64) uint32_t doorbell; // futex word, bumped when a record is committed while the owner sleeps
+        uint32_t sleeping;
+    };
+
+    /// Records are 8 byte aligned and never wrap, a record that does not fit before the end of the ring is preceded by padding.
+    /// state is 0 while the space is free. Reserving sets the length and the pid of the producer, committing the record adds COMMITTED_BIT.
+    /// The consumer zeroes a handled record so state reads 0 again next time around.
+    struct RecordHeader final {
+        uint64_t state; // COMMITTED_BIT | pid << 32 | length of the whole record including this header, with PADDING_BIT for padding
+        uint32_t payloadSize;
+        uint32_t serialized;
+        uint64_t eventType;
+        uint64_t argsHash;
+        uint64_t originatingService;
+    };
+
+    constexpr uint64_t recordState(int32_t writer, uint64_t length) noexcept {
+        return static_cast<uint64_t>(static_cast<uint32_t>(writer)) << 32U | length;
+    }
+
+    constexpr uint64_t lengthOf(uint64_t state) noexcept {
+        return state & LENGTH_MASK;
+    }
+
+    constexpr int32_t writerOf(uint64_t state) noexcept {
+        return static_cast<int32_t>((state >> 32U) & 0x7FFF'FFFFU);
+    }
+
+    template <typename T>
+    std::atomic_ref<T> atomic(T &value) noexcept {
+        return std::atomic_ref<T>(value);
+    }
+
+    constexpr uint64_t alignRecord(uint64_t size) noexcept {
+        return (size + 7U) & ~uint64_t{7U};
+    }
+
+    std::string segmentName(std::string name) {
+        if(name.empty() || name.front() != '/') {
+            name.insert(name.begin(), '/');
+        }
+        return name;
+    }
+
+    bool processAlive(int32_t pid) noexcept {
+        return pid > 0 && (kill(pid, 0) == 0 || errno != ESRCH);
+    }
+
+    void futexWait(uint32_t *word, uint32_t expected, std::chrono::milliseconds timeout) noexcept {
+        timespec ts{};
+        ts.tv_sec = static_cast<time_t>(timeout.count() / 1'000);
+        ts.tv_nsec = static_cast<long>((timeout.count() % 1'000) * 1'000'000);
+        // not FUTEX_PRIVATE_FLAG, the word is shared with other processes
+        syscall(SYS_futex, word, FUTEX_WAIT, expected, &ts, nullptr, 0);
+    }
+
+    void futexWakeAll(uint32_t *word) noexcept {
+        syscall(SYS_futex, word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+    }
+
+    /// Zero a handled record, so its space reads as free when the ring comes around
+    /// \return head past the record
+    uint64_t zeroRecord(RecordHeader *record, uint64_t head, uint64_t length) noexcept {
+        atomic(record->state).store(0, std::memory_order_relaxed);
+        std::memset(reinterpret_cast<std::byte*>(record) + sizeof(uint64_t), 0, length - sizeof(uint64_t));
+        return head + length;
+    }
+
+    SegmentHeader& segmentHeader(std::byte *segment) noexcept {
+        return *reinterpret_cast<SegmentHeader*>(segment);
+    }
+
+    /// Take the lock on reserving space in a ring, from a holder that died as well, which never gives it back itself
+    /// \return false when a process that is alive or wasn't checked holds it
+    bool tryLockReservation(RingControl &control, int32_t self, bool checkHolder) noexcept {
+        int32_t holder = 0;
+        if(atomic(control.reserver).compare_exchange_strong(holder, self, std::memory_order_acquire, std::memory_order_relaxed)) {
+            return true;
+        }
+        return checkHolder && !processAlive(holder) && atomic(control.reserver).compare_exchange_strong(holder, self, std::memory_order_acquire, std::memory_order_relaxed);
+    }
+
+    RingControl& ringControl(std::byte *segment, uint32_t ring) noexcept {
+        return reinterpret_cast<RingControl*>(segment + sizeof(SegmentHeader))[ring];
+    }
+
+    std::byte* ringData(std::byte *segment, uint32_t maxManagers, uint32_t ringBytes, uint32_t ring) noexcept {
+        return segment + sizeof(SegmentHeader) + sizeof(RingControl) * maxManagers + static_cast<size_t>(ringBytes) * ring;
+    }
+
+    uint64_t remoteId(uint32_t generation, uint32_t ring) noexcept {
+        return Cppelix::SharedMemoryTransport::REMOTE_MANAGER_BIT | (static_cast<uint64_t>(generation & 0x7FFF'FFFFU) << 32U) | ring;
+    }
+}
+
+Cppelix::SharedMemoryTransport::SharedMemoryTransport(std::string name, uint32_t maxManagers, uint32_t ringBytes) :
+        _name(segmentName(std::move(name))), _maxManagers(maxManagers), _ringBytes(ringBytes),
+        _segmentSize(sizeof(SegmentHeader) + (sizeof(RingControl) + static_cast<size_t>(ringBytes)) * maxManagers), _segment(nullptr) {
+    if(maxManagers == 0 || ringBytes < 4096 || (ringBytes & (ringBytes - 1)) != 0) {
+        throw std::runtime_error("SharedMemoryTransport needs at least one manager and a power of two ring size of at least 4096 bytes");
+    }
+
+    int fd = shm_open(_name.c_str(), O_RDWR | O_CREAT, 0600);
+    if(fd < 0) {
+        throw std::runtime_error("Couldn't open shared memory segment " + _name + ": " + std::strerror(errno));
+    }
+
+    struct stat st{};
+    // concurrent creators truncate to the same size, whoever comes first wins
+    if(fstat(fd, &st) != 0 || (st.st_size == 0 && ftruncate(fd, static_cast<off_t>(_segmentSize)) != 0) || (fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) != _segmentSize)) {
+        close(fd);
+        throw std::runtime_error("Shared memory segment " + _name + " has a different size than expected");
+    }
+
+    void *mapping = mmap(nullptr, _segmentSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(mapping == MAP_FAILED) {
+        throw std::runtime_error("Couldn't map shared memory segment " + _name + ": " + std::strerror(errno));
+    }
+    _segment = static_cast<std::byte*>(mapping);
+
+    auto &header = segmentHeader(_segment);
+    uint32_t state = SEGMENT_UNINITIALIZED;
+    if(atomic(header.state).compare_exchange_strong(state, SEGMENT_INITIALIZING, std::memory_order_acq_rel)) {
+        // ftruncate zero filled the segment, every ring starts out free and empty
+        header.magic = SEGMENT_MAGIC;
+        header.maxManagers = maxManagers;
+        header.ringBytes = ringBytes;
+        atomic(header.state).store(SEGMENT_READY, std::memory_order_release);
+    } else {
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(1);
+        while(atomic(header.state).load(std::memory_order_acquire) != SEGMENT_READY && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    }
+
+    if(atomic(header.state).load(std::memory_order_acquire) != SEGMENT_READY || header.magic != SEGMENT_MAGIC || header.maxManagers != maxManagers || header.ringBytes != ringBytes) {
+        munmap(_segment, _segmentSize);
+        throw std::runtime_error("Shared memory segment " + _name + " was created with a different layout");
+    }
+}
+
+Cppelix::SharedMemoryTransport::~SharedMemoryTransport() {
+    std::vector<DependencyManager*> managers;
+    {
+        std::lock_guard l(_attachmentsMutex);
+        for(auto const &attachment : _attachments) {
+            managers.push_back(attachment->manager);
+        }
+    }
+
+    for(auto *manager : managers) {
+        detachManager(manager);
+    }
+
+    munmap(_segment, _segmentSize);
+}
+
+void Cppelix::SharedMemoryTransport::unlink(std::string name) {
+    shm_unlink(segmentName(std::move(name)).c_str());
+}
+
+uint64_t Cppelix::SharedMemoryTransport::attachManager(DependencyManager *manager, std::string_view name) {
+    if(name.size() > MAX_NAME_LENGTH) {
+        throw std::runtime_error("Manager name longer than " + std::to_string(MAX_NAME_LENGTH) + " characters");
+    }
+
+    for(uint32_t ring = 0; ring < _maxManagers; ring++) {
+        auto &control = ringControl(_segment, ring);
+        uint32_t state = RING_FREE;
+        bool claimed = atomic(control.state).compare_exchange_strong(state, RING_CLAIMED, std::memory_order_acq_rel);
+        if(!claimed && state == RING_ACTIVE && !processAlive(atomic(control.pid).load(std::memory_order_relaxed))) {
+            claimed = atomic(control.state).compare_exchange_strong(state, RING_CLAIMED, std::memory_order_acq_rel);
+        }
+
+        if(!claimed) {
+            continue;
+        }
+
+        // senders holding an id of the previous owner fail the generation check from now on
+        auto generation = atomic(control.generation).fetch_add(1, std::memory_order_acq_rel) + 1;
+        std::memset(ringData(_segment, _maxManagers, _ringBytes, ring), 0, _ringBytes);
+        atomic(control.tail).store(0, std::memory_order_relaxed);
+        atomic(control.reserver).store(0, std::memory_order_relaxed);
+        atomic(control.head).store(0, std::memory_order_relaxed);
+        atomic(control.sleeping).store(0, std::memory_order_relaxed);
+        atomic(control.pid).store(getpid(), std::memory_order_relaxed);
+        std::memset(control.name, 0, sizeof(control.name));
+        std::memcpy(control.name, name.data(), name.size());
+        atomic(control.state).store(RING_ACTIVE, std::memory_order_release);
+
+        auto attachment = std::make_unique<Attachment>();
+        attachment->manager = manager;
+        attachment->ring = ring;
+        attachment->thread = std::thread([this, attachment = attachment.get()] {
+            receive(*attachment);
+        });
+
+        std::lock_guard l(_attachmentsMutex);
+        _attachments.push_back(std::move(attachment));
+        return remoteId(generation, ring);
+    }
+
+    throw std::runtime_error("No free ring in shared memory segment " + _name);
+}
+
+void Cppelix::SharedMemoryTransport::detachManager(DependencyManager *manager) {
+    std::unique_ptr<Attachment> attachment;
+    {
+        std::lock_guard l(_attachmentsMutex);
+        auto it = std::find_if(begin(_attachments), end(_attachments), [manager](const std::unique_ptr<Attachment> &a) { return a->manager == manager; });
+        if(it == end(_attachments)) {
+            return;
+        }
+        attachment = std::move(*it);
+        _attachments.erase(it);
+    }
+
+    stopReceiving(*attachment);
+
+    auto &control = ringControl(_segment, attachment->ring);
+    atomic(control.generation).fetch_add(1, std::memory_order_acq_rel);
+    atomic(control.state).store(RING_FREE, std::memory_order_release);
+}
+
+std::optional<uint64_t> Cppelix::SharedMemoryTransport::findManager(std::string_view name) const {
+    for(uint32_t ring = 0; ring < _maxManagers; ring++) {
+        auto &control = ringControl(_segment, ring);
+        if(atomic(control.state).load(std::memory_order_acquire) != RING_ACTIVE) {
+            continue;
+        }
+
+        if(std::string_view{control.name, strnlen(control.name, sizeof(control.name))} == name) {
+            return remoteId(atomic(control.generation).load(std::memory_order_acquire), ring);
+        }
+    }
+
+    return {};
+}
+
+void Cppelix::SharedMemoryTransport::checkRegistration(uint64_t eventType, uint64_t argsHash) const {
+    auto registration = _eventTypes.find(eventType);
+    if(registration == end(_eventTypes)) {
+        throw std::runtime_error("Event type not registered with SharedMemoryTransport");
+    }
+
+    if(registration->second.argsHash != argsHash) {
+        throw std::runtime_error("Event arguments don't match the types registered with SharedMemoryTransport");
+    }
+}
+
+Cppelix::ISerializationAdmin& Cppelix::SharedMemoryTransport::serializationAdmin() const {
+    auto *admin = _serializationAdmin.load(std::memory_order_acquire);
+    if(admin == nullptr) {
+        throw std::runtime_error("SharedMemoryTransport needs an ISerializationAdmin for events that are not trivially copyable");
+    }
+    return *admin;
+}
+
+void Cppelix::SharedMemoryTransport::write(uint64_t id, const MessageHeader &header, std::byte const *payload) {
+    auto ring = static_cast<uint32_t>(id);
+    if((id & REMOTE_MANAGER_BIT) == 0 || ring >= _maxManagers) {
+        throw std::runtime_error("Couldn't find manager");
+    }
+
+    writeToRing(ring, static_cast<uint32_t>(id >> 32U) & 0x7FFF'FFFFU, header, payload);
+}
+
+void Cppelix::SharedMemoryTransport::writeToOtherProcesses(const MessageHeader &header, std::byte const *payload) {
+    auto self = getpid();
+    for(uint32_t ring = 0; ring < _maxManagers; ring++) {
+        auto &control = ringControl(_segment, ring);
+        if(atomic(control.state).load(std::memory_order_acquire) != RING_ACTIVE || atomic(control.pid).load(std::memory_order_relaxed) == self) {
+            continue;
+        }
+
+        try {
+            writeToRing(ring, atomic(control.generation).load(std::memory_order_acquire) & 0x7FFF'FFFFU, header, payload);
+        } catch (const std::runtime_error &) {
+            // the receiver detached, died or didn't make room in time, the others still get the event
+            _undeliveredEvents.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+}
+
+void Cppelix::SharedMemoryTransport::writeToRing(uint32_t ring, uint32_t generation, const MessageHeader &header, std::byte const *payload) {
+    auto &control = ringControl(_segment, ring);
+    if(atomic(control.state).load(std::memory_order_acquire) != RING_ACTIVE || (atomic(control.generation).load(std::memory_order_acquire) & 0x7FFF'FFFFU) != generation) {
+        throw std::runtime_error("Couldn't find manager");
+    }
+
+    const uint64_t needed = alignRecord(sizeof(RecordHeader) + header.payloadSize);
+    if(needed > _ringBytes / 2) {
+        throw std::runtime_error("Event too large for SharedMemoryTransport ring");
+    }
+
+    // reserve space by moving tail under the reservation lock, the records themselves are written concurrently
+    const auto self = static_cast<int32_t>(getpid());
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(_sendTimeout.load(std::memory_order_relaxed));
+    auto *data = ringData(_segment, _maxManagers, _ringBytes, ring);
+    auto tail = atomic(control.tail);
+    uint64_t position;
+    uint64_t padding;
+    for(uint32_t attempt = 1;; attempt++) {
+        // syscalls, not on every attempt
+        bool checkProcesses = attempt % 1024 == 0;
+        if(checkProcesses) {
+            if(!processAlive(atomic(control.pid).load(std::memory_order_relaxed))) {
+                throw std::runtime_error("Receiving process of SharedMemoryTransport ring died");
+            }
+            if(std::chrono::steady_clock::now() >= deadline) {
+                throw std::runtime_error("SharedMemoryTransport ring of the receiver stayed full for the send timeout");
+            }
+        }
+
+        if(!tryLockReservation(control, self, checkProcesses)) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        // a writer that died between reserving its record and moving tail left the reservation behind, move past it. With a full ring
+        // tail is where head is, that record is in use
+        position = tail.load(std::memory_order_relaxed);
+        auto head = atomic(control.head).load(std::memory_order_acquire);
+        while(position - head < _ringBytes) {
+            auto state = atomic(reinterpret_cast<RecordHeader*>(data + (position & (_ringBytes - 1)))->state).load(std::memory_order_acquire);
+            if(state == 0) {
+                break;
+            }
+            position += lengthOf(state);
+        }
+
+        auto offset = position & (_ringBytes - 1);
+        padding = offset + needed > _ringBytes ? _ringBytes - offset : 0;
+        if(position + padding + needed - head > _ringBytes) {
+            tail.store(position, std::memory_order_relaxed);
+            atomic(control.reserver).store(0, std::memory_order_release);
+            std::this_thread::yield();
+            continue;
+        }
+
+        if(padding != 0) {
+            auto *paddingRecord = reinterpret_cast<RecordHeader*>(data + offset);
+            atomic(paddingRecord->state).store(COMMITTED_BIT | recordState(self, padding | PADDING_BIT), std::memory_order_release);
+        }
+        auto *reserved = reinterpret_cast<RecordHeader*>(data + ((position + padding) & (_ringBytes - 1)));
+        atomic(reserved->state).store(recordState(self, needed), std::memory_order_release);
+        tail.store(position + padding + needed, std::memory_order_relaxed);
+        atomic(control.reserver).store(0, std::memory_order_release);
+        break;
+    }
+
+    auto offset = (position + padding) & (_ringBytes - 1);
+    auto *record = reinterpret_cast<RecordHeader*>(data + offset);
+    record->payloadSize = header.payloadSize;
+    record->eventType = header.eventType;
+    record->argsHash = header.argsHash;
+    record->originatingService = header.originatingService;
+    record->serialized = header.serialized ? 1 : 0;
+    if(header.payloadSize != 0) {
+        std::memcpy(data + offset + sizeof(RecordHeader), payload, header.payloadSize);
+    }
+    atomic(record->state).store(COMMITTED_BIT | recordState(self, needed), std::memory_order_release);
+
+    // pairs with the fence in receive(): either the receiver sees the record, or we see it sleeping
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if(atomic(control.sleeping).load(std::memory_order_relaxed) != 0) {
+        atomic(control.doorbell).fetch_add(1, std::memory_order_release);
+        futexWakeAll(&control.doorbell);
+    }
+}
+
+void Cppelix::SharedMemoryTransport::receive(Attachment &attachment) {
+    auto &control = ringControl(_segment, attachment.ring);
+    auto *data = ringData(_segment, _maxManagers, _ringBytes, attachment.ring);
+    uint64_t head = atomic(control.head).load(std::memory_order_relaxed);
+    const uint32_t spin = spinIterations();
+    uint32_t idle = 0;
+
+    while(attachment.running.load(std::memory_order_acquire)) {
+        auto *record = reinterpret_cast<RecordHeader*>(data + (head & (_ringBytes - 1)));
+        auto state = atomic(record->state).load(std::memory_order_acquire);
+
+        if((state & COMMITTED_BIT) == 0) {
+            if(idle++ < spin) {
+                continue;
+            }
+
+            auto doorbell = atomic(control.doorbell).load(std::memory_order_acquire);
+            atomic(control.sleeping).store(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if((atomic(record->state).load(std::memory_order_acquire) & COMMITTED_BIT) == 0 && attachment.running.load(std::memory_order_acquire)) {
+                futexWait(&control.doorbell, doorbell, std::chrono::milliseconds(100));
+            }
+            atomic(control.sleeping).store(0, std::memory_order_relaxed);
+
+            // reserved by a writer that died before committing it. Only once tail moved past it, until then the next writer still has
+            // to step over the reservation
+            state = atomic(record->state).load(std::memory_order_acquire);
+            if(state != 0 && (state & COMMITTED_BIT) == 0 && atomic(control.tail).load(std::memory_order_acquire) >= head + lengthOf(state) &&
+               !processAlive(writerOf(state))) {
+                _droppedEvents.fetch_add(1, std::memory_order_relaxed);
+                head = zeroRecord(record, head, lengthOf(state));
+                atomic(control.head).store(head, std::memory_order_release);
+            }
+            continue;
+        }
+
+        idle = 0;
+        if((state & PADDING_BIT) == 0) {
+            dispatch(*attachment.manager, MessageHeader{record->eventType, record->argsHash, record->originatingService, record->payloadSize, record->serialized != 0},
+                     reinterpret_cast<std::byte const *>(record) + sizeof(RecordHeader));
+        }
+
+        head = zeroRecord(record, head, lengthOf(state));
+        atomic(control.head).store(head, std::memory_order_release);
+    }
+}
+
+void Cppelix::SharedMemoryTransport::dispatch(DependencyManager &manager, const MessageHeader &header, std::byte const *payload) {
+    auto registration = _eventTypes.find(header.eventType);
+    if(registration == end(_eventTypes) || registration->second.argsHash != header.argsHash) {
+        _droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    bool decoded = false;
+    try {
+        // the sending process issued the id, it must not resolve to one of our own services
+        auto originatingService = header.originatingService == 0 ? 0 : header.originatingService | ServiceRegistry::FOREIGN_BIT;
+        decoded = registration->second.decode(manager, originatingService, payload, header.payloadSize, header.serialized, _serializationAdmin.load(std::memory_order_acquire));
+    } catch (const std::exception &) {
+        decoded = false;
+    }
+
+    if(!decoded) {
+        _droppedEvents.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void Cppelix::SharedMemoryTransport::stopReceiving(Attachment &attachment) {
+    auto &control = ringControl(_segment, attachment.ring);
+    attachment.running.store(false, std::memory_order_release);
+    atomic(control.doorbell).fetch_add(1, std::memory_order_release);
+    futexWakeAll(&control.doorbell);
+    if(attachment.thread.joinable()) {
+        attachment.thread.join();
+    }
+}
@@ -0,0 +1,192 @@
+#include "framework/StartupProfiler.h"
+#include <algorithm>
+#include <unordered_set>
+#include <fmt/format.h>
+
+template <typename RecordsT>
+static auto findRecord(RecordsT &records, uint64_t serviceId) -> decltype(records.data()) {
+    auto record = std::lower_bound(begin(records), end(records), serviceId, [](const Cppelix::ServiceStartupRecord &r, uint64_t id) {
+        return r.serviceId < id;
+    });
+
+    if(record == end(records) || record->serviceId != serviceId) {
+        return nullptr;
+    }
+
+    return &*record;
+}
+
+Cppelix::StartupProfiler::StartupProfiler() : _epoch(std::chrono::steady_clock::now()) {
+    // Big enough to be served by mmap. Growing from a small allocation leaves holes in the heap that get filled with services,
+    // which measurably slows down iterating over them in the DependencyManager.
+    _records.reserve(4096);
+}
+
+void Cppelix::StartupProfiler::serviceInstalled(uint64_t serviceId, std::string_view implementationName) {
+    if(!enabled()) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lg(_mutex);
+    // service ids are mostly handed out in increasing order, so this nearly always appends
+    auto record = _records.end();
+    if(!_records.empty() && _records.back().serviceId >= serviceId) {
+        record = std::lower_bound(begin(_records), end(_records), serviceId, [](const ServiceStartupRecord &r, uint64_t id) {
+            return r.serviceId < id;
+        });
+        if(record != end(_records) && record->serviceId == serviceId) {
+            record->installed = now;
+            return;
+        }
+    }
+
+    ServiceStartupRecord newRecord{};
+    newRecord.serviceId = serviceId;
+    newRecord.implementationName = implementationName;
+    newRecord.installed = now;
+    _records.insert(record, newRecord);
+}
+
+void Cppelix::StartupProfiler::dependenciesSatisfied(uint64_t serviceId, uint64_t gatingServiceId) {
+    if(!enabled()) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lg(_mutex);
+    auto record = findRecord(_records, serviceId);
+    if(record == nullptr || record->started) {
+        return;
+    }
+
+    record->gatingServiceId = gatingServiceId;
+    record->dependenciesSatisfied = now;
+}
+
+void Cppelix::StartupProfiler::startBegin(uint64_t serviceId) {
+    if(!enabled()) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lg(_mutex);
+    auto record = findRecord(_records, serviceId);
+    if(record == nullptr || record->started) {
+        return;
+    }
+
+    // services without required dependencies are satisfied as soon as they are asked to start
+    if(record->dependenciesSatisfied == ServiceStartupRecord::time_point{}) {
+        record->dependenciesSatisfied = now;
+    }
+    record->startAttempts++;
+    record->startBegin = now;
+}
+
+void Cppelix::StartupProfiler::startEnd(uint64_t serviceId, bool started) {
+    if(!enabled()) {
+        return;
+    }
+
+    auto now = std::chrono::steady_clock::now();
+    std::lock_guard lg(_mutex);
+    auto record = findRecord(_records, serviceId);
+    if(record == nullptr || record->started) {
+        return;
+    }
+
+    record->started = started;
+    record->startEnd = now;
+}
+
+void Cppelix::StartupProfiler::serviceRemoved(uint64_t serviceId) {
+    std::lock_guard lg(_mutex);
+    auto record = findRecord(_records, serviceId);
+    if(record != nullptr) {
+        _records.erase(_records.begin() + (record - _records.data()));
+    }
+}
+
+std::vector<Cppelix::ServiceStartupRecord> Cppelix::StartupProfiler::getRecords() const {
+    std::vector<ServiceStartupRecord> records;
+
+    {
+        std::lock_guard lg(_mutex);
+        records = _records;
+    }
+
+    std::sort(begin(records), end(records), [](const ServiceStartupRecord &a, const ServiceStartupRecord &b) {
+        return a.installed < b.installed;
+    });
+
+    return records;
+}
+
+std::vector<Cppelix::ServiceStartupRecord> Cppelix::StartupProfiler::getCriticalPath() const {
+    std::lock_guard lg(_mutex);
+    return getCriticalPathLocked();
+}
+
+std::vector<Cppelix::ServiceStartupRecord> Cppelix::StartupProfiler::getCriticalPathLocked() const {
+    std::vector<ServiceStartupRecord> path;
+
+    ServiceStartupRecord const *last = nullptr;
+    for(auto const &record : _records) {
+        if(record.started && (last == nullptr || record.startEnd > last->startEnd)) {
+            last = &record;
+        }
+    }
+
+    while(last != nullptr) {
+        path.push_back(*last);
+
+        if(last->gatingServiceId == 0 || path.size() > _records.size()) {
+            break;
+        }
+        last = findRecord(_records, last->gatingServiceId);
+    }
+
+    std::reverse(begin(path), end(path));
+    return path;
+}
+
+std::string Cppelix::StartupProfiler::toChromeTrace() const {
+    std::lock_guard lg(_mutex);
+
+    std::unordered_set<uint64_t> criticalServices;
+    for(auto const &record : getCriticalPathLocked()) {
+        criticalServices.insert(record.serviceId);
+    }
+
+    auto toUs = [this](ServiceStartupRecord::time_point tp) {
+        return std::chrono::duration<double, std::micro>(tp - _epoch).count();
+    };
+
+    fmt::memory_buffer out;
+    fmt::format_to(out, "{{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    bool first = true;
+    for(auto const &record : _records) {
+        auto serviceId = record.serviceId;
+        if(!first) {
+            fmt::format_to(out, ",");
+        }
+        first = false;
+
+        std::string_view category = criticalServices.contains(serviceId) ? "critical_path" : "lifecycle";
+        fmt::format_to(out, "{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{} ({})\"}}}}", serviceId, record.implementationName, serviceId);
+
+        if(record.dependenciesSatisfied != ServiceStartupRecord::time_point{}) {
+            fmt::format_to(out, ",{{\"name\":\"waiting\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"gatingServiceId\":{}}}}}",
+                           category, serviceId, toUs(record.installed), toUs(record.dependenciesSatisfied) - toUs(record.installed), record.gatingServiceId);
+        }
+
+        if(record.startEnd != ServiceStartupRecord::time_point{}) {
+            fmt::format_to(out, ",{{\"name\":\"start\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f},\"args\":{{\"started\":{},\"attempts\":{}}}}}",
+                           category, serviceId, toUs(record.startBegin), toUs(record.startEnd) - toUs(record.startBegin), record.started, record.startAttempts);
+        }
+    }
+    fmt::format_to(out, "]}}");
+
+    return fmt::to_string(out);
+}
@@ -0,0 +1,48 @@
+#include "framework/ThreadPool.h"
+
+Cppelix::ThreadPool::ThreadPool(uint32_t threadCount) {
+    _threads.reserve(threadCount);
+    for(uint32_t i = 0; i < threadCount; i++) {
+        _threads.emplace_back([this]{ run(); });
+    }
+}
+
+Cppelix::ThreadPool::~ThreadPool() {
+    {
+        std::unique_lock l(_mutex);
+        _quit = true;
+    }
+    _wakeUp.notify_all();
+
+    for(auto &thread : _threads) {
+        thread.join();
+    }
+}
+
+void Cppelix::ThreadPool::submit(std::function<void()> task) {
+    {
+        std::unique_lock l(_mutex);
+        _tasks.emplace_back(std::move(task));
+    }
+    _wakeUp.notify_one();
+}
+
+void Cppelix::ThreadPool::run() {
+    while(true) {
+        std::function<void()> task;
+
+        {
+            std::unique_lock l(_mutex);
+            _wakeUp.wait(l, [this]{ return _quit || !_tasks.empty(); });
+
+            if(_tasks.empty()) {
+                return;
+            }
+
+            task = std::move(_tasks.front());
+            _tasks.pop_front();
+        }
+
+        task();
+    }
+}
@@ -0,0 +1,254 @@
+#include "framework/TimerWheel.h"
+#include <algorithm>
+#include <bit>
+
+uint64_t Cppelix::TimerWheel::schedule(uint64_t expiry, uint64_t interval, Callback callback, uint64_t slack, uint64_t owner) {
+    uint32_t index;
+    if(_freeNodes.empty()) {
+        index = static_cast<uint32_t>(_nodes.size());
+        _nodes.emplace_back();
+    } else {
+        index = _freeNodes.back();
+        _freeNodes.pop_back();
+    }
+
+    auto &node = _nodes[index];
+    node.expiry = expiry;
+    node.previous = expiry > interval ? expiry - interval : 0;
+    node.interval = interval;
+    // more slack than an interval would make every expiration look like it missed deadlines
+    node.granularity = std::bit_floor(std::max<uint64_t>(interval == 0 ? slack : std::min(slack, interval), 1));
+    node.owner = owner;
+    node.callback = std::move(callback);
+    node.cancelled = false;
+    place(index);
+    _size++;
+    return handleOf(index, node.generation);
+}
+
+bool Cppelix::TimerWheel::cancel(uint64_t handle) noexcept {
+    auto *node = find(handle);
+    if(node == nullptr || node->cancelled) {
+        return false;
+    }
+
+    cancelAt(static_cast<uint32_t>(handle));
+    return true;
+}
+
+size_t Cppelix::TimerWheel::cancelOwnedBy(uint64_t owner) noexcept {
+    size_t cancelled = 0;
+    if(owner == 0) {
+        return cancelled;
+    }
+
+    for(uint32_t index = 0; index < _nodes.size(); index++) {
+        auto const &node = _nodes[index];
+        if(node.owner == owner && (node.list != NIL || node.firing) && !node.cancelled) {
+            cancelAt(index);
+            cancelled++;
+        }
+    }
+    return cancelled;
+}
+
+bool Cppelix::TimerWheel::setInterval(uint64_t handle, uint64_t interval) noexcept {
+    auto *node = find(handle);
+    if(node == nullptr || node->cancelled) {
+        return false;
+    }
+
+    auto previousInterval = node->interval;
+    node->interval = interval;
+    if(previousInterval == 0 || interval == 0 || node->firing || node->list == FIRING_LIST) {
+        return true;
+    }
+
+    auto index = static_cast<uint32_t>(handle);
+    unlink(index);
+    node->expiry = node->previous + interval;
+    place(index);
+    return true;
+}
+
+uint64_t Cppelix::TimerWheel::advance(uint64_t now) {
+    uint64_t fired = 0;
+    while(true) {
+        if(_heads[DUE_LIST] != NIL) {
+            take(DUE_LIST);
+            fired += fireTaken(now);
+            continue;
+        }
+
+        auto boundary = nextBoundary();
+        if(!boundary || boundary->tick > now) {
+            break;
+        }
+
+        _current = boundary->tick;
+        auto list = boundary->level * SLOTS + boundary->slot;
+        if(boundary->level == 0) {
+            take(list);
+            fired += fireTaken(now);
+            continue;
+        }
+
+        // the slot's span starts now, spread its timers over the lower levels
+        auto index = _heads[list];
+        while(index != NIL) {
+            auto next = _nodes[index].next;
+            unlink(index);
+            place(index);
+            index = next;
+        }
+    }
+
+    if(now > _current) {
+        _current = now;
+    }
+    return fired;
+}
+
+std::optional<uint64_t> Cppelix::TimerWheel::nextWakeUp() const noexcept {
+    if(_heads[DUE_LIST] != NIL) {
+        return _current;
+    }
+
+    auto boundary = nextBoundary();
+    if(!boundary) {
+        return {};
+    }
+    return boundary->tick;
+}
+
+Cppelix::TimerWheel::Node* Cppelix::TimerWheel::find(uint64_t handle) noexcept {
+    auto index = static_cast<uint32_t>(handle);
+    if(index >= _nodes.size()) {
+        return nullptr;
+    }
+
+    auto &node = _nodes[index];
+    if(node.generation != static_cast<uint32_t>(handle >> 32U) || (node.list == NIL && !node.firing)) {
+        return nullptr;
+    }
+    return &node;
+}
+
+std::optional<Cppelix::TimerWheel::Boundary> Cppelix::TimerWheel::nextBoundary() const noexcept {
+    // timers of a level only differ from the current tick in that level's group, so the first occupied slot after the current one
+    // on the lowest level that has one comes before anything on the levels above
+    for(uint32_t level = 0; level < LEVELS; level++) {
+        auto shift = level * SLOT_BITS;
+        auto current = static_cast<uint32_t>((_current >> shift) & (SLOTS - 1));
+        auto ahead = current == SLOTS - 1 ? 0 : _occupied[level] & (~uint64_t{0} << (current + 1));
+        if(ahead == 0) {
+            continue;
+        }
+
+        auto slot = static_cast<uint32_t>(std::countr_zero(ahead));
+        auto upperShift = shift + SLOT_BITS;
+        auto upper = upperShift >= 64 ? 0 : (_current >> upperShift) << upperShift;
+        return Boundary{upper | (static_cast<uint64_t>(slot) << shift), level, slot};
+    }
+    return {};
+}
+
+void Cppelix::TimerWheel::place(uint32_t index) noexcept {
+    auto due = dueTickOf(_nodes[index]);
+    if(due <= _current) {
+        push(DUE_LIST, index);
+        return;
+    }
+
+    auto level = static_cast<uint32_t>(63 - std::countl_zero(due ^ _current)) / SLOT_BITS;
+    auto slot = static_cast<uint32_t>((due >> (level * SLOT_BITS)) & (SLOTS - 1));
+    push(level * SLOTS + slot, index);
+    _occupied[level] |= uint64_t{1} << slot;
+}
+
+void Cppelix::TimerWheel::push(uint32_t list, uint32_t index) noexcept {
+    auto &node = _nodes[index];
+    node.list = list;
+    node.prev = NIL;
+    node.next = _heads[list];
+    if(node.next != NIL) {
+        _nodes[node.next].prev = index;
+    }
+    _heads[list] = index;
+}
+
+void Cppelix::TimerWheel::unlink(uint32_t index) noexcept {
+    auto &node = _nodes[index];
+    if(node.prev != NIL) {
+        _nodes[node.prev].next = node.next;
+    } else {
+        _heads[node.list] = node.next;
+    }
+    if(node.next != NIL) {
+        _nodes[node.next].prev = node.prev;
+    }
+
+    if(node.list < DUE_LIST && _heads[node.list] == NIL) {
+        _occupied[node.list / SLOTS] &= ~(uint64_t{1} << (node.list % SLOTS));
+    }
+    node.list = NIL;
+    node.prev = NIL;
+    node.next = NIL;
+}
+
+void Cppelix::TimerWheel::take(uint32_t list) noexcept {
+    while(_heads[list] != NIL) {
+        auto index = _heads[list];
+        unlink(index);
+        push(FIRING_LIST, index);
+    }
+}
+
+uint64_t Cppelix::TimerWheel::fireTaken(uint64_t now) {
+    uint64_t fired = 0;
+    while(_heads[FIRING_LIST] != NIL) {
+        auto index = _heads[FIRING_LIST];
+        unlink(index);
+
+        auto &node = _nodes[index];
+        node.firing = true;
+        node.callback(node.expiry, passedDeadlines(node.expiry, node.interval, now));
+        node.firing = false;
+        fired++;
+
+        if(node.cancelled || node.interval == 0) {
+            release(index);
+            continue;
+        }
+
+        // the callback might have changed the interval, skip what passed according to the new one
+        node.expiry += (passedDeadlines(node.expiry, node.interval, now) + 1) * node.interval;
+        node.previous = node.expiry - node.interval;
+        place(index);
+    }
+    return fired;
+}
+
+void Cppelix::TimerWheel::cancelAt(uint32_t index) noexcept {
+    auto &node = _nodes[index];
+    if(node.firing) {
+        // released by fireTaken() once the callback returns
+        node.cancelled = true;
+        return;
+    }
+
+    unlink(index);
+    release(index);
+}
+
+void Cppelix::TimerWheel::release(uint32_t index) noexcept {
+    auto &node = _nodes[index];
+    node.callback = nullptr;
+    node.owner = 0;
+    node.cancelled = false;
+    if(++node.generation == 0) {
+        node.generation = 1;
+    }
+    _freeNodes.push_back(index);
+    _size--;
+}
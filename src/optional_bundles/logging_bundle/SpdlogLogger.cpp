@@ -73,8 +73,8 @@ bool Cppelix::SpdlogLogger::start() {
     _logger->set_level(spdlog::level::trace);
 
 
-    auto requestedLevelIt = _properties.find("LogLevel");
-    if(requestedLevelIt != end(_properties)) {
+    auto requestedLevelIt = getProperties()->find("LogLevel");
+    if(requestedLevelIt != end(*getProperties())) {
         auto requestedLevel = std::any_cast<LogLevel>(requestedLevelIt->second);
         if (requestedLevel == LogLevel::TRACE) {
             _logger->set_level(spdlog::level::trace);
@@ -93,13 +93,13 @@ bool Cppelix::SpdlogLogger::start() {
         _logger->set_level(spdlog::level::info);
     }
 
-    auto targetServiceId = std::any_cast<uint64_t>(_properties["TargetServiceId"]);
+    auto targetServiceId = std::any_cast<uint64_t>(getProperties()->at("TargetServiceId"));
     _logger->trace("SpdlogLogger {} started for component {}", getServiceId(), targetServiceId);
     return true;
 }
 
 bool Cppelix::SpdlogLogger::stop() {
-    auto targetServiceId = std::any_cast<uint64_t>(_properties["TargetServiceId"]);
+    auto targetServiceId = std::any_cast<uint64_t>(getProperties()->at("TargetServiceId"));
     _logger->trace("SpdlogLogger {} stopped for component {}", getServiceId(), targetServiceId);
     return true;
 }
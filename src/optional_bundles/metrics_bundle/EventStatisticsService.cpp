@@ -6,15 +6,19 @@ Cppelix::EventStatisticsService::EventStatisticsService(Cppelix::DependencyRegis
 
 bool Cppelix::EventStatisticsService::start() {
     if(getProperties()->contains("ShowStatisticsOnStop")) {
-        _showStatisticsOnStop = std::any_cast<bool>(getProperties()->operator[]("ShowStatisticsOnStop"));
+        _showStatisticsOnStop = std::any_cast<bool>(getProperties()->at("ShowStatisticsOnStop"));
     }
 
     if(getProperties()->contains("AveragingIntervalMs")) {
-        _averagingIntervalMs = std::any_cast<uint64_t>(getProperties()->operator[]("AveragingIntervalMs"));
+        _averagingIntervalMs = std::any_cast<uint64_t>(getProperties()->at("AveragingIntervalMs"));
     } else {
         _averagingIntervalMs = 5000;
     }
 
+    if(getProperties()->contains("MaxAveragedIntervals")) {
+        _maxAveragedIntervals = std::any_cast<uint64_t>(getProperties()->at("MaxAveragedIntervals"));
+    }
+
     auto _timerManager = getManager()->createServiceManager<Timer, ITimer>();
     _timerManager->setChronoInterval(std::chrono::milliseconds(_averagingIntervalMs));
     _timerEventRegistration = getManager()->registerEventHandler<TimerEvent>(getServiceId(), this, _timerManager->getServiceId());
@@ -22,6 +26,11 @@ bool Cppelix::EventStatisticsService::start() {
 
     _interceptorRegistration = getManager()->registerEventInterceptor<Event>(getServiceId(), this);
 
+    // the interceptor only sees whole dispatches, the profiler splits them up per handler
+    if(_showStatisticsOnStop) {
+        getManager()->getHandlerProfiler().setEnabled(true);
+    }
+
     return true;
 }
 
@@ -29,17 +38,21 @@ bool Cppelix::EventStatisticsService::stop() {
     _timerEventRegistration = nullptr;
 
     if(_showStatisticsOnStop) {
-        for(auto &[key, statistics] : _averagedStatistics) {
-            if(statistics.empty()) {
+        for(auto &[type, statistics] : _recentEventStatistics) {
+            auto const &total = statistics.total;
+            if(total.count() == 0) {
                 continue;
             }
 
-            auto min = std::min_element(begin(statistics), end(statistics), [](const AveragedStatisticEntry &a, const AveragedStatisticEntry &b){return a.minProcessingTimeRequired < b.minProcessingTimeRequired; })->minProcessingTimeRequired;
-            auto max = std::max_element(begin(statistics), end(statistics), [](const AveragedStatisticEntry &a, const AveragedStatisticEntry &b){return a.maxProcessingTimeRequired < b.maxProcessingTimeRequired; })->maxProcessingTimeRequired;
-            auto avg = std::accumulate(begin(statistics), end(statistics), 0UL, [](uint64_t i, const AveragedStatisticEntry &entry){ return i + entry.avgProcessingTimeRequired; }) / statistics.size();
-            auto occ = std::accumulate(begin(statistics), end(statistics), 0UL, [](uint64_t i, const AveragedStatisticEntry &entry){ return i + entry.occurances; });
+            LOG_INFO(_logger, "Event type {} occurred {} times, processing p50/p90/p99/p99.9/max: {}/{}/{}/{}/{} ns", statistics.name, total.count(),
+                     total.valueAtQuantile(0.5), total.valueAtQuantile(0.9), total.valueAtQuantile(0.99), total.valueAtQuantile(0.999), total.max());
+        }
 
-            LOG_INFO(_logger, "Event type {} occurred {} times, min/max/avg processing: {}/{}/{} µs", key, occ, min, max, avg);
+        auto handlers = getManager()->getHandlerProfiler().getRecords();
+        handlers.resize(std::min<size_t>(handlers.size(), SLOWEST_HANDLERS_SHOWN));
+        for(auto const &handler : handlers) {
+            LOG_INFO(_logger, "Handler of {} ({}) for {}: {} calls and {} resumptions took {} ns in total, p50/p99/max: {}/{}/{} ns", handler.implementationName, handler.serviceId,
+                     handler.eventName, handler.invocations, handler.slices, handler.totalTime.count(), handler.p50.count(), handler.p99.count(), handler.max.count());
         }
     }
 
@@ -55,7 +68,7 @@ void Cppelix::EventStatisticsService::removeDependencyInstance(Cppelix::ILogger
 }
 
 bool Cppelix::EventStatisticsService::preInterceptEvent(const Cppelix::Event *const evt) {
-    _startProcessingTimestamp = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    _startProcessingTimestamp = std::chrono::steady_clock::now();
     return (bool)AllowOthersHandling;
 }
 
@@ -64,53 +77,39 @@ bool Cppelix::EventStatisticsService::postInterceptEvent(const Cppelix::Event *c
         return (bool)AllowOthersHandling;
     }
 
-    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    auto processingTime = now - _startProcessingTimestamp;
-    auto statistics = _recentEventStatistics.find(evt->name);
-
+    auto processingTime = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _startProcessingTimestamp).count());
+    auto statistics = _recentEventStatistics.find(evt->type);
     if(statistics == end(_recentEventStatistics)) {
-        _recentEventStatistics.emplace(evt->name, std::vector<StatisticEntry>{StatisticEntry{now, processingTime}});
-    } else {
-        statistics->second.emplace_back(now, processingTime);
+        statistics = _recentEventStatistics.try_emplace(evt->type, evt->name).first;
     }
 
+    statistics->second.interval.record(processingTime);
+    statistics->second.total.record(processingTime);
+
     return (bool)AllowOthersHandling;
 }
 
 Cppelix::Generator<bool> Cppelix::EventStatisticsService::handleEvent(const Cppelix::TimerEvent *const evt) {
-    uint64_t now = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
-    for(auto &[key, statistics] : _recentEventStatistics) {
-        auto avgStatistics = _averagedStatistics.find(key);
-
-        if(statistics.empty()) {
-            if(avgStatistics == end(_averagedStatistics)) {
-                _averagedStatistics.emplace(key, std::vector<AveragedStatisticEntry>{AveragedStatisticEntry{now, 0, 0, 0, 0}});
-            } else {
-                avgStatistics->second.emplace_back(now, 0, 0, 0, 0);
-            }
-            _averagedStatistics.emplace(key, std::vector<AveragedStatisticEntry>{AveragedStatisticEntry{now, 0, 0, 0, 0}});
-            continue;
+    // the clock of the manager, so runs in virtual time get reproducible timestamps
+    uint64_t now = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(getManager()->now().time_since_epoch()).count());
+    // no yielding in between: events processed meanwhile could add a type and rehash the map
+    for(auto &[type, statistics] : _recentEventStatistics) {
+        auto &interval = statistics.interval;
+        auto &averaged = _averagedStatistics[type];
+        averaged.emplace_back(now, interval.count(), interval.valueAtQuantile(0.5), interval.valueAtQuantile(0.9), interval.valueAtQuantile(0.99), interval.valueAtQuantile(0.999), interval.max());
+        interval.reset();
+
+        while(averaged.size() > _maxAveragedIntervals) {
+            averaged.pop_front();
         }
-
-        auto min = std::min_element(begin(statistics), end(statistics), [](const StatisticEntry &a, const StatisticEntry &b){return a.processingTimeRequired < b.processingTimeRequired; })->processingTimeRequired;
-        auto max = std::max_element(begin(statistics), end(statistics), [](const StatisticEntry &a, const StatisticEntry &b){return a.processingTimeRequired < b.processingTimeRequired; })->processingTimeRequired;
-        auto avg = std::accumulate(begin(statistics), end(statistics), 0UL, [](uint64_t i, const StatisticEntry &entry){ return i + entry.processingTimeRequired; }) / statistics.size();
-
-        if(avgStatistics == end(_averagedStatistics)) {
-            _averagedStatistics.emplace(key, std::vector<AveragedStatisticEntry>{AveragedStatisticEntry{now, min, max, avg, statistics.size()}});
-        } else {
-            avgStatistics->second.emplace_back(now, min, max, avg, statistics.size());
-        }
-
-        co_yield (bool)Cppelix::PreventOthersHandling;
     }
     co_return (bool)Cppelix::PreventOthersHandling;
 }
 
-const std::unordered_map<std::string_view, std::vector<Cppelix::StatisticEntry>> &Cppelix::EventStatisticsService::getRecentStatistics() {
+const std::unordered_map<uint64_t, Cppelix::EventTypeStatistics> &Cppelix::EventStatisticsService::getRecentStatistics() {
     return _recentEventStatistics;
 }
 
-const std::unordered_map<std::string_view, std::vector<Cppelix::AveragedStatisticEntry>> &Cppelix::EventStatisticsService::getAverageStatistics() {
+const std::unordered_map<uint64_t, std::deque<Cppelix::AveragedStatisticEntry>> &Cppelix::EventStatisticsService::getAverageStatistics() {
     return _averagedStatistics;
 }
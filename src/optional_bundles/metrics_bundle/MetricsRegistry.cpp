@@ -0,0 +1,68 @@
+#include <optional_bundles/metrics_bundle/MetricsRegistry.h>
+#include <optional_bundles/metrics_bundle/PrometheusTextWriter.h>
+
+bool Cppelix::MetricsRegistry::start() {
+    return true;
+}
+
+bool Cppelix::MetricsRegistry::stop() {
+    return true;
+}
+
+Cppelix::Counter& Cppelix::MetricsRegistry::counter(std::string_view name, std::string_view help, const MetricLabels &labels) {
+    return findOrAdd<Counter>(name, help, labels);
+}
+
+Cppelix::Gauge& Cppelix::MetricsRegistry::gauge(std::string_view name, std::string_view help, const MetricLabels &labels) {
+    return findOrAdd<Gauge>(name, help, labels);
+}
+
+Cppelix::Histogram& Cppelix::MetricsRegistry::histogram(std::string_view name, std::string_view help, const MetricLabels &labels) {
+    return findOrAdd<Histogram>(name, help, labels);
+}
+
+void Cppelix::MetricsRegistry::writeTo(PrometheusTextWriter &writer) const {
+    std::lock_guard lg(_mutex);
+    for(auto const &[name, family] : _families) {
+        for(auto const &[labels, metric] : family.metrics) {
+            if(auto *counter = std::get_if<std::unique_ptr<Counter>>(&metric)) {
+                writer.family(name, MetricType::COUNTER, family.help);
+                writer.sample(name, labels, (*counter)->value());
+            } else if(auto *gauge = std::get_if<std::unique_ptr<Gauge>>(&metric)) {
+                writer.family(name, MetricType::GAUGE, family.help);
+                writer.sample(name, labels, (*gauge)->value());
+            } else if(auto *histogram = std::get_if<std::unique_ptr<Histogram>>(&metric)) {
+                writer.family(name, MetricType::SUMMARY, family.help);
+                writer.summary(name, labels, (*histogram)->summarize());
+            }
+        }
+    }
+}
+
+template <typename T>
+T& Cppelix::MetricsRegistry::findOrAdd(std::string_view name, std::string_view help, const MetricLabels &labels) {
+    if(!PrometheusTextWriter::validName(name)) {
+        throw std::runtime_error("Invalid metric name " + std::string{name});
+    }
+    for(auto const &[labelName, labelValue] : labels) {
+        if(!PrometheusTextWriter::validName(labelName)) {
+            throw std::runtime_error("Invalid label name " + labelName + " for metric " + std::string{name});
+        }
+    }
+
+    Metric wanted{std::unique_ptr<T>{}};
+
+    std::lock_guard lg(_mutex);
+    auto family = _families.find(name);
+    if(family == end(_families)) {
+        family = _families.emplace(std::string{name}, Family{std::string{help}, wanted.index()}).first;
+    } else if(family->second.kind != wanted.index()) {
+        throw std::runtime_error("Metric " + std::string{name} + " was registered as another kind of metric before");
+    }
+
+    auto metric = family->second.metrics.find(labels);
+    if(metric == end(family->second.metrics)) {
+        metric = family->second.metrics.emplace(labels, std::make_unique<T>()).first;
+    }
+    return *std::get<std::unique_ptr<T>>(metric->second);
+}
@@ -0,0 +1,125 @@
+#include <optional_bundles/metrics_bundle/PrometheusExporter.h>
+#include <optional_bundles/metrics_bundle/PrometheusTextWriter.h>
+#include <framework/DependencyManager.h>
+
+Cppelix::PrometheusExporter::PrometheusExporter(DependencyRegister &reg, CppelixProperties props) : Service(std::move(props)) {
+    reg.registerDependency<ILogger>(this, true);
+    reg.registerDependency<IMetricsRegistry>(this, true);
+}
+
+bool Cppelix::PrometheusExporter::start() {
+    std::string address = "0.0.0.0";
+    if(auto addressProp = getProperties()->find("Address"); addressProp != end(*getProperties())) {
+        address = std::any_cast<std::string>(addressProp->second);
+    }
+
+    uint16_t port = DEFAULT_PORT;
+    if(auto portProp = getProperties()->find("Port"); portProp != end(*getProperties())) {
+        port = std::any_cast<uint16_t>(portProp->second);
+    }
+
+    _listener = std::make_unique<HttpListener>([this](std::string_view method, std::string_view path) {
+        if(path != "/metrics") {
+            return HttpResponse{404, "text/plain; charset=utf-8", "metrics are served on /metrics\n"};
+        }
+        if(method != "GET") {
+            return HttpResponse{405, "text/plain; charset=utf-8", {}};
+        }
+        return HttpResponse{200, std::string{PrometheusTextWriter::CONTENT_TYPE}, scrape()};
+    });
+
+    try {
+        _listener->listen(address, port);
+    } catch (const std::runtime_error &e) {
+        LOG_ERROR(_logger, "Couldn't start metrics endpoint: {}", e.what());
+        _listener = nullptr;
+        return false;
+    }
+
+    LOG_INFO(_logger, "Serving metrics on http://{}:{}/metrics", address, _listener->port());
+    return true;
+}
+
+bool Cppelix::PrometheusExporter::stop() {
+    if(_listener) {
+        _listener->stop();
+        _listener = nullptr;
+    }
+    return true;
+}
+
+void Cppelix::PrometheusExporter::addDependencyInstance(ILogger *logger) {
+    _logger = logger;
+}
+
+void Cppelix::PrometheusExporter::removeDependencyInstance(ILogger *logger) {
+    _logger = nullptr;
+}
+
+void Cppelix::PrometheusExporter::addDependencyInstance(IMetricsRegistry *registry) {
+    _registry.store(registry, std::memory_order_release);
+}
+
+void Cppelix::PrometheusExporter::removeDependencyInstance(IMetricsRegistry *registry) {
+    _registry.store(nullptr, std::memory_order_release);
+}
+
+uint16_t Cppelix::PrometheusExporter::getPort() const {
+    return _listener ? _listener->port() : 0;
+}
+
+std::string Cppelix::PrometheusExporter::scrape() {
+    PrometheusTextWriter writer;
+    if(auto *registry = _registry.load(std::memory_order_acquire); registry != nullptr) {
+        registry->writeTo(writer);
+    }
+
+    auto *manager = getManager();
+    auto managerId = std::to_string(manager->getId());
+    MetricLabels managerLabels{{"manager", managerId}};
+
+    auto queue = manager->getQueueMetrics();
+    writer.family("cppelix_events_pushed_total", MetricType::COUNTER, "Events pushed into the event queue");
+    writer.sample("cppelix_events_pushed_total", managerLabels, queue.pushed);
+    writer.family("cppelix_events_dispatched_total", MetricType::COUNTER, "Events taken out of the event queue by the event loop");
+    writer.sample("cppelix_events_dispatched_total", managerLabels, queue.dispatched);
+    writer.family("cppelix_event_queue_depth", MetricType::GAUGE, "Events waiting in the event queue");
+    writer.sample("cppelix_event_queue_depth", managerLabels, queue.depth);
+
+    if(!queue.depthByPriority.empty() || queue.depthOfOtherPriorities > 0) {
+        writer.family("cppelix_event_queue_depth_by_priority", MetricType::GAUGE, "Events waiting in the event queue per priority");
+        for(auto const &[priority, depth] : queue.depthByPriority) {
+            writer.sample("cppelix_event_queue_depth_by_priority", MetricLabels{{"manager", managerId}, {"priority", std::to_string(priority)}}, depth);
+        }
+        if(queue.depthOfOtherPriorities > 0) {
+            writer.sample("cppelix_event_queue_depth_by_priority", MetricLabels{{"manager", managerId}, {"priority", "other"}}, queue.depthOfOtherPriorities);
+        }
+    }
+
+    // wait times are only there with queue metrics enabled
+    if(queue.wait.count > 0) {
+        writer.family("cppelix_event_queue_wait_nanoseconds", MetricType::SUMMARY, "Time from push to dispatch of events");
+        writer.summary("cppelix_event_queue_wait_nanoseconds", managerLabels, queue.wait);
+        writer.family("cppelix_event_queue_wait_by_priority_nanoseconds", MetricType::SUMMARY, "Time from push to dispatch of events per priority");
+        for(auto const &[priority, wait] : queue.waitByPriority) {
+            writer.summary("cppelix_event_queue_wait_by_priority_nanoseconds", MetricLabels{{"manager", managerId}, {"priority", std::to_string(priority)}}, wait);
+        }
+    }
+
+    auto handlers = manager->getHandlerProfiler().getRecords();
+    if(!handlers.empty()) {
+        writer.family("cppelix_handler_calls_total", MetricType::COUNTER, "Calls into event handlers, resumptions after co_yield not included");
+        for(auto const &handler : handlers) {
+            writer.sample("cppelix_handler_calls_total", MetricLabels{{"manager", managerId}, {"service", std::string{handler.implementationName}},
+                                                                      {"service_id", std::to_string(handler.serviceId)}, {"event", std::string{handler.eventName}}}, handler.invocations);
+        }
+        writer.family("cppelix_handler_time_nanoseconds_total", MetricType::COUNTER, "Time spent in event handlers, resumptions included");
+        for(auto const &handler : handlers) {
+            writer.sample("cppelix_handler_time_nanoseconds_total", MetricLabels{{"manager", managerId}, {"service", std::string{handler.implementationName}},
+                                                                                 {"service_id", std::to_string(handler.serviceId)}, {"event", std::string{handler.eventName}}},
+                          static_cast<uint64_t>(handler.totalTime.count()));
+        }
+    }
+
+    return writer.text();
+}
@@ -0,0 +1,129 @@
+#include <optional_bundles/metrics_bundle/PrometheusTextWriter.h>
+#include <cmath>
+#include <fmt/format.h>
+
+namespace {
+    void appendEscaped(std::string &out, std::string_view value, bool escapeQuotes) {
+        for(char c : value) {
+            switch(c) {
+                case '\\':
+                    out += "\\\\";
+                    break;
+                case '\n':
+                    out += "\\n";
+                    break;
+                case '"':
+                    out += escapeQuotes ? "\\\"" : "\"";
+                    break;
+                default:
+                    out += c;
+            }
+        }
+    }
+
+    [[nodiscard]] std::string_view typeName(Cppelix::MetricType type) noexcept {
+        switch(type) {
+            case Cppelix::MetricType::COUNTER:
+                return "counter";
+            case Cppelix::MetricType::GAUGE:
+                return "gauge";
+            case Cppelix::MetricType::SUMMARY:
+                return "summary";
+        }
+        return "untyped";
+    }
+}
+
+void Cppelix::PrometheusTextWriter::family(std::string_view name, MetricType type, std::string_view help) {
+    if(!_families.emplace(name).second) {
+        return;
+    }
+
+    _text += "# HELP ";
+    _text += name;
+    _text += ' ';
+    appendEscaped(_text, help, false);
+    _text += "\n# TYPE ";
+    _text += name;
+    _text += ' ';
+    _text += typeName(type);
+    _text += '\n';
+}
+
+void Cppelix::PrometheusTextWriter::sample(std::string_view name, const MetricLabels &labels, uint64_t value) {
+    writeSeries(name, labels);
+    _text += fmt::format(" {}\n", value);
+}
+
+void Cppelix::PrometheusTextWriter::sample(std::string_view name, const MetricLabels &labels, double value) {
+    writeSeries(name, labels);
+    if(std::isnan(value)) {
+        _text += " NaN\n";
+    } else if(std::isinf(value)) {
+        _text += value > 0 ? " +Inf\n" : " -Inf\n";
+    } else {
+        _text += fmt::format(" {}\n", value);
+    }
+}
+
+void Cppelix::PrometheusTextWriter::summary(std::string_view name, const MetricLabels &labels, const HistogramSummary &summary) {
+    constexpr std::pair<std::string_view, uint64_t HistogramSummary::*> quantiles[] = {
+        {"0.5", &HistogramSummary::p50}, {"0.9", &HistogramSummary::p90}, {"0.99", &HistogramSummary::p99}, {"0.999", &HistogramSummary::p999}
+    };
+
+    for(auto const &[quantile, member] : quantiles) {
+        writeSeries(name, labels, "quantile", quantile);
+        _text += fmt::format(" {}\n", summary.*member);
+    }
+
+    writeSeries(fmt::format("{}_sum", name), labels);
+    _text += fmt::format(" {}\n", summary.sum);
+    writeSeries(fmt::format("{}_count", name), labels);
+    _text += fmt::format(" {}\n", summary.count);
+}
+
+bool Cppelix::PrometheusTextWriter::validName(std::string_view name) noexcept {
+    if(name.empty()) {
+        return false;
+    }
+
+    for(size_t i = 0; i < name.size(); i++) {
+        auto c = name[i];
+        bool letter = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || c == ':';
+        if(!letter && (i == 0 || c < '0' || c > '9')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void Cppelix::PrometheusTextWriter::writeSeries(std::string_view name, const MetricLabels &labels, std::string_view extraLabel, std::string_view extraValue) {
+    _text += name;
+    if(labels.empty() && extraLabel.empty()) {
+        return;
+    }
+
+    _text += '{';
+    bool first = true;
+    for(auto const &[labelName, labelValue] : labels) {
+        if(!first) {
+            _text += ',';
+        }
+        first = false;
+        _text += labelName;
+        _text += "=\"";
+        appendEscaped(_text, labelValue, true);
+        _text += '"';
+    }
+
+    if(!extraLabel.empty()) {
+        if(!first) {
+            _text += ',';
+        }
+        _text += extraLabel;
+        _text += "=\"";
+        _text += extraValue;
+        _text += '"';
+    }
+    _text += '}';
+}
@@ -0,0 +1,198 @@
+#include <optional_bundles/network_bundle/tcp/HttpListener.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <vector>
+#include <fmt/format.h>
+
+namespace {
+    constexpr size_t MAX_REQUEST_HEADER_SIZE = 8192;
+    constexpr int POLL_TIMEOUT_MS = 100; // how long stop() may have to wait for the listening thread to notice
+
+    [[nodiscard]] bool wouldBlock(int error) noexcept {
+        // the same value on Linux, comparing against both would trip -Wlogical-op
+#if EAGAIN != EWOULDBLOCK
+        if(error == EWOULDBLOCK) {
+            return true;
+        }
+#endif
+        return error == EAGAIN;
+    }
+
+    [[nodiscard]] std::string_view reasonOf(uint16_t status) noexcept {
+        switch(status) {
+            case 200: return "OK";
+            case 400: return "Bad Request";
+            case 404: return "Not Found";
+            case 405: return "Method Not Allowed";
+            case 500: return "Internal Server Error";
+            default: return "Unknown";
+        }
+    }
+}
+
+Cppelix::HttpListener::~HttpListener() {
+    stop();
+}
+
+void Cppelix::HttpListener::listen(const std::string &address, uint16_t port) {
+    stop();
+
+    sockaddr_in bindAddress{};
+    bindAddress.sin_family = AF_INET;
+    bindAddress.sin_port = htons(port);
+    if(::inet_pton(AF_INET, address.c_str(), &bindAddress.sin_addr) != 1) {
+        throw std::runtime_error("HttpListener: invalid IPv4 address " + address);
+    }
+
+    _socket = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(_socket == -1) {
+        throw std::runtime_error("HttpListener: couldn't create socket: errno = " + std::to_string(errno));
+    }
+
+    int setting = 1;
+    ::setsockopt(_socket, SOL_SOCKET, SO_REUSEADDR, &setting, sizeof(setting));
+
+    if(::bind(_socket, reinterpret_cast<sockaddr *>(&bindAddress), sizeof(bindAddress)) != 0 || ::listen(_socket, 16) != 0) {
+        auto error = errno;
+        ::close(_socket);
+        _socket = -1;
+        throw std::runtime_error(fmt::format("HttpListener: couldn't listen on {}:{}: errno = {}", address, port, error));
+    }
+
+    socklen_t length = sizeof(bindAddress);
+    ::getsockname(_socket, reinterpret_cast<sockaddr *>(&bindAddress), &length);
+    _port = ntohs(bindAddress.sin_port);
+
+    _quit.store(false, std::memory_order_release);
+    _thread = std::thread([this] { run(); });
+}
+
+void Cppelix::HttpListener::stop() {
+    _quit.store(true, std::memory_order_release);
+    if(_thread.joinable()) {
+        _thread.join();
+    }
+
+    if(_socket >= 0) {
+        ::close(_socket);
+        _socket = -1;
+    }
+}
+
+void Cppelix::HttpListener::run() {
+    std::vector<Connection> connections;
+    std::vector<pollfd> fds;
+    while(!_quit.load(std::memory_order_acquire)) {
+        fds.clear();
+        fds.push_back(pollfd{_socket, static_cast<short>(connections.size() < MAX_CONNECTIONS ? POLLIN : 0), 0});
+        for(auto const &connection : connections) {
+            fds.push_back(pollfd{connection.socket, static_cast<short>(connection.response.empty() ? POLLIN : POLLOUT), 0});
+        }
+
+        if(::poll(fds.data(), fds.size(), POLL_TIMEOUT_MS) > 0) {
+            // connections accepted below aren't in fds yet, they are polled the next round
+            auto polled = connections.size();
+            for(size_t i = 0; i < polled; i++) {
+                auto revents = fds[i + 1].revents;
+                if(revents == 0) {
+                    continue;
+                }
+
+                bool open = (revents & (POLLERR | POLLNVAL)) == 0 && (connections[i].response.empty() ? receive(connections[i]) : send(connections[i]));
+                if(!open) {
+                    ::close(connections[i].socket);
+                    connections[i].socket = -1;
+                }
+            }
+
+            if((fds[0].revents & POLLIN) != 0) {
+                int connection = ::accept4(_socket, nullptr, nullptr, SOCK_CLOEXEC | SOCK_NONBLOCK);
+                if(connection != -1) {
+                    connections.push_back(Connection{connection, std::chrono::steady_clock::now() + REQUEST_TIMEOUT});
+                }
+            }
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::erase_if(connections, [now](const Connection &connection) noexcept {
+            if(connection.socket == -1) {
+                return true;
+            }
+            if(connection.deadline <= now) {
+                ::close(connection.socket);
+                return true;
+            }
+            return false;
+        });
+    }
+
+    for(auto const &connection : connections) {
+        ::close(connection.socket);
+    }
+}
+
+bool Cppelix::HttpListener::receive(Connection &connection) {
+    char buffer[1024];
+    while(connection.request.find("\r\n\r\n") == std::string::npos && connection.request.size() < MAX_REQUEST_HEADER_SIZE) {
+        auto received = ::recv(connection.socket, buffer, sizeof(buffer), 0);
+        if(received < 0 && errno == EINTR) {
+            continue;
+        }
+        if(received < 0 && wouldBlock(errno)) {
+            return true;
+        }
+        if(received <= 0) {
+            return false;
+        }
+        connection.request.append(buffer, static_cast<size_t>(received));
+    }
+
+    connection.response = respond(connection.request);
+    return send(connection);
+}
+
+bool Cppelix::HttpListener::send(Connection &connection) {
+    while(connection.sent < connection.response.size()) {
+        auto sent = ::send(connection.socket, connection.response.data() + connection.sent, connection.response.size() - connection.sent, MSG_NOSIGNAL);
+        if(sent < 0 && errno == EINTR) {
+            continue;
+        }
+        if(sent < 0 && wouldBlock(errno)) {
+            return true;
+        }
+        if(sent <= 0) {
+            return false;
+        }
+        connection.sent += static_cast<size_t>(sent);
+    }
+    return false;
+}
+
+std::string Cppelix::HttpListener::respond(std::string_view request) {
+    HttpResponse response{};
+    std::string_view requestLine{request.data(), std::min(request.find("\r\n"), request.size())};
+    auto methodEnd = requestLine.find(' ');
+    auto targetEnd = methodEnd == std::string_view::npos ? std::string_view::npos : requestLine.find(' ', methodEnd + 1);
+    if(targetEnd == std::string_view::npos) {
+        response.status = 400;
+    } else {
+        auto method = requestLine.substr(0, methodEnd);
+        auto path = requestLine.substr(methodEnd + 1, targetEnd - methodEnd - 1);
+        path = path.substr(0, path.find('?'));
+        try {
+            response = _handler(method, path);
+        } catch (const std::exception &e) {
+            response = HttpResponse{500, "text/plain; charset=utf-8", e.what()};
+        }
+    }
+
+    return fmt::format("HTTP/1.1 {} {}\r\nContent-Type: {}\r\nContent-Length: {}\r\nConnection: close\r\n\r\n{}",
+                       response.status, reasonOf(response.status), response.contentType, response.body.size(), response.body);
+}
@@ -11,22 +11,28 @@ Cppelix::TcpConnectionService::TcpConnectionService(DependencyRegister &reg, Cpp
 }
 
 bool Cppelix::TcpConnectionService::start() {
-    if(getProperties()->contains("Priority")) {
-        _priority = std::any_cast<uint64_t>(getProperties()->operator[]("Priority"));
-    }
+    // start() may run on the lifecycle thread pool, only use the const lookups on the properties here
+    auto const &properties = *getProperties();
 
+    auto priorityProp = properties.find("Priority");
+    if(priorityProp != end(properties)) {
+        _priority = std::any_cast<uint64_t>(priorityProp->second);
+    }
 
-    if(getProperties()->contains("Socket")) {
-        _socket = std::any_cast<int>(getProperties()->operator[]("Socket"));
+    auto socketProp = properties.find("Socket");
+    if(socketProp != end(properties)) {
+        _socket = std::any_cast<int>(socketProp->second);
 
         LOG_TRACE(_logger, "Starting TCP connection for existing socket");
     } else {
-        if(!getProperties()->contains("Address")) {
+        auto addressProp = properties.find("Address");
+        if(addressProp == end(properties)) {
             getManager()->pushEvent<UnrecoverableErrorEvent>(getServiceId(), 0, "Missing \"Address\" in properties");
             return false;
         }
 
-        if(!getProperties()->contains("Port")) {
+        auto portProp = properties.find("Port");
+        if(portProp == end(properties)) {
             getManager()->pushEvent<UnrecoverableErrorEvent>(getServiceId(), 1, "Missing \"Port\" in properties");
             return false;
         }
@@ -45,9 +51,9 @@ bool Cppelix::TcpConnectionService::start() {
 
         sockaddr_in address{};
         address.sin_family = AF_INET;
-        address.sin_port = htons(std::any_cast<uint16_t>((*getProperties())["Port"]));
+        address.sin_port = htons(std::any_cast<uint16_t>(portProp->second));
 
-        int ret = inet_pton(AF_INET, std::any_cast<std::string>((*getProperties())["Address"]).c_str(), &address.sin_addr);
+        int ret = inet_pton(AF_INET, std::any_cast<std::string>(addressProp->second).c_str(), &address.sin_addr);
         if(ret == 0)
         {
             getManager()->pushEvent<UnrecoverableErrorEvent>(getServiceId(), 3, "inet_pton invalid address for given address family (has to be ipv4-valid address)");
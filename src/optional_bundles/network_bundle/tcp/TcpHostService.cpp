@@ -13,8 +13,9 @@ Cppelix::TcpHostService::TcpHostService(DependencyRegister &reg, CppelixProperti
 }
 
 bool Cppelix::TcpHostService::start() {
-    if(getProperties()->contains("Priority")) {
-        _priority = std::any_cast<uint64_t>(getProperties()->operator[]("Priority"));
+    auto priorityProp = getProperties()->find("Priority");
+    if(priorityProp != end(*getProperties())) {
+        _priority = std::any_cast<uint64_t>(priorityProp->second);
     }
 
     _socket = ::socket(AF_INET, SOCK_STREAM, 0);
@@ -49,7 +50,7 @@ bool Cppelix::TcpHostService::start() {
     } else {
         address.sin_addr.s_addr = INADDR_ANY;
     }
-    address.sin_port = ::htons(std::any_cast<uint16_t>((*getProperties())["Port"]));
+    address.sin_port = ::htons(std::any_cast<uint16_t>(getProperties()->at("Port")));
 
     _bindFd = ::bind(_socket, (sockaddr *)&address, sizeof(address));
 
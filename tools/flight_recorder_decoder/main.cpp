@@ -0,0 +1,79 @@
+#include <framework/FlightRecorder.h>
+#include <fmt/format.h>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+using namespace Cppelix;
+
+namespace {
+    /// \return "-" for values that weren't recorded
+    std::string formatMicroseconds(uint64_t from, uint64_t to) {
+        if(from == 0 || to < from) {
+            return "-";
+        }
+        return fmt::format("{:.3f}", static_cast<double>(to - from) / 1'000.0);
+    }
+
+    bool decode(const char *path) {
+        std::ifstream in(path, std::ios::binary);
+        if(!in) {
+            std::cerr << fmt::format("{}: cannot open\n", path);
+            return false;
+        }
+
+        FlightRecorderFileHeader header;
+        in.read(reinterpret_cast<char*>(&header), sizeof(header));
+        if(!in || header.magic != FlightRecorderFileHeader::MAGIC) {
+            std::cerr << fmt::format("{}: not a flight recorder dump\n", path);
+            return false;
+        }
+        if(header.version != FlightRecorderFileHeader::VERSION || header.recordSize != sizeof(FlightRecord)) {
+            std::cerr << fmt::format("{}: dump version {} with records of {} bytes, expected version {} with {} bytes\n", path, header.version,
+                                     header.recordSize, FlightRecorderFileHeader::VERSION, sizeof(FlightRecord));
+            return false;
+        }
+
+        std::vector<FlightRecord> records(header.recordCount);
+        in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(FlightRecord)));
+
+        std::unordered_map<uint64_t, std::string> names;
+        for(uint64_t i = 0; in && i < header.nameCount; i++) {
+            FlightRecordName name;
+            in.read(reinterpret_cast<char*>(&name), sizeof(name));
+            std::string value(name.length, '\0');
+            in.read(value.data(), static_cast<std::streamsize>(value.size()));
+            names.emplace(name.type, std::move(value));
+        }
+        if(!in) {
+            std::cerr << fmt::format("{}: truncated\n", path);
+            return false;
+        }
+
+        std::cout << fmt::format("{}: manager {}, {} of the last {} events\n", path, header.managerId, header.recordCount, header.capacity);
+        std::cout << fmt::format("{:>16} {:>12} {:>12} {:>10} {:>12} {:>10}  {}\n", "before dump ms", "queued µs", "handler µs", "id", "origin", "priority", "type");
+        for(auto const &record : records) {
+            auto name = names.find(record.type);
+            auto handler = record.handlerDuration == FlightRecord::IN_PROGRESS ? fmt::format("running {}", formatMicroseconds(record.dispatchedAt, header.dumpedAt))
+                                                                              : fmt::format("{:.3f}", static_cast<double>(record.handlerDuration) / 1'000.0);
+            auto sinceDispatch = header.dumpedAt > record.dispatchedAt ? static_cast<double>(header.dumpedAt - record.dispatchedAt) / 1'000'000.0 : 0.0;
+            std::cout << fmt::format("{:>16.3f} {:>12} {:>12} {:>10} {:>12} {:>10}  {}\n", sinceDispatch, formatMicroseconds(record.enqueuedAt, record.dispatchedAt),
+                                     handler, record.id, record.originatingService, record.priority, name != end(names) ? name->second : fmt::format("{:#x}", record.type));
+        }
+        return true;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    if(argc < 2) {
+        std::cerr << fmt::format("usage: {} <flight_<pid>_<manager id>.bin>...\n", argv[0]);
+        return 1;
+    }
+
+    bool ok = true;
+    for(int i = 1; i < argc; i++) {
+        ok = decode(argv[i]) && ok;
+    }
+    return ok ? 0 : 1;
+}